@@ -0,0 +1,312 @@
+// Heap allocations on the selection path, counted by replacing the global operator new.
+//
+// Each benchmark reports allocations_per_pick, which should read 0 for every strategy:
+// picks only load the snapshot, walk its dense hot state array and copy a shared_ptr.
+// Servers come from the ServerTable, so the pool itself sits in contiguous slots.
+// BM_ServerChurn shows the table reusing the slots of removed servers.
+
+#include <benchmark/benchmark.h>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include "ip_hash_load_balancer.hpp"
+#include "least_connections_load_balancer.hpp"
+#include "peak_ewma_load_balancer.hpp"
+#include "round_robin_load_balancer.hpp"
+
+namespace {
+    std::atomic<uint64_t> allocationCount{0};
+}
+
+// Counting allocator for the whole process: plain, nothrow and over-aligned forms, so no
+// allocation path bypasses the count
+namespace {
+    void* countedAllocate(std::size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(size ? size : 1);
+    }
+
+    void* countedAllocateAligned(std::size_t size, std::align_val_t alignment) noexcept
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        std::size_t align = static_cast<std::size_t>(alignment);
+        std::size_t rounded = ((size ? size : 1) + align - 1) & ~(align - 1);  // aligned_alloc wants a multiple
+        #ifdef _WIN32
+            return _aligned_malloc(rounded, align);
+        #else
+            return std::aligned_alloc(align, rounded);
+        #endif
+    }
+
+    void freeAligned(void* pointer) noexcept
+    {
+        #ifdef _WIN32
+            _aligned_free(pointer);
+        #else
+            std::free(pointer);
+        #endif
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    if (void* pointer = countedAllocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* pointer = countedAllocateAligned(size, alignment)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    freeAligned(pointer);
+}
+
+namespace {
+
+enum class Kind {
+    ROUND_ROBIN,
+    WEIGHTED,
+    LEAST_CONNECTIONS,
+    IP_HASH,
+    PEAK_EWMA
+};
+
+std::vector<std::shared_ptr<Server>> makePool(size_t poolSize)
+{
+    std::vector<std::shared_ptr<Server>> servers;
+    servers.reserve(poolSize);
+    for (size_t i = 0; i < poolSize; ++i) {
+        auto server = ServerTable::instance().create("10.1." + std::to_string(i / 256) + "." + std::to_string(i % 256) + ":80");
+        server->setHealthy(i % 4 != 0);
+        servers.push_back(std::move(server));
+    }
+    return servers;
+}
+
+std::unique_ptr<LoadBalancer> makeBalancer(Kind kind, const std::vector<std::shared_ptr<Server>>& servers)
+{
+    switch (kind) {
+        case Kind::WEIGHTED:          return std::make_unique<WeightedRoundRobinLoadBalancer>(servers);
+        case Kind::LEAST_CONNECTIONS: return std::make_unique<LeastConnectionsLoadBalancer>(servers);
+        case Kind::IP_HASH:           return std::make_unique<IpHashLoadBalancer>(servers);
+        case Kind::PEAK_EWMA:         return std::make_unique<PeakEwmaLoadBalancer>(servers);
+        default:                      return std::make_unique<RoundRobinLoadBalancer>(servers);
+    }
+}
+
+// Allocations per iteration since `before`
+void reportAllocations(benchmark::State& state, uint64_t before, int64_t picksPerIteration = 1)
+{
+    uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - before;
+    state.counters["allocations_per_pick"] = static_cast<double>(allocations) /
+        static_cast<double>(state.iterations() * picksPerIteration);
+    state.SetItemsProcessed(state.iterations() * picksPerIteration);
+}
+
+template <Kind kind>
+void BM_PickAllocations(benchmark::State& state)
+{
+    auto balancer = makeBalancer(kind, makePool(static_cast<size_t>(state.range(0))));
+    auto* ipHash = dynamic_cast<IpHashLoadBalancer*>(balancer.get());
+    const std::string client = "192.0.2.17";
+
+    // First pick registers the thread with the epoch domain and syncs the snapshot
+    benchmark::DoNotOptimize(balancer->getNextServer());
+
+    uint64_t before = allocationCount.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        if (ipHash) {
+            benchmark::DoNotOptimize(ipHash->getServerForClient(client));
+        } else {
+            benchmark::DoNotOptimize(balancer->getNextServer());
+        }
+    }
+    reportAllocations(state, before);
+}
+
+template <Kind kind>
+void BM_LeaseAllocations(benchmark::State& state)
+{
+    auto balancer = makeBalancer(kind, makePool(static_cast<size_t>(state.range(0))));
+    benchmark::DoNotOptimize(balancer->acquireNextServer());
+
+    uint64_t before = allocationCount.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        ServerLease lease = balancer->acquireNextServer();
+        benchmark::DoNotOptimize(lease.get());
+        lease.complete(true);
+    }
+    reportAllocations(state, before);
+}
+
+void BM_BatchAllocations(benchmark::State& state)
+{
+    RoundRobinLoadBalancer balancer(makePool(static_cast<size_t>(state.range(0))));
+    std::array<std::shared_ptr<Server>, 32> batch;
+    balancer.getNextServers(batch);
+
+    uint64_t before = allocationCount.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(balancer.getNextServers(batch));
+    }
+    reportAllocations(state, before, static_cast<int64_t>(batch.size()));
+}
+
+// getServers() copies the list; forEachServer() walks it in place
+void BM_ServerListCopy(benchmark::State& state)
+{
+    RoundRobinLoadBalancer balancer(makePool(static_cast<size_t>(state.range(0))));
+
+    uint64_t before = allocationCount.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(balancer.getServers());
+    }
+    reportAllocations(state, before);
+}
+
+void BM_ServerListVisit(benchmark::State& state)
+{
+    RoundRobinLoadBalancer balancer(makePool(static_cast<size_t>(state.range(0))));
+
+    uint64_t before = allocationCount.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        size_t healthy = 0;
+        balancer.forEachServer([&healthy](const Server& server) { healthy += server.isHealthy() ? 1 : 0; });
+        benchmark::DoNotOptimize(healthy);
+    }
+    reportAllocations(state, before);
+}
+
+// Replace one server per iteration; the table keeps reusing the freed slot
+void BM_ServerChurn(benchmark::State& state)
+{
+    size_t poolSize = static_cast<size_t>(state.range(0));
+    RoundRobinLoadBalancer balancer(makePool(poolSize));
+
+    size_t next = 0;
+    for (auto _ : state) {
+        std::string address = "10.2." + std::to_string(next % 256) + "." + std::to_string(next / 256 % 256) + ":80";
+        balancer.removeServer(balancer.getServers().front()->getServerAddress());
+        balancer.addServer(ServerTable::instance().create(address));
+        EpochDomain::instance().synchronize();
+        ++next;
+    }
+    state.counters["table_capacity"] = static_cast<double>(ServerTable::instance().capacity());
+    state.SetItemsProcessed(state.iterations());
+}
+
+const std::vector<int64_t> kPoolSizes{16, 1024};
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_PickAllocations, Kind::ROUND_ROBIN)->ArgsProduct({kPoolSizes});
+BENCHMARK_TEMPLATE(BM_PickAllocations, Kind::WEIGHTED)->ArgsProduct({kPoolSizes});
+BENCHMARK_TEMPLATE(BM_PickAllocations, Kind::LEAST_CONNECTIONS)->ArgsProduct({kPoolSizes});
+BENCHMARK_TEMPLATE(BM_PickAllocations, Kind::IP_HASH)->ArgsProduct({kPoolSizes});
+BENCHMARK_TEMPLATE(BM_PickAllocations, Kind::PEAK_EWMA)->ArgsProduct({kPoolSizes});
+BENCHMARK_TEMPLATE(BM_LeaseAllocations, Kind::ROUND_ROBIN)->ArgsProduct({kPoolSizes});
+BENCHMARK_TEMPLATE(BM_LeaseAllocations, Kind::LEAST_CONNECTIONS)->ArgsProduct({kPoolSizes});
+BENCHMARK(BM_BatchAllocations)->ArgsProduct({kPoolSizes});
+BENCHMARK(BM_ServerListCopy)->ArgsProduct({kPoolSizes});
+BENCHMARK(BM_ServerListVisit)->ArgsProduct({kPoolSizes});
+BENCHMARK(BM_ServerChurn)->Arg(1024);
+
+BENCHMARK_MAIN();
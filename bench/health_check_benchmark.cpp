@@ -0,0 +1,116 @@
+// Sweep time of PingServer::pingServers() against a local fake backend farm.
+//
+// Live backends are loopback sockets in the listening state: the kernel completes the TCP
+// handshake from the listen backlog, so a probe succeeds without any accept() loop. Dead
+// backends are ports that were bound once and closed again, so probes to them are refused.
+// Arguments: number of backends and percentage of dead ones.
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ping_server.hpp"
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+    void closeSocket(SocketHandle socket) { closesocket(socket); }
+#else
+    using SocketHandle = int;
+    void closeSocket(SocketHandle socket) { close(socket); }
+#endif
+
+// Listening loopback sockets standing in for backends
+class FakeBackendFarm {
+private:
+    std::vector<SocketHandle>                               _listeners;
+    std::vector<std::shared_ptr<Server>>                    _servers;
+
+    // Bind a loopback socket to an ephemeral port; returns the port, 0 on failure
+    static uint16_t bindLoopback(SocketHandle socketHandle)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+
+        socklen_t length = sizeof(address);
+        if (bind(socketHandle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            getsockname(socketHandle, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            return 0;
+        }
+        return ntohs(address.sin_port);
+    }
+
+public:
+    FakeBackendFarm(size_t count, int64_t deadPercent)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            bool dead = static_cast<int64_t>((i * 37) % 100) < deadPercent;
+
+            SocketHandle listener = socket(AF_INET, SOCK_STREAM, 0);
+            uint16_t port = bindLoopback(listener);
+            if (port == 0) {
+                closeSocket(listener);
+                continue;
+            }
+
+            if (dead) {
+                closeSocket(listener); // Nothing listens here anymore: connection refused
+            } else {
+                listen(listener, 1024);
+                _listeners.push_back(listener);
+            }
+            _servers.push_back(std::make_shared<Server>("127.0.0.1:" + std::to_string(port)));
+        }
+    }
+
+    ~FakeBackendFarm()
+    {
+        for (SocketHandle listener : _listeners) {
+            closeSocket(listener);
+        }
+    }
+
+    FakeBackendFarm(const FakeBackendFarm&) = delete;
+    FakeBackendFarm& operator=(const FakeBackendFarm&) = delete;
+
+    const std::vector<std::shared_ptr<Server>>& servers() const { return _servers; }
+};
+
+void BM_PingServersSweep(benchmark::State& state)
+{
+    FakeBackendFarm farm(static_cast<size_t>(state.range(0)), state.range(1));
+    PingServer pingServer(std::chrono::milliseconds(500));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pingServer.pingServers(farm.servers()));
+    }
+
+    size_t healthy = 0;
+    for (const auto& server : farm.servers()) {
+        healthy += server->isHealthy() ? 1 : 0;
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(farm.servers().size()));
+    state.counters["healthy"] = static_cast<double>(healthy);
+    state.counters["time_per_probe"] = benchmark::Counter(static_cast<double>(state.iterations() * farm.servers().size()),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+} // namespace
+
+BENCHMARK(BM_PingServersSweep)->ArgsProduct({{16, 256, 1024}, {0, 50}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
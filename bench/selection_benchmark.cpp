@@ -0,0 +1,218 @@
+// Pick throughput of RoundRobinLoadBalancer and WeightedRoundRobinLoadBalancer, and of
+// their compile-time BasicBalancer counterparts for small fixed pools.
+//
+// Arguments: pool size, percentage of unhealthy servers and (weighted only) weight skew.
+// Single-threaded runs also report the Jain fairness index of the picks, computed over
+// healthy servers from pick counts divided by weight: 1.0 means every server received
+// exactly its share. Threaded runs share one balancer between all benchmark threads; the
+// lease runs compare that with a per-core ShardedBalancer, whose connection counters each
+// thread updates on its own shard.
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "basic_balancer.hpp"
+#include "round_robin_load_balancer.hpp"
+#include "sharded_balancer.hpp"
+
+namespace {
+
+enum class Kind {
+    ROUND_ROBIN,
+    WEIGHTED
+};
+
+constexpr int64_t kFairnessPicksPerServer = 100;
+constexpr int64_t kMaxFairnessPicks = 1 << 20;
+
+// Pool with `unhealthyPercent` of its servers down, spread evenly over the list.
+// With skew, every tenth server carries weight 10 and the rest weight 1.
+std::vector<std::shared_ptr<Server>> makePool(size_t poolSize, int64_t unhealthyPercent, bool skewed)
+{
+    std::vector<std::shared_ptr<Server>> servers;
+    servers.reserve(poolSize);
+
+    for (size_t i = 0; i < poolSize; ++i) {
+        auto server = std::make_shared<Server>("10." + std::to_string(i / 65536) + "." + std::to_string((i / 256) % 256) + "." + std::to_string(i % 256) + ":80");
+        server->setHealthy(static_cast<int64_t>((i * 37) % 100) >= unhealthyPercent);
+        server->setWeight(skewed && i % 10 == 0 ? 10 : 1);
+        servers.push_back(server);
+    }
+    return servers;
+}
+
+std::unique_ptr<LoadBalancer> makeBalancer(Kind kind, const std::vector<std::shared_ptr<Server>>& servers)
+{
+    if (kind == Kind::WEIGHTED) {
+        return std::make_unique<WeightedRoundRobinLoadBalancer>(servers);
+    }
+    return std::make_unique<RoundRobinLoadBalancer>(servers);
+}
+
+// One balancer per configuration, shared by the threads of a threaded run
+LoadBalancer& sharedBalancer(Kind kind, size_t poolSize, int64_t unhealthyPercent, bool skewed)
+{
+    static std::mutex mutex;
+    static std::map<std::tuple<Kind, size_t, int64_t, bool>, std::unique_ptr<LoadBalancer>> balancers;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& balancer = balancers[{kind, poolSize, unhealthyPercent, skewed}];
+    if (!balancer) {
+        balancer = makeBalancer(kind, makePool(poolSize, unhealthyPercent, skewed));
+    }
+    return *balancer;
+}
+
+// Jain's index over healthy servers of picks per unit of weight (0 when none is healthy)
+double fairness(LoadBalancer& balancer)
+{
+    auto servers = balancer.getServers();
+    std::unordered_map<const Server*, int64_t> picks;
+    size_t healthy = 0;
+    for (const auto& server : servers) {
+        if (server->isHealthy()) {
+            picks[server.get()] = 0;
+            ++healthy;
+        }
+    }
+    if (healthy == 0) {
+        return 0.0;
+    }
+
+    int64_t samples = std::min<int64_t>(kFairnessPicksPerServer * static_cast<int64_t>(healthy), kMaxFairnessPicks);
+    for (int64_t i = 0; i < samples; ++i) {
+        auto server = balancer.getNextServer();
+        auto it = picks.find(server.get());
+        if (it != picks.end()) {
+            ++it->second;
+        }
+    }
+
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    for (const auto& [server, count] : picks) {
+        double share = static_cast<double>(count) / server->getWeight();
+        sum += share;
+        sumOfSquares += share * share;
+    }
+    return sumOfSquares > 0.0 ? (sum * sum) / (static_cast<double>(picks.size()) * sumOfSquares) : 0.0;
+}
+
+void reportPicks(benchmark::State& state)
+{
+    state.SetItemsProcessed(state.iterations());
+    state.counters["time_per_pick"] = benchmark::Counter(static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+template <Kind kind>
+void BM_Pick(benchmark::State& state)
+{
+    size_t poolSize = static_cast<size_t>(state.range(0));
+    int64_t unhealthyPercent = state.range(1);
+    bool skewed = state.range(2) != 0;
+
+    auto balancer = makeBalancer(kind, makePool(poolSize, unhealthyPercent, skewed));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(balancer->getNextServer());
+    }
+
+    reportPicks(state);
+    state.counters["fairness"] = fairness(*balancer);
+}
+
+template <Kind kind>
+void BM_PickThreaded(benchmark::State& state)
+{
+    LoadBalancer& balancer = sharedBalancer(kind, static_cast<size_t>(state.range(0)), state.range(1), state.range(2) != 0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(balancer.getNextServer());
+    }
+
+    reportPicks(state);
+}
+
+// Lease acquire and release, against one shared balancer or the calling thread's shard
+template <bool sharded>
+void BM_LeaseThreaded(benchmark::State& state)
+{
+    static std::mutex mutex;
+    static std::map<size_t, std::unique_ptr<ShardedBalancer>> shardedBalancers;
+
+    size_t poolSize = static_cast<size_t>(state.range(0));
+    ShardedBalancer* front = nullptr;
+    if (sharded) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& balancer = shardedBalancers[poolSize];
+        if (!balancer) {
+            balancer = std::make_unique<ShardedBalancer>(makePool(poolSize, 0, false), [](const std::vector<std::shared_ptr<Server>>& servers) {
+                return std::make_unique<RoundRobinLoadBalancer>(servers);
+            }, ShardMode::PER_CORE);
+        }
+        front = balancer.get();
+    }
+    LoadBalancer& shared = sharedBalancer(Kind::ROUND_ROBIN, poolSize, 0, false);
+
+    for (auto _ : state) {
+        ServerLease lease = front ? front->acquireNextServer() : shared.acquireNextServer();
+        benchmark::DoNotOptimize(lease.get());
+    }
+
+    reportPicks(state);
+}
+
+// Same pools through the fixed-capacity template (no virtual call, snapshot or guard)
+template <Kind kind>
+void BM_FixedPick(benchmark::State& state)
+{
+    using Balancer = std::conditional_t<kind == Kind::WEIGHTED, FixedWeightedRoundRobinBalancer<64>, FixedRoundRobinBalancer<64>>;
+
+    auto servers = makePool(static_cast<size_t>(state.range(0)), state.range(1), state.range(2) != 0);
+    Balancer balancer(servers);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(balancer.getNextServer());
+    }
+
+    reportPicks(state);
+}
+
+// One weight change per pick, in place on the weighted schedule
+void BM_WeightedPickUnderWeightChanges(benchmark::State& state)
+{
+    size_t poolSize = static_cast<size_t>(state.range(0));
+    auto servers = makePool(poolSize, 0, false);
+    WeightedRoundRobinLoadBalancer balancer(servers);
+
+    size_t next = 0;
+    for (auto _ : state) {
+        servers[next % poolSize]->setWeight(static_cast<uint32_t>(1 + next % 8));
+        ++next;
+        benchmark::DoNotOptimize(balancer.getNextServer());
+    }
+
+    reportPicks(state);
+}
+
+const std::vector<int64_t> kPoolSizes{4, 64, 1024, 10000};
+const std::vector<int64_t> kUnhealthyPercents{0, 50, 90};
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Pick, Kind::ROUND_ROBIN)->ArgsProduct({kPoolSizes, kUnhealthyPercents, {0}});
+BENCHMARK_TEMPLATE(BM_Pick, Kind::WEIGHTED)->ArgsProduct({kPoolSizes, kUnhealthyPercents, {0, 1}});
+BENCHMARK_TEMPLATE(BM_PickThreaded, Kind::ROUND_ROBIN)->ArgsProduct({{64, 10000}, {0, 50}, {0}})->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PickThreaded, Kind::WEIGHTED)->ArgsProduct({{64, 10000}, {0, 50}, {1}})->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LeaseThreaded, false)->Arg(64)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LeaseThreaded, true)->Arg(64)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FixedPick, Kind::ROUND_ROBIN)->ArgsProduct({{4, 64}, kUnhealthyPercents, {0}});
+BENCHMARK_TEMPLATE(BM_FixedPick, Kind::WEIGHTED)->ArgsProduct({{4, 64}, kUnhealthyPercents, {0, 1}});
+BENCHMARK(BM_WeightedPickUnderWeightChanges)->Arg(64)->Arg(10000);
+
+BENCHMARK_MAIN();
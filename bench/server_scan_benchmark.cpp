@@ -0,0 +1,156 @@
+// Scan cost of RoundRobinLoadBalancer::getNextServer() with the hot/cold Server split
+// against the previous single-object layout.
+//
+// A background thread plays the health checker: it keeps writing the cold fields
+// (last health check timestamp, failure count) of every server while the benchmark
+// thread scans for an eligible server with most of the pool unhealthy.
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "round_robin_load_balancer.hpp"
+
+namespace {
+
+// Field layout of Server before the hot/cold split
+class LegacyServer {
+public:
+    std::string                                             serverAddress;
+    std::atomic<bool>                                       isAlive{true};
+    std::atomic<bool>                                       isHealthy{false};
+    std::chrono::time_point<std::chrono::steady_clock>      lastHealthCheck;
+    mutable std::mutex                                      timeMutex;
+    std::atomic<uint32_t>                                   weight{1};
+    std::atomic<uint32_t>                                   currentConnections{0};
+    std::atomic<uint32_t>                                   failureCount{0};
+
+    explicit LegacyServer(std::string address) : serverAddress(std::move(address)) {}
+    virtual ~LegacyServer() = default;
+};
+
+// Background writer touching only cold fields
+class ColdWriter {
+public:
+    template <typename Fn>
+    explicit ColdWriter(Fn touch)
+        : _thread([this, touch]() {
+              while (!_stop.load(std::memory_order_relaxed)) {
+                  touch();
+              }
+          })
+    {
+    }
+
+    ~ColdWriter()
+    {
+        _stop.store(true, std::memory_order_relaxed);
+        _thread.join();
+    }
+
+private:
+    std::atomic<bool> _stop{false};
+    std::thread _thread;
+};
+
+constexpr int kHealthyEvery = 8; // One healthy server in eight
+
+void BM_ScanLegacyLayout(benchmark::State& state)
+{
+    size_t poolSize = static_cast<size_t>(state.range(0));
+    std::vector<std::shared_ptr<LegacyServer>> servers;
+    for (size_t i = 0; i < poolSize; ++i) {
+        auto server = std::make_shared<LegacyServer>("10.0." + std::to_string(i / 256) + "." + std::to_string(i % 256) + ":80");
+        server->isHealthy.store(i % kHealthyEvery == 0);
+        servers.push_back(server);
+    }
+
+    ColdWriter writer([&servers]() {
+        for (auto& server : servers) {
+            std::lock_guard<std::mutex> lock(server->timeMutex);
+            server->lastHealthCheck = std::chrono::steady_clock::now();
+            server->failureCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    size_t cursor = 0;
+    for (auto _ : state) {
+        // Same walk as the original getNextServer(): two flag loads per shared_ptr
+        std::shared_ptr<LegacyServer> picked;
+        for (size_t i = 0; i < poolSize; ++i) {
+            const auto& server = servers[(cursor + i) % poolSize];
+            if (server->isAlive.load() && server->isHealthy.load()) {
+                picked = server;
+                break;
+            }
+        }
+        cursor++;
+        benchmark::DoNotOptimize(picked);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ScanHotState(benchmark::State& state)
+{
+    size_t poolSize = static_cast<size_t>(state.range(0));
+    std::vector<std::shared_ptr<Server>> servers;
+    for (size_t i = 0; i < poolSize; ++i) {
+        auto server = std::make_shared<Server>("10.0." + std::to_string(i / 256) + "." + std::to_string(i % 256) + ":80");
+        server->setHealthy(i % kHealthyEvery == 0);
+        servers.push_back(server);
+    }
+
+    ColdWriter writer([&servers]() {
+        for (auto& server : servers) {
+            server->updateLastHealthCheck();
+            server->incrementFailures();
+        }
+    });
+
+    // Same walk over the snapshot's contiguous hot state blocks: one flag load per server
+    ServerSnapshot snapshot(servers);
+    size_t cursor = 0;
+    for (auto _ : state) {
+        std::shared_ptr<Server> picked;
+        for (size_t i = 0; i < poolSize; ++i) {
+            size_t index = (cursor + i) % poolSize;
+            if (snapshot.hotStates[index]->isAvailable()) {
+                picked = snapshot.servers[index];
+                break;
+            }
+        }
+        cursor++;
+        benchmark::DoNotOptimize(picked);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Full getNextServer() including the epoch guard and cursor update
+void BM_GetNextServer(benchmark::State& state)
+{
+    size_t poolSize = static_cast<size_t>(state.range(0));
+    std::vector<std::shared_ptr<Server>> servers;
+    for (size_t i = 0; i < poolSize; ++i) {
+        auto server = std::make_shared<Server>("10.0." + std::to_string(i / 256) + "." + std::to_string(i % 256) + ":80");
+        server->setHealthy(i % kHealthyEvery == 0);
+        servers.push_back(server);
+    }
+
+    RoundRobinLoadBalancer balancer(servers);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(balancer.getNextServer());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_ScanLegacyLayout)->RangeMultiplier(4)->Range(16, 4096)->UseRealTime();
+BENCHMARK(BM_ScanHotState)->RangeMultiplier(4)->Range(16, 4096)->UseRealTime();
+BENCHMARK(BM_GetNextServer)->RangeMultiplier(4)->Range(16, 4096);
+
+BENCHMARK_MAIN();
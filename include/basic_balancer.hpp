@@ -0,0 +1,275 @@
+#ifndef BASIC_BALANCER_HPP_
+#define BASIC_BALANCER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "server.hpp"
+#include "server_hot_state.hpp"
+#include "server_lease.hpp"
+
+// Health policies: which servers a pick prefers, and which it may fall back to when no
+// preferred server is left. Without a fallback the second pass compiles away.
+struct PreferHealthy {
+    static constexpr bool kFallback = true;
+
+    static bool preferred(uint32_t flags) { return (flags & ServerHotState::kAvailable) == ServerHotState::kAvailable; }
+    static bool acceptable(uint32_t flags) { return (flags & ServerHotState::kAlive) != 0; }
+};
+
+struct RequireHealthy {
+    static constexpr bool kFallback = false;
+
+    static bool preferred(uint32_t flags) { return (flags & ServerHotState::kAvailable) == ServerHotState::kAvailable; }
+    static bool acceptable(uint32_t flags) { return preferred(flags); }
+};
+
+struct IgnoreHealth {
+    static constexpr bool kFallback = false;
+
+    static bool preferred(uint32_t) { return true; }
+    static bool acceptable(uint32_t) { return true; }
+};
+
+// Selection policies for BasicBalancer. select<HealthPolicy>(states, count) returns an index
+// below count, or kNoServer. Policies read the hot states directly, so weight and health
+// changes apply to the next pick without any rebuild.
+inline constexpr size_t kNoServer = static_cast<size_t>(-1);
+
+// Round robin: a shared cursor, then the first preferred server from there
+class RoundRobinPolicy {
+private:
+    std::atomic<uint64_t>                                   _cursor{0};
+
+public:
+    template <typename HealthPolicy>
+    size_t select(const ServerHotState* const* states, size_t count)
+    {
+        size_t start = static_cast<size_t>(_cursor.fetch_add(1, std::memory_order_relaxed) % count);
+        size_t fallbackIndex = kNoServer;
+
+        for (size_t i = 0; i < count; ++i) {
+            size_t index = start + i < count ? start + i : start + i - count;
+            uint32_t flags = states[index]->flags.load(std::memory_order_relaxed);
+            if (HealthPolicy::preferred(flags)) {
+                return index;
+            }
+            if constexpr (HealthPolicy::kFallback) {
+                if (fallbackIndex == kNoServer && HealthPolicy::acceptable(flags)) {
+                    fallbackIndex = index;
+                }
+            }
+        }
+        return fallbackIndex;
+    }
+};
+
+// Weighted round robin: each ticket lands on a point of the preferred servers' total weight.
+// Points follow a Weyl sequence, so shares match the weights without a precomputed schedule;
+// two passes over at most MaxServers hot states stay cheaper than keeping one in sync.
+class WeightedRoundRobinPolicy {
+private:
+    std::atomic<uint64_t>                                   _ticket{0};
+
+public:
+    template <typename HealthPolicy>
+    size_t select(const ServerHotState* const* states, size_t count)
+    {
+        uint64_t ticket = _ticket.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t totalWeight = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (HealthPolicy::preferred(states[i]->flags.load(std::memory_order_relaxed))) {
+                totalWeight += states[i]->weight.load(std::memory_order_relaxed);
+            }
+        }
+
+        if (totalWeight != 0) {
+            // Fraction in [0, 1) scaled onto the total weight
+            uint64_t point = static_cast<uint64_t>(
+                (static_cast<double>((ticket * 0x9E3779B97F4A7C15ULL) >> 11) * 0x1.0p-53) * static_cast<double>(totalWeight));
+            size_t lastIndex = kNoServer;
+            for (size_t i = 0; i < count; ++i) {
+                if (!HealthPolicy::preferred(states[i]->flags.load(std::memory_order_relaxed))) {
+                    continue;
+                }
+                uint64_t weight = states[i]->weight.load(std::memory_order_relaxed);
+                if (point < weight) {
+                    return i;
+                }
+                point -= weight;
+                lastIndex = weight != 0 ? i : lastIndex;
+            }
+
+            // Weights shrank between the passes
+            if (lastIndex != kNoServer) {
+                return lastIndex;
+            }
+        }
+
+        // Nothing preferred: rotate over the fallback
+        if constexpr (HealthPolicy::kFallback) {
+            size_t start = static_cast<size_t>(ticket % count);
+            for (size_t i = 0; i < count; ++i) {
+                size_t index = start + i < count ? start + i : start + i - count;
+                if (HealthPolicy::acceptable(states[index]->flags.load(std::memory_order_relaxed))) {
+                    return index;
+                }
+            }
+        }
+        return kNoServer;
+    }
+};
+
+// Least connections: full scan for the lowest (connections + 1) / weight. Compared by
+// cross-multiplying, so the scan has no divisions.
+class LeastConnectionsPolicy {
+private:
+    struct Candidate {
+        size_t                                              index{kNoServer};
+        uint64_t                                            load{0};                                                // connections + 1
+        uint64_t                                            weight{1};
+
+        void offer(size_t candidateIndex, uint64_t candidateLoad, uint64_t candidateWeight)
+        {
+            if (index == kNoServer || candidateLoad * weight < load * candidateWeight) {
+                index = candidateIndex;
+                load = candidateLoad;
+                weight = candidateWeight;
+            }
+        }
+    };
+
+public:
+    template <typename HealthPolicy>
+    size_t select(const ServerHotState* const* states, size_t count)
+    {
+        Candidate best;
+        Candidate fallback;
+
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t flags = states[i]->flags.load(std::memory_order_relaxed);
+            uint64_t weight = states[i]->weight.load(std::memory_order_relaxed);
+            uint64_t load = static_cast<uint64_t>(states[i]->totalConnections()) + 1;
+            if (weight == 0) {
+                continue;
+            }
+
+            if (HealthPolicy::preferred(flags)) {
+                best.offer(i, load, weight);
+            } else if constexpr (HealthPolicy::kFallback) {
+                if (HealthPolicy::acceptable(flags)) {
+                    fallback.offer(i, load, weight);
+                }
+            }
+        }
+        return best.index != kNoServer ? best.index : fallback.index;
+    }
+};
+
+// Balancer with its policy, health policy and capacity fixed at compile time.
+// For builds that know all of that up front (e.g. a sidecar with a static pool): there is
+// no virtual call, no snapshot or epoch guard, and the servers live in an inline array, so
+// the compiler can inline and unroll the whole pick. The server list is fixed at
+// construction; build a new balancer to change it. getNextServer() returns a plain pointer
+// that stays valid for the balancer's lifetime.
+// The picks are not the runtime engines' picks:
+//   - the slow start ramp and locality tiers do not apply; weights are used as set
+//   - a saturated server is not skipped: a lease on it comes back empty and the caller retries
+//   - WeightedRoundRobinPolicy places each ticket by a Weyl sequence over the live weights,
+//     so shares match the weights on average; the engine's WeightedSchedule gives every
+//     server exactly its weight per period, in a different order
+//   - LeastConnectionsPolicy always scans every server; the engine samples two candidates
+//     once the pool is above its full scan threshold
+//   - no pick counters are kept
+template <typename Policy, typename HealthPolicy = PreferHealthy, size_t MaxServers = 64>
+class BasicBalancer {
+private:
+    static_assert(MaxServers > 0, "MaxServers must be positive");
+
+    std::array<std::shared_ptr<Server>, MaxServers>         _servers{};                                             // First _serverCount entries are in use
+    std::array<const ServerHotState*, MaxServers>           _hotStates{};                                           // Hot state per server, scanned by the policy
+    size_t                                                  _serverCount{0};
+    Policy                                                  _policy;
+
+public:
+    static constexpr size_t npos = kNoServer;
+    static constexpr size_t kCapacity = MaxServers;
+
+    // Constructor
+    explicit BasicBalancer(const std::vector<std::shared_ptr<Server>>& servers)
+    {
+        if (servers.empty()) {
+            throw std::invalid_argument("Server list cannot be empty");
+        }
+        if (servers.size() > MaxServers) {
+            throw std::invalid_argument("Server list exceeds balancer capacity");
+        }
+
+        for (const auto& server : servers) {
+            if (!server) {
+                throw std::invalid_argument("Server list cannot contain null servers");
+            }
+            _hotStates[_serverCount] = &server->hotState();
+            _servers[_serverCount++] = server;
+        }
+    }
+
+    // No copy or move (the policy holds atomics); construct another from getServers()
+    BasicBalancer(const BasicBalancer&) = delete;
+    BasicBalancer& operator=(const BasicBalancer&) = delete;
+    ~BasicBalancer() = default;
+
+    // Index of the chosen server, or npos when the health policy leaves none
+    size_t selectIndex()
+    {
+        return _policy.template select<HealthPolicy>(_hotStates.data(), _serverCount);
+    }
+
+    // Core functionality
+    Server* getNextServer()
+    {
+        size_t index = selectIndex();
+        return index != npos ? _servers[index].get() : nullptr;
+    }
+
+    // The detector and limiter (e.g. a LoadBalancer's) receive the outcome passed to complete()
+    ServerLease acquireNextServer(OutlierDetector* detector = nullptr, ConcurrencyLimiter* limiter = nullptr)
+    {
+        size_t index = selectIndex();
+        return index != npos ? ServerLease(_servers[index].get(), index, detector, limiter) : ServerLease();
+    }
+
+    // Servers in selection order
+    std::span<const std::shared_ptr<Server>> getServers() const
+    {
+        return std::span<const std::shared_ptr<Server>>(_servers.data(), _serverCount);
+    }
+
+    size_t getServerCount() const
+    {
+        return _serverCount;
+    }
+
+    Policy& getPolicy()
+    {
+        return _policy;
+    }
+};
+
+// Fixed-capacity counterparts of the runtime strategies
+template <size_t MaxServers = 64>
+using FixedRoundRobinBalancer = BasicBalancer<RoundRobinPolicy, PreferHealthy, MaxServers>;
+
+template <size_t MaxServers = 64>
+using FixedWeightedRoundRobinBalancer = BasicBalancer<WeightedRoundRobinPolicy, PreferHealthy, MaxServers>;
+
+template <size_t MaxServers = 64>
+using FixedLeastConnectionsBalancer = BasicBalancer<LeastConnectionsPolicy, PreferHealthy, MaxServers>;
+
+#endif // BASIC_BALANCER_HPP_
@@ -0,0 +1,208 @@
+#ifndef CLUSTER_STATE_HPP_
+#define CLUSTER_STATE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "server.hpp"
+#include "server_endpoint.hpp"
+
+// Health and load shared between balancer instances that front the same backends.
+// Each backend is owned by one live member (rendezvous hashing over member ids): only the
+// owner probes it and publishes the result, the other members adopt that result. Every member
+// reports its connection count per backend, and the sum of the others' counts lands in
+// ServerHotState::remoteConnections, so least-connections and bounded-load decisions see the
+// whole cluster. Members that stop synchronizing drop out after the member timeout and their
+// backends move to the remaining members. A backend no live member has reported for the
+// member timeout is forgotten, so removed servers do not pile up.
+//
+// synchronize() is driven by the balancer's health check loop every sync interval.
+// Implementations serialize their own calls.
+class ClusterState {
+private:
+    const uint64_t                                          _memberId;                                              // Non-zero id of this instance
+    std::atomic<std::chrono::milliseconds::rep>             _syncInterval{100};                                     // Time between synchronize() calls (ms)
+    std::atomic<std::chrono::milliseconds::rep>             _memberTimeout{3000};                                   // Silence after which a member counts as gone (ms)
+
+protected:
+    // Random id when memberId is zero
+    explicit ClusterState(uint64_t memberId);
+
+    // Stable (cross-process, cross-host) key for a backend, never zero
+    static uint64_t serverKey(const Server& server);
+
+    // Rendezvous owner of a key among member ids (0 when members is empty)
+    static uint64_t ownerOf(uint64_t key, const std::vector<uint64_t>& members);
+
+    // Adopt health published by the owner (counts as a health check of the server); an
+    // ejected server stays unhealthy locally
+    static void applyHealth(Server& server, uint32_t flags);
+
+    // Alive and healthy bits of the local view
+    static uint32_t healthFlags(const Server& server);
+
+public:
+    virtual ~ClusterState() = default;
+
+    ClusterState(const ClusterState&) = delete;
+    ClusterState& operator=(const ClusterState&) = delete;
+
+    // Whether this instance should actively probe the server
+    virtual bool ownsProbe(const Server& server) const = 0;
+
+    // Publish local health (for owned servers) and connection counts, then apply what the
+    // other members published
+    virtual void synchronize(const std::vector<std::shared_ptr<Server>>& servers) = 0;
+
+    // Configuration
+    uint64_t getMemberId() const;
+    void setSyncInterval(std::chrono::milliseconds interval);
+    std::chrono::milliseconds getSyncInterval() const;
+    void setMemberTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds getMemberTimeout() const;
+};
+
+// Cluster state in a POSIX shared memory segment, for balancer processes on one host.
+// The segment holds a member table with heartbeats and an open-addressed table of backend
+// records (published health plus one connection counter per member slot). Every process
+// opening the same name with the same slot count joins the same cluster. Not available on
+// Windows, where isOpen() is always false.
+class SharedMemoryClusterState : public ClusterState {
+public:
+    static constexpr size_t kMaxMembers = 64;                                                                       // Member slots in a segment
+
+private:
+    struct Segment;
+
+    Segment*                                                _segment{nullptr};                                      // Mapped segment, null when opening failed
+    size_t                                                  _mappedSize{0};
+    size_t                                                  _memberSlot{kMaxMembers};                               // Our column in the connection counters
+    mutable std::mutex                                      _mutex;                                                 // Serializes synchronize() and ownsProbe()
+    std::vector<uint64_t>                                   _members;                                               // Live member ids as of the last synchronize()
+    std::vector<size_t>                                     _remoteSlots;                                           // Member slots of the other live members
+    std::unordered_map<uint64_t, size_t>                    _recordIndex;                                           // Server key to record slot
+    int64_t                                                 _nextRelease{0};                                        // When synchronize() next frees stale records (ms)
+
+    // Claim a free or stale member slot and clear its counters
+    bool joinSegment();
+
+    // Record slot for a server key, claiming a free one if needed (kNoRecord when full)
+    size_t recordFor(uint64_t key);
+
+    // Free records no live member reported within the member timeout
+    void releaseStale(int64_t now, int64_t timeout);
+
+    static constexpr size_t                                 kNoRecord = static_cast<size_t>(-1);
+    static constexpr uint64_t                               kReleasedKey = ~uint64_t{0};                            // Key of a freed record; probing continues past it
+
+public:
+    // Constructor
+    explicit SharedMemoryClusterState(
+        const std::string& name,
+        size_t serverSlots = 4096,
+        uint64_t memberId = 0
+    );
+    ~SharedMemoryClusterState() override;
+
+    bool isOpen() const;
+
+    // Remove a segment; members that have it mapped keep using it
+    static bool unlink(const std::string& name);
+
+    bool ownsProbe(const Server& server) const override;
+    void synchronize(const std::vector<std::shared_ptr<Server>>& servers) override;
+};
+
+// Cluster state exchanged over UDP between balancers on different hosts.
+// Every synchronize() drains received datagrams and sends each peer the entries that changed
+// since the last round (key, owner-published health with a version, local connections);
+// every kFullStateRounds rounds the full state goes out instead, which also repairs lost
+// datagrams. Peers are IPv4 literals; datagrams from other addresses are ignored.
+// Health entries nobody reported for the member timeout are dropped in full state rounds.
+class GossipClusterState : public ClusterState {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Peer {
+        ServerEndpoint                                      endpoint;                                               // Where deltas are sent
+        uint64_t                                            memberId{0};                                            // Learned from its datagrams
+        Clock::time_point                                   lastHeard{};
+        std::unordered_map<uint64_t, uint32_t>              connections;                                            // Its reported connections per server key
+    };
+
+    struct HealthRecord {
+        uint64_t                                            version{0};                                             // Bumped by the owner on every change
+        uint32_t                                            flags{0};
+        Clock::time_point                                   lastSeen{};                                             // Last report from us or a peer
+    };
+
+    struct SentState {
+        uint64_t                                            healthVersion{0};
+        uint32_t                                            connections{0};
+        bool                                                sent{false};
+    };
+
+    static constexpr uint64_t                               kFullStateRounds = 20;                                  // Rounds between full state sends
+    static constexpr size_t                                 kMaxDatagramBytes = 1400;                               // Stays below common path MTUs
+
+    int                                                     _socket{-1};                                            // Non-blocking UDP socket, -1 when closed
+    mutable std::mutex                                      _mutex;                                                 // Serializes synchronize() and ownsProbe()
+    std::vector<Peer>                                       _peers;
+    std::vector<uint64_t>                                   _members;                                               // Live member ids (including ours)
+    std::unordered_map<uint64_t, HealthRecord>              _health;                                                // Newest health per server key
+    std::unordered_map<uint64_t, SentState>                 _sent;                                                  // What the peers last got from us
+    uint64_t                                                _round{0};
+
+    // Apply every datagram waiting on the socket
+    void receive(Clock::time_point now);
+
+    // Send entries to every peer, split into datagrams
+    void send(const std::vector<uint8_t>& entries, size_t entryCount, bool fullState);
+
+public:
+    // Constructor (binds the UDP port on all IPv4 interfaces)
+    explicit GossipClusterState(uint16_t port, uint64_t memberId = 0);
+    ~GossipClusterState() override;
+
+    bool isOpen() const;
+
+    // Add a peer by "ip:port"; false for names, IPv6 or duplicates
+    bool addPeer(const std::string& address);
+
+    bool ownsProbe(const Server& server) const override;
+    void synchronize(const std::vector<std::shared_ptr<Server>>& servers) override;
+};
+
+// Cluster state shared by balancer instances in one process, such as the shards of a
+// ShardedBalancer. Members created with the same Group see each other; the group keeps one
+// record per backend (owner-published health and every member's connection count) behind a
+// mutex that only synchronize() takes, so the pick path never touches it. A member leaves
+// its group when destroyed.
+class InProcessClusterState : public ClusterState {
+public:
+    struct Group;
+
+    // New, empty group
+    static std::shared_ptr<Group> makeGroup();
+
+private:
+    std::shared_ptr<Group>                                  _group;
+    mutable std::mutex                                      _mutex;                                                 // Serializes synchronize() and ownsProbe()
+    std::vector<uint64_t>                                   _members;                                               // Live member ids as of the last synchronize()
+
+public:
+    // Constructor (joins `group`)
+    explicit InProcessClusterState(std::shared_ptr<Group> group, uint64_t memberId = 0);
+    ~InProcessClusterState() override;
+
+    bool ownsProbe(const Server& server) const override;
+    void synchronize(const std::vector<std::shared_ptr<Server>>& servers) override;
+};
+
+#endif // CLUSTER_STATE_HPP_
@@ -0,0 +1,70 @@
+#ifndef CONCURRENCY_LIMITER_HPP_
+#define CONCURRENCY_LIMITER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "server.hpp"
+
+// How per-server concurrency limits are maintained
+enum class ConcurrencyLimitMode {
+    FIXED,          // Limits are whatever Server::setConcurrencyLimit() set (0 for none)
+    AIMD,           // Additive increase while the server keeps up, multiplicative decrease on failure or timeout
+    GRADIENT        // Scale with the ratio of the windowed minimum to recent latency (queueing shows up as a rising latency)
+};
+
+// Adaptive per-backend concurrency limits from live request outcomes.
+// The balancer enforces each server's limit when issuing leases: a saturated server is
+// skipped, and a pick that only finds saturated servers is rejected. In the adaptive modes
+// every completed request moves the server's limit estimate, kept in ServerOutcomeStats,
+// and the rounded estimate is published to the hot state the pickers read. A server gets
+// initialLimit with its first outcome; limits always stay within [minLimit, maxLimit].
+// Switching back to FIXED leaves the last adaptive limits in place.
+class ConcurrencyLimiter {
+private:
+    std::atomic<ConcurrencyLimitMode>                       _mode{ConcurrencyLimitMode::FIXED};
+    std::atomic<uint32_t>                                   _initialLimit{20};                                      // Starting point of an adaptive limit
+    std::atomic<uint32_t>                                   _minLimit{1};
+    std::atomic<uint32_t>                                   _maxLimit{1000};
+    std::atomic<double>                                     _backoffRatio{0.9};                                     // AIMD decrease factor
+    std::atomic<std::chrono::milliseconds::rep>             _latencyTimeout{0};                                     // AIMD counts slower requests as drops (ms), 0 to ignore latency
+    std::atomic<double>                                     _rttTolerance{1.5};                                     // GRADIENT: latency inflation tolerated before shrinking
+    std::atomic<double>                                     _smoothing{0.2};                                        // GRADIENT: weight of each new limit
+    std::atomic<std::chrono::milliseconds::rep>             _baselineWindow{10000};                                 // GRADIENT: minimum latency window before it starts over (ms)
+
+    // Move the estimate to the next limit and publish it to the hot state
+    void store(Server& server, double estimate);
+
+public:
+    // Constructor
+    ConcurrencyLimiter() = default;
+
+    // Copy the configuration only
+    ConcurrencyLimiter(const ConcurrencyLimiter& other);
+    ConcurrencyLimiter& operator=(const ConcurrencyLimiter& other);
+    ~ConcurrencyLimiter() = default;
+
+    // Adjust the server's limit for one finished request (no-op in FIXED mode)
+    void recordOutcome(Server& server, bool success, std::chrono::nanoseconds latency);
+
+    // Configuration
+    void setMode(ConcurrencyLimitMode mode);
+    ConcurrencyLimitMode getMode() const;
+    void setInitialLimit(uint32_t limit);
+    uint32_t getInitialLimit() const;
+    void setLimitRange(uint32_t minLimit, uint32_t maxLimit);                                                       // minLimit is at least 1
+    uint32_t getMinLimit() const;
+    uint32_t getMaxLimit() const;
+    void setBackoffRatio(double ratio);                                                                             // Clamped to [0.5, 0.99]
+    double getBackoffRatio() const;
+    void setLatencyTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds getLatencyTimeout() const;
+    void setRttTolerance(double tolerance);                                                                         // At least 1
+    double getRttTolerance() const;
+    void setSmoothing(double smoothing);                                                                            // Clamped to [0.01, 1]
+    double getSmoothing() const;
+    void setBaselineWindow(std::chrono::milliseconds window);                                                       // GRADIENT baseline: minimum latency over this window
+    std::chrono::milliseconds getBaselineWindow() const;
+};
+
+#endif // CONCURRENCY_LIMITER_HPP_
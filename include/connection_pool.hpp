@@ -0,0 +1,146 @@
+#ifndef CONNECTION_POOL_HPP_
+#define CONNECTION_POOL_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "server_endpoint.hpp"
+
+class ConnectionPool;
+
+// Move-only handle to one connected, non-blocking TCP socket from a ConnectionPool.
+// Releasing or destroying it hands the socket back for the next request; call markBroken()
+// first when the request failed or left the stream in an unknown state, and it is closed.
+// Must not outlive the pool (leases keep their server, and so its pool, alive).
+class PooledConnection {
+private:
+    ConnectionPool*                                         _pool{nullptr};                                         // Owner, null when empty
+    int                                                     _fd{-1};
+    uint32_t                                                _generation{0};                                         // Pool endpoint generation at connect time
+    bool                                                    _reused{false};                                         // Came from the idle list
+    bool                                                    _broken{false};                                         // Close instead of returning
+
+    friend class ConnectionPool;
+
+    PooledConnection(ConnectionPool* pool, int fd, uint32_t generation, bool reused) noexcept;
+
+public:
+    PooledConnection() noexcept = default;
+    ~PooledConnection();
+
+    // Move-only
+    PooledConnection(const PooledConnection&) = delete;
+    PooledConnection& operator=(const PooledConnection&) = delete;
+    PooledConnection(PooledConnection&& other) noexcept;
+    PooledConnection& operator=(PooledConnection&& other) noexcept;
+
+    // Access
+    int fd() const noexcept;
+    bool reused() const noexcept;                                                                                   // False when a handshake was paid for this one
+    explicit operator bool() const noexcept;
+
+    // Close on release instead of keeping the socket
+    void markBroken() noexcept;
+
+    // Hand the socket back (or close it) now
+    void release() noexcept;
+};
+
+// Keepalive connections to one backend.
+// Idle sockets are kept most-recently-used first, so the warmest one is reused and the
+// coldest ages out. An idle socket is checked before reuse: readable means the peer closed
+// it (or sent something unsolicited), and it is dropped. When the backend's endpoint
+// changes, every connection to the old address is closed instead of being reused.
+// Thread-safe; idle list operations take a short mutex, connects happen outside it.
+class ConnectionPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t                                            connects{0};                                            // New connections established
+        uint64_t                                            connectFailures{0};
+        uint64_t                                            reuses{0};                                              // Acquires served from the idle list
+        uint64_t                                            closedIdle{0};                                          // Dropped after idling too long, or over maxIdle
+        uint64_t                                            closedDead{0};                                          // Found closed by the peer, or marked broken
+    };
+
+private:
+    struct IdleConnection {
+        int                                                 fd;
+        Clock::time_point                                   idleSince;
+    };
+
+    mutable std::mutex                                      _mutex;                                                 // Guards _idle, _endpoint and _generation
+    std::vector<IdleConnection>                             _idle;                                                  // Most recently returned last
+    ServerEndpoint                                          _endpoint{};                                            // Address the idle sockets are connected to
+    uint32_t                                                _generation{0};                                         // Bumped when _endpoint changes
+
+    // Configuration
+    std::atomic<size_t>                                     _maxIdle{16};                                           // Idle sockets kept at most
+    std::atomic<size_t>                                     _targetIdle{0};                                         // prewarm() fills up to this
+    std::atomic<std::chrono::milliseconds::rep>             _idleTimeout{60000};                                    // Idle sockets older than this are closed (ms)
+    std::atomic<std::chrono::milliseconds::rep>             _connectTimeout{1000};                                  // Per connect attempt (ms)
+
+    // Statistics
+    std::atomic<uint64_t>                                   _connects{0};
+    std::atomic<uint64_t>                                   _connectFailures{0};
+    std::atomic<uint64_t>                                   _reuses{0};
+    std::atomic<uint64_t>                                   _closedIdle{0};
+    std::atomic<uint64_t>                                   _closedDead{0};
+
+    friend class PooledConnection;
+
+    // Switch to `endpoint` if it differs, closing the old idle sockets (caller holds _mutex)
+    void useEndpointLocked(const ServerEndpoint& endpoint, std::vector<int>& toClose);
+
+    // Non-blocking connect with the configured timeout, -1 on failure
+    int connect(const ServerEndpoint& endpoint);
+
+    // Live idle socket to `endpoint` (-1 when none) and the generation to hand it out with
+    int takeIdle(const ServerEndpoint& endpoint, uint32_t& generation);
+
+    // Called by PooledConnection::release()
+    void giveBack(int fd, uint32_t generation, bool broken) noexcept;
+
+    static bool isLive(int fd);
+    static void closeSocket(int fd);
+
+public:
+    // Constructor
+    ConnectionPool();
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Live idle connection to `endpoint`, or a new one; empty when connecting failed.
+    // A new connection is made on the calling thread and blocks it for up to the connect timeout.
+    PooledConnection acquire(const ServerEndpoint& endpoint);
+
+    // Live idle connection only; never connects, so it never blocks (empty when none is idle)
+    PooledConnection tryAcquire(const ServerEndpoint& endpoint);
+
+    // Connect until targetIdle sockets are idle; returns how many were opened
+    size_t prewarm(const ServerEndpoint& endpoint);
+
+    // Close idle sockets that died, expired or point at an old endpoint; returns the live idle count
+    size_t maintain(const ServerEndpoint& endpoint, Clock::time_point now);
+
+    size_t idleCount() const;
+    Stats getStats() const;
+
+    // Configuration
+    void setMaxIdle(size_t count);
+    size_t getMaxIdle() const;
+    void setTargetIdle(size_t count);                                                                               // Capped at maxIdle
+    size_t getTargetIdle() const;
+    void setIdleTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds getIdleTimeout() const;
+    void setConnectTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds getConnectTimeout() const;
+};
+
+#endif // CONNECTION_POOL_HPP_
@@ -0,0 +1,134 @@
+#ifndef DNS_RESOLVER_HPP_
+#define DNS_RESOLVER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "metrics.hpp"
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <sys/socket.h>
+#endif
+
+// One address record returned for a host name (port left at zero)
+struct ResolvedAddress {
+    sockaddr_storage                                        address{};                                              // IPv4 or IPv6 address
+    socklen_t                                               length{0};                                              // Valid bytes in address
+};
+
+// Caching resolver that keeps getaddrinfo() off the caller's thread.
+// Lookups are answered from a sharded, read-mostly cache. Entries are refreshed in the
+// background once they pass a fraction of their TTL and keep serving their old records
+// until a refresh succeeds (stale-while-revalidate). Concurrent lookups of a name that is
+// not cached yet share one resolution. All A and AAAA records are kept.
+class DnsResolver {
+public:
+    using Clock      = std::chrono::steady_clock;
+    using Records    = std::vector<ResolvedAddress>;
+    using RecordsPtr = std::shared_ptr<const Records>;
+
+    // Lookup counters (literal addresses are not counted)
+    struct Stats {
+        uint64_t                                            hits{0};                                                // Answered from the cache, fresh or stale
+        uint64_t                                            staleHits{0};                                           // ...of which past their refresh time
+        uint64_t                                            misses{0};                                              // Nothing cached: waited for a first resolution or failed
+    };
+
+private:
+    // Waiters for a name's first resolution
+    struct Pending {
+        std::mutex                                          mutex;
+        std::condition_variable                             done;
+        bool                                                finished{false};
+    };
+
+    struct Entry {
+        RecordsPtr                                          records;                                                // Null until the first resolution finished
+        Clock::time_point                                   refreshAt;                                              // Start a background refresh after this
+        bool                                                refreshing{false};                                      // A resolution is queued or running
+        std::shared_ptr<Pending>                            pending;                                                // Set while nobody has records yet
+    };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex                           mutex;
+        std::unordered_map<std::string, Entry>              entries;
+    };
+
+    static constexpr size_t                                 kShardCount = 16;                                       // Power of two
+    static constexpr std::chrono::seconds                   kNegativeTTL{5};                                        // Retry delay after a failed lookup
+
+    Shard                                                   _shards[kShardCount];
+    std::chrono::seconds                                    _ttl;                                                   // Cache lifetime of resolved records
+    double                                                  _refreshFraction{0.8};                                  // Share of the TTL after which to prefetch
+    mutable std::mutex                                      _configMutex;
+
+    // Resolution queue served by the worker threads
+    std::mutex                                              _queueMutex;
+    std::condition_variable                                 _queueReady;
+    std::deque<std::string>                                 _queue;
+    bool                                                    _stopping{false};
+    std::vector<std::thread>                                _workers;
+
+    // Lookup counters
+    ShardedCounter                                          _hits;
+    ShardedCounter                                          _staleHits;
+    ShardedCounter                                          _misses;
+
+    Shard& shardFor(const std::string& host);
+
+    // Mark the entry refreshing and queue it unless a resolution is already underway
+    // (caller holds the shard's exclusive lock)
+    void scheduleLocked(const std::string& host, Entry& entry);
+
+    void workerLoop();
+
+    // Run getaddrinfo() and store the result
+    void resolveNow(const std::string& host);
+
+    // Literal IPv4/IPv6 address, or null
+    static RecordsPtr parseLiteral(const std::string& host);
+
+public:
+    // Constructor
+    explicit DnsResolver(std::chrono::seconds ttl = std::chrono::seconds(300), size_t workerCount = 2);
+    ~DnsResolver();
+
+    // No copy or move (owns worker threads)
+    DnsResolver(const DnsResolver&) = delete;
+    DnsResolver& operator=(const DnsResolver&) = delete;
+    DnsResolver(DnsResolver&&) = delete;
+    DnsResolver& operator=(DnsResolver&&) = delete;
+
+    // Records for a host. Cached (even stale) records are returned immediately; a name seen
+    // for the first time waits up to `wait` for its resolution. Null when nothing is known.
+    // `refreshAt`, if given, receives when the records are due for re-resolution.
+    RecordsPtr resolve(const std::string& host, std::chrono::milliseconds wait, Clock::time_point* refreshAt = nullptr);
+
+    // Start resolving a host in the background if it is missing or due for refresh
+    void prefetch(const std::string& host);
+
+    // Configuration
+    void setTTL(std::chrono::seconds ttl);
+    std::chrono::seconds getTTL() const;
+    void setRefreshFraction(double fraction);
+    double getRefreshFraction() const;
+
+    // Cache management
+    void clear();
+
+    // Lookup counters since construction
+    Stats getStats() const;
+};
+
+#endif // DNS_RESOLVER_HPP_
@@ -0,0 +1,90 @@
+#ifndef EPOCH_DOMAIN_HPP_
+#define EPOCH_DOMAIN_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Epoch-based reclamation for data published through atomic pointers.
+// Readers enter a critical section with EpochDomain::Guard, which only stores to a
+// cache line owned by the calling thread. Writers swap in a new version and retire
+// the old one; it is destroyed once every reader that could still see it has left.
+class EpochDomain {
+private:
+    struct ThreadSlot;
+
+public:
+    static constexpr size_t kMaxThreads = 1024;                                                                     // Upper bound on concurrently registered threads
+
+    // RAII read-side critical section (nestable on the same thread)
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard(Guard&&) = delete;
+        Guard& operator=(Guard&&) = delete;
+
+    private:
+        ThreadSlot*                                         _slot;                                                  // Calling thread's slot
+    };
+
+    // Process-wide domain
+    static EpochDomain& instance();
+
+    // Dense index of the calling thread, stable for the thread's lifetime and reused after it exits
+    static size_t currentThreadIndex();
+
+    // Defer a reclaimer until all current readers have left their critical sections
+    void retire(std::function<void()> reclaimer);
+
+    // Wait for a grace period and run every pending reclaimer (must not be called inside a Guard)
+    void synchronize();
+
+    // Number of reclaimers still waiting for a grace period
+    size_t pendingCount() const;
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+private:
+    struct alignas(64) ThreadSlot {
+        std::atomic<uint64_t>                               epoch{0};                                               // Epoch observed on entry, 0 when quiescent
+        std::atomic<bool>                                   inUse{false};                                           // Slot owned by a live thread
+        uint32_t                                            nesting{0};                                             // Guard depth, owner thread only
+    };
+
+    struct RetiredEntry {
+        uint64_t                                            epoch;                                                  // Epoch after which the entry is unreachable
+        std::function<void()>                               reclaimer;
+    };
+
+    struct SlotHandle;
+
+    ThreadSlot                                              _slots[kMaxThreads];                                    // Per-thread reader announcements
+    std::atomic<size_t>                                     _slotHighWater{0};                                      // Number of slots ever handed out
+    std::mutex                                              _slotMutex;                                             // Serializes slot registration
+    std::atomic<uint64_t>                                   _globalEpoch{1};                                        // Current epoch (0 is reserved)
+
+    mutable std::mutex                                      _retireMutex;                                           // Protects the retired list
+    std::vector<RetiredEntry>                               _retired;                                               // Entries awaiting a grace period
+
+    EpochDomain() = default;
+
+    // Lowest epoch announced by an active reader, or UINT64_MAX when none
+    uint64_t minActiveEpoch() const;
+
+    // Run reclaimers whose grace period has elapsed (caller holds _retireMutex)
+    std::vector<std::function<void()>> collectLocked(uint64_t safeEpoch);
+
+    size_t acquireSlot();
+    void releaseSlot(size_t index);
+    ThreadSlot& localSlot();
+};
+
+#endif // EPOCH_DOMAIN_HPP_
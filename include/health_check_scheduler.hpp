@@ -0,0 +1,85 @@
+#ifndef HEALTH_CHECK_SCHEDULER_HPP_
+#define HEALTH_CHECK_SCHEDULER_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "server.hpp"
+
+// Spreads health probes across the check interval instead of sweeping every server at once.
+// Each server's first probe lands at a hashed offset into the interval; every later probe is
+// scheduled one (adaptive) interval after the previous one, plus or minus a random jitter.
+// Servers that keep failing back off exponentially up to maxBackoffMultiplier times the base
+// interval, while servers flipping between healthy and unhealthy are checked twice as often.
+// Wakeups are rounded to a granularity of 1/100th of the interval (at least 10 ms), so the
+// checker thread wakes a bounded number of times per interval and probes a small batch each time.
+//
+// Not thread-safe: owned by the single health check thread that drives it.
+class HealthCheckScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    // Per-server schedule
+    struct Entry {
+        Clock::time_point                                   nextDue;                                                // When the next probe is due
+        std::chrono::milliseconds                           interval{0};                                            // Current adaptive interval
+        uint32_t                                            consecutiveFailures{0};                                 // Failed probes in a row
+        uint8_t                                             history{0};                                             // Last eight results, newest in bit 0
+        uint8_t                                             samples{0};                                             // Valid bits in history (max 8)
+        uint64_t                                            seenPass{0};                                            // Last collectDue() pass that listed the server
+    };
+
+    static constexpr uint32_t                               kFlapTransitions = 3;                                   // State changes in the history that count as flapping
+
+    std::chrono::milliseconds                               _baseInterval;                                          // Interval for steady servers
+    double                                                  _jitterFraction;                                        // Jitter as a fraction of the interval
+    uint32_t                                                _maxBackoffMultiplier;                                  // Cap for failing servers, in base intervals
+    uint64_t                                                _offsetSalt;                                            // Per-instance salt for the hashed first offset
+    uint64_t                                                _pass{0};                                               // collectDue() calls so far
+    Clock::time_point                                       _earliestDue;                                           // Minimum nextDue over all entries
+    std::mt19937_64                                         _random;                                                // Jitter source
+    std::unordered_map<const Server*, Entry>                _entries;                                               // Schedules keyed by server
+
+    // Interval for the entry's recent results
+    std::chrono::milliseconds adaptiveInterval(const Entry& entry) const;
+
+    // Interval with +/- jitter applied
+    Clock::duration jittered(std::chrono::milliseconds interval);
+
+    std::chrono::milliseconds granularity() const;
+
+public:
+    // Constructor
+    explicit HealthCheckScheduler(
+        std::chrono::milliseconds baseInterval,
+        double jitterFraction = 0.1,
+        uint32_t maxBackoffMultiplier = 8
+    );
+
+    // Servers from the list whose probe is due at `now`. New servers are given their hashed
+    // offset, servers no longer listed are forgotten.
+    std::vector<std::shared_ptr<Server>> collectDue(const std::vector<std::shared_ptr<Server>>& servers, Clock::time_point now);
+
+    // Read back the health of probed servers and schedule their next probe
+    void recordResults(const std::vector<std::shared_ptr<Server>>& probed, Clock::time_point now);
+
+    // When the checker should wake next (never later than one base interval from now)
+    Clock::time_point nextWakeup(Clock::time_point now) const;
+
+    // Configuration
+    void setBaseInterval(std::chrono::milliseconds interval);
+    std::chrono::milliseconds getBaseInterval() const;
+    void setJitterFraction(double fraction);
+    double getJitterFraction() const;
+    void setMaxBackoffMultiplier(uint32_t multiplier);
+    uint32_t getMaxBackoffMultiplier() const;
+
+    // Current adaptive interval for a server (the base interval if it is not scheduled yet)
+    std::chrono::milliseconds getServerInterval(const Server& server) const;
+};
+
+#endif // HEALTH_CHECK_SCHEDULER_HPP_
@@ -0,0 +1,86 @@
+#ifndef HEALTH_SNAPSHOT_HPP_
+#define HEALTH_SNAPSHOT_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "server.hpp"
+
+// Last-known server state on disk, for warm starts after a restart.
+// The file is a header, a record array sorted by address hash and a string table with the
+// addresses. Records have a fixed little-endian layout, so a loader maps the file and binary
+// searches it in place; nothing is parsed up front. save() writes a temporary file and
+// renames it over the old one, so a crash never leaves a torn snapshot behind.
+class HealthSnapshot {
+public:
+    static constexpr uint64_t kMagic = 0x3150414E5348424CULL;                                                       // "LBHSNAP1" little-endian
+    static constexpr uint32_t kVersion = 1;
+
+    struct Header {
+        uint64_t                                            magic;
+        uint32_t                                            version;
+        uint32_t                                            recordSize;                                             // sizeof(Record), guards against layout changes
+        uint64_t                                            recordCount;
+        uint64_t                                            stringBytes;                                            // Size of the string table after the records
+        int64_t                                             writtenAtMillis;                                        // system_clock time of the save
+        uint64_t                                            checksum;                                               // FNV-1a over records and strings
+    };
+
+    struct Record {
+        uint64_t                                            addressHash;                                            // Sort key
+        uint32_t                                            addressOffset;                                          // Into the string table
+        uint32_t                                            addressLength;
+        uint32_t                                            flags;                                                  // ServerHotState kAlive | kHealthy
+        uint32_t                                            weight;
+        uint64_t                                            latencyEwmaNanos;                                       // 0 when never measured
+        float                                               peakLatencyMicros;                                      // 0 when never measured
+        uint16_t                                            endpointFamily;                                         // 4, 6, or 0 without an endpoint
+        uint16_t                                            endpointPort;
+        uint8_t                                             endpointAddress[16];                                    // Network byte order
+        uint32_t                                            endpointScope;                                          // IPv6 scope id
+        uint32_t                                            reserved;
+    };
+
+private:
+    const uint8_t*                                          _data{nullptr};                                         // Mapped (or read) file, null when not open
+    size_t                                                  _size{0};
+    bool                                                    _mapped{false};                                         // _data came from mmap()
+    std::vector<uint8_t>                                    _buffer;                                                // File contents where mmap() is unavailable
+
+    const Header& header() const;
+    const Record* records() const;
+    const char* strings() const;
+
+    void close();
+
+public:
+    // Constructor
+    HealthSnapshot() = default;
+    ~HealthSnapshot();
+
+    HealthSnapshot(const HealthSnapshot&) = delete;
+    HealthSnapshot& operator=(const HealthSnapshot&) = delete;
+
+    // Write the servers' state to `path`; false on any I/O failure
+    static bool save(const std::string& path, const std::vector<std::shared_ptr<Server>>& servers);
+
+    // Map and validate a snapshot; false when missing, corrupt, foreign or older than maxAge
+    bool open(const std::string& path, std::chrono::seconds maxAge = std::chrono::minutes(10));
+    bool isOpen() const;
+
+    // Record for an address, or null
+    const Record* find(const std::string& serverAddress) const;
+
+    // Apply the server's record: health, weight, latency averages (only when none were
+    // measured yet) and, for servers without one, the endpoint with the given refresh time.
+    // Returns false when the snapshot has no record for the server.
+    bool restore(Server& server, std::chrono::steady_clock::time_point endpointRefreshAt) const;
+
+    size_t size() const;
+    std::chrono::system_clock::time_point writtenAt() const;
+};
+
+#endif // HEALTH_SNAPSHOT_HPP_
@@ -0,0 +1,124 @@
+#ifndef IP_HASH_LOAD_BALANCER_HPP_
+#define IP_HASH_LOAD_BALANCER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "round_robin_load_balancer.hpp"
+
+// Consistent hashing algorithm used to map client keys onto servers
+enum class HashAlgorithm {
+    RING,       // Hash ring with virtual nodes
+    MAGLEV,     // Maglev lookup table
+    JUMP        // Jump consistent hash over the server order (removals remap more than 1/N)
+};
+
+// IP hash engine
+// Sticky selection keyed by client address. Server positions are derived from server
+// addresses, so adding or removing a server only remaps roughly 1/N of the clients.
+// With a load bound factor > 0, a server whose current connections exceed
+// (1 + factor) * average is skipped (consistent hashing with bounded loads). The bound is
+// kept per snapshot, so each locality tier is bounded by its own average, and refreshed
+// every 64 picks per thread or when the factor changes. A server at its concurrency limit is
+// passed over the same way, so a key only fails when every server is saturated.
+class IpHashEngine : public SelectionEngine {
+private:
+    // Snapshot carrying the lookup structure for its server list
+    struct HashSnapshot : ServerSnapshot {
+        HashAlgorithm                                       algorithm;                                          // Algorithm the structure was built for
+        std::vector<std::pair<uint64_t, uint32_t>>          ring;                                               // Sorted (point, server index) pairs for RING
+        std::vector<uint32_t>                               table;                                              // Lookup table for MAGLEV
+        mutable std::atomic<uint32_t>                       loadBound{0};                                       // Cached per-server connection bound, 0 = unbounded
+        mutable std::atomic<double>                         loadBoundFactor{-1.0};                              // Factor the bound was computed with, -1 before the first pick
+
+        HashSnapshot(std::vector<std::shared_ptr<Server>> serverList, HashAlgorithm hashAlgorithm)
+            : ServerSnapshot(std::move(serverList)), algorithm(hashAlgorithm) {}
+    };
+
+    static constexpr size_t                                 kVirtualNodesPerServer = 160;                       // Ring points per server
+    static constexpr size_t                                 kMinMaglevTableSize = 65537;                        // Smallest Maglev table (prime)
+    static constexpr uint64_t                               kLoadBoundRefreshMask = 63;                         // Recompute the load bound every 64 picks per thread
+    static constexpr size_t                                 kMaxProbesPerServer = 4;                            // Probe budget before falling back to a scan
+
+    std::atomic<HashAlgorithm>                              _algorithm{HashAlgorithm::RING};
+    std::atomic<double>                                     _loadBoundFactor{0.25};                             // Epsilon for bounded loads, 0 disables
+    std::atomic<uint64_t>                                   _pickCounter{0};                                    // Spreads keyless picks across the hash space
+
+    // Index picked for a key hash from the given snapshot, or ServerSnapshot::npos
+    size_t selectForHash(const HashSnapshot& snapshot, uint64_t keyHash);
+
+    // Recompute the snapshot's bounded-load capacity from its hot states' connection counts
+    static uint32_t refreshLoadBound(const HashSnapshot& snapshot, double factor);
+
+public:
+    static constexpr LoadBalancingStrategy                  kStrategy = LoadBalancingStrategy::IP_HASH;
+
+    // Constructor
+    explicit IpHashEngine(HashAlgorithm algorithm = HashAlgorithm::RING, double loadBoundFactor = 0.25);
+
+    // No copy or move (snapshots point to the engine); see clone()
+    IpHashEngine(const IpHashEngine&) = delete;
+    IpHashEngine& operator=(const IpHashEngine&) = delete;
+    ~IpHashEngine() override = default;
+
+    LoadBalancingStrategy strategy() const override;
+    std::unique_ptr<SelectionEngine> clone() const override;
+
+    // Build a snapshot with the lookup structure for its servers
+    ServerSnapshot* buildSnapshot(std::vector<std::shared_ptr<Server>> servers) const override;
+
+    // Keyless pick; spreads requests across the hash space
+    size_t selectIndex(const ServerSnapshot& snapshot, const SlowStart& slowStart) override;
+
+    // Sticky pick for a key hash
+    size_t selectForKey(const ServerSnapshot& snapshot, const SlowStart& slowStart, uint64_t keyHash) override;
+
+    // Configuration (a new algorithm applies to snapshots built afterwards)
+    void setHashAlgorithm(HashAlgorithm algorithm);
+    HashAlgorithm getHashAlgorithm() const;
+    void setLoadBoundFactor(double factor);
+    double getLoadBoundFactor() const;
+
+    // Stable 64-bit hash used for keys and server positions
+    static uint64_t hashKey(const std::string& key, uint64_t seed = 0);
+};
+
+// IP Hash Load Balancer
+// A LoadBalancer starting on the IP hash engine (see IpHashEngine), with sticky picks by
+// client address. The sticky calls fall back to a plain pick while another strategy is set.
+class IpHashLoadBalancer : public LoadBalancer {
+public:
+    // Constructor
+    explicit IpHashLoadBalancer(
+        const std::vector<std::shared_ptr<Server>>& servers,
+        uint32_t healthCheckInterval = 5000,
+        uint32_t maxHealthCheckFailures = 3,
+        HashAlgorithm algorithm = HashAlgorithm::RING,
+        double loadBoundFactor = 0.25
+    );
+
+    // Copy/move constructors and assignment operators
+    IpHashLoadBalancer(const IpHashLoadBalancer& other);
+    IpHashLoadBalancer(IpHashLoadBalancer&& other) noexcept;
+    IpHashLoadBalancer& operator=(const IpHashLoadBalancer& other);
+    IpHashLoadBalancer& operator=(IpHashLoadBalancer&& other) noexcept;
+    ~IpHashLoadBalancer() override;
+
+    // Sticky pick for a client address (or any other affinity key)
+    std::shared_ptr<Server> getServerForClient(const std::string& clientAddress);
+    ServerLease acquireServerForClient(const std::string& clientAddress);
+
+    // Configuration
+    void setHashAlgorithm(HashAlgorithm algorithm);                                                             // Rebuilds the lookup structure
+    HashAlgorithm getHashAlgorithm() const;
+    void setLoadBoundFactor(double factor);
+    double getLoadBoundFactor() const;
+
+    // Stable 64-bit hash used for keys and server positions
+    static uint64_t hashKey(const std::string& key, uint64_t seed = 0);
+};
+
+#endif // IP_HASH_LOAD_BALANCER_HPP_
@@ -0,0 +1,75 @@
+#ifndef LEAST_CONNECTIONS_LOAD_BALANCER_HPP_
+#define LEAST_CONNECTIONS_LOAD_BALANCER_HPP_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "round_robin_load_balancer.hpp"
+
+// Least connections engine
+// Uses power-of-two-choices: two random healthy servers are sampled and the one with the
+// lower load wins. Load is (connections + 1) per unit of effective weight, so it follows
+// Server::getEffectiveLoad() and lets slow start thin out ramping servers even when idle.
+// Pools at or below the full scan threshold are scanned completely instead, from a rotating
+// start so that servers with equal load take turns. A server at its concurrency limit loses
+// to one below it, and when both draws are saturated the scan looks for any free server.
+class LeastConnectionsEngine : public SelectionEngine {
+private:
+    std::atomic<size_t>                                     _fullScanThreshold{8};                              // Pool size at or below which every server is compared
+    std::atomic<size_t>                                     _scanStart{0};                                      // Rotating first index of the full scan
+
+    // Connections per unit of slow start adjusted weight
+    static double loadOf(const ServerHotState& state, const SlowStart& slowStart);
+
+    // Least loaded server by full scan (healthy first, then alive fallback, each preferring
+    // servers below their concurrency limit). The scan starts one server further on each
+    // call and ties keep the first seen, so equal loads rotate.
+    size_t scanLeastLoaded(const std::vector<const ServerHotState*>& states, const SlowStart& slowStart);
+
+public:
+    static constexpr LoadBalancingStrategy                  kStrategy = LoadBalancingStrategy::LEAST_CONNECTIONS;
+
+    // Constructor
+    explicit LeastConnectionsEngine(size_t fullScanThreshold = 8);
+
+    // No copy or move (snapshots point to the engine); see clone()
+    LeastConnectionsEngine(const LeastConnectionsEngine&) = delete;
+    LeastConnectionsEngine& operator=(const LeastConnectionsEngine&) = delete;
+    ~LeastConnectionsEngine() override = default;
+
+    LoadBalancingStrategy strategy() const override;
+    std::unique_ptr<SelectionEngine> clone() const override;
+
+    // Power-of-two-choices (or full scan) over the snapshot
+    size_t selectIndex(const ServerSnapshot& snapshot, const SlowStart& slowStart) override;
+
+    // Configuration
+    void setFullScanThreshold(size_t serverCount);
+    size_t getFullScanThreshold() const;
+};
+
+// Least Connections Load Balancer
+// A LoadBalancer starting on the least connections engine (see LeastConnectionsEngine).
+class LeastConnectionsLoadBalancer : public LoadBalancer {
+public:
+    // Constructor
+    explicit LeastConnectionsLoadBalancer(
+        const std::vector<std::shared_ptr<Server>>& servers,
+        uint32_t healthCheckInterval = 5000,
+        uint32_t maxHealthCheckFailures = 3,
+        size_t fullScanThreshold = 8
+    );
+
+    // Copy/move constructors and assignment operators
+    LeastConnectionsLoadBalancer(const LeastConnectionsLoadBalancer& other);
+    LeastConnectionsLoadBalancer(LeastConnectionsLoadBalancer&& other) noexcept;
+    LeastConnectionsLoadBalancer& operator=(const LeastConnectionsLoadBalancer& other);
+    LeastConnectionsLoadBalancer& operator=(LeastConnectionsLoadBalancer&& other) noexcept;
+    ~LeastConnectionsLoadBalancer() override;
+
+    // Configuration
+    void setFullScanThreshold(size_t serverCount);
+    size_t getFullScanThreshold() const;
+};
+
+#endif // LEAST_CONNECTIONS_LOAD_BALANCER_HPP_
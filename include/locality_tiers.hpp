@@ -0,0 +1,87 @@
+#ifndef LOCALITY_TIERS_HPP_
+#define LOCALITY_TIERS_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "server.hpp"
+#include "server_snapshot.hpp"
+
+class SelectionEngine;
+
+// Monitoring view of one tier
+struct TierStats {
+    uint32_t                                                priority{0};
+    bool                                                    local{true};                                            // Servers in the balancer's zone
+    size_t                                                  servers{0};
+    size_t                                                  healthyServers{0};
+    double                                                  share{0.0};                                             // Fraction of picks currently routed here
+};
+
+// Locality tiers of a published server list.
+// Servers are grouped by (priority, in the local zone or not), most preferred first. A tier
+// takes all traffic while at least `threshold` of its servers are available; below that it
+// keeps the share its healthy fraction covers (healthy / threshold) and the rest spills over
+// to the following tiers. Each tier has its own engine-built snapshot, and the cumulative
+// shares are recomputed only when a tier's available count changes, so a pick costs one
+// draw and a scan over at most kMaxTiers thresholds. Key-based picks draw from the key hash
+// instead of at random, so they keep the engine's affinity across tiers.
+class LocalityTiers {
+public:
+    static constexpr size_t kMaxTiers = 8;                                                                          // Further tiers merge into the last one
+
+    struct Tier {
+        std::unique_ptr<ServerSnapshot>                     snapshot;                                               // Built by the balancer's engine
+        uint32_t                                            priority{0};
+        bool                                                local{true};
+    };
+
+private:
+    std::vector<Tier>                                       _tiers;                                                 // Preference order
+    double                                                  _threshold;
+    mutable std::array<std::atomic<uint64_t>, kMaxTiers>    _cumulative{};                                          // Share boundaries scaled to 2^32, all 0 when nothing is available
+    mutable std::array<std::atomic<size_t>, kMaxTiers>      _availableSeen{};                                       // Counts the shares were computed from
+    mutable std::mutex                                      _updateMutex;                                           // One recompute at a time
+
+    // Share of each tier for the given available counts, in tier order
+    std::array<double, kMaxTiers> sharesFor(const std::array<size_t, kMaxTiers>& availableCounts) const;
+
+    // Recompute the cumulative shares from the tiers' available counts (caller holds _updateMutex)
+    void updateShares() const;
+
+    // Tier whose share range holds `point` (scaled to 2^32)
+    const ServerSnapshot* selectAt(uint64_t point) const;
+
+public:
+    // Groups `servers` into tiers; returns null when they all fall into one tier
+    static std::unique_ptr<LocalityTiers> build(
+        const std::vector<std::shared_ptr<Server>>& servers,
+        const std::string& localZone,
+        double threshold,
+        SelectionEngine& engine
+    );
+
+    LocalityTiers(std::vector<Tier> tiers, double threshold);
+
+    LocalityTiers(const LocalityTiers&) = delete;
+    LocalityTiers& operator=(const LocalityTiers&) = delete;
+
+    // Bring tier snapshots and shares up to date with server health
+    void sync() const;
+
+    // Snapshot of the tier this pick goes to, null when no tier has an available server
+    const ServerSnapshot* select() const;
+
+    // Same, with the draw taken from a key hash, so a key stays in one tier while shares hold
+    const ServerSnapshot* selectForKey(uint64_t keyHash) const;
+
+    size_t size() const;
+    std::vector<TierStats> stats() const;
+};
+
+#endif // LOCALITY_TIERS_HPP_
@@ -0,0 +1,117 @@
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "epoch_domain.hpp"
+
+// Counter split into cache-line-sized shards chosen by the calling thread's index, so
+// threads counting the same event rarely write the same line. Reads add up the shards.
+template <size_t Shards>
+class BasicShardedCounter {
+private:
+    static_assert((Shards & (Shards - 1)) == 0, "Shard count must be a power of two");
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t>                               value{0};
+    };
+
+    Shard                                                   _shards[Shards];
+
+public:
+    void add(uint64_t amount = 1)
+    {
+        // Several threads can map to one shard, so the add stays atomic
+        _shards[EpochDomain::currentThreadIndex() & (Shards - 1)].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const
+    {
+        uint64_t total = 0;
+        for (const Shard& shard : _shards) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+using ShardedCounter = BasicShardedCounter<16>;                                                                     // Balancer-wide events
+using ServerCounter = BasicShardedCounter<4>;                                                                       // Per-server events (one per server, kept small)
+
+// Latency histogram with fixed, Prometheus-style bucket bounds from 100 us to 5 s.
+// Meant for probe paths, which record a few samples per server and interval, so the
+// buckets are plain relaxed atomics rather than sharded.
+class LatencyHistogram {
+public:
+    static constexpr size_t kBucketCount = 15;                                                                      // Finite bounds; one more bucket for +Inf
+
+    static constexpr std::array<double, kBucketCount> kBoundsSeconds{
+        0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0
+    };
+
+    // Point-in-time copy for export
+    struct Snapshot {
+        std::array<uint64_t, kBucketCount + 1>              buckets{};                                              // Per-bucket (not cumulative) counts, last is +Inf
+        uint64_t                                            count{0};
+        double                                              sumSeconds{0.0};
+
+        Snapshot& operator+=(const Snapshot& other);
+    };
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount + 1>     _buckets{};
+    std::atomic<uint64_t>                                   _sumNanos{0};
+
+public:
+    void observe(std::chrono::nanoseconds duration);
+    Snapshot snapshot() const;
+};
+
+// Per-server counters, kept in the cold part of Server
+struct ServerMetrics {
+    ServerCounter                                           picks;                                                  // Times the server was selected (opt-in, see LoadBalancer)
+    std::atomic<uint64_t>                                   probes{0};                                              // Active health probes sent
+    std::atomic<uint64_t>                                   probeFailures{0};                                       // Probes that failed or timed out
+    LatencyHistogram                                        probeDuration;                                          // Round trip of successful probes
+
+    // Count one probe result
+    void recordProbe(bool success, std::chrono::nanoseconds duration);
+};
+
+// Per-balancer counters, updated on every pick
+struct BalancerMetrics {
+    ShardedCounter                                          picks;                                                  // Picks that returned a server
+    ShardedCounter                                          fallbackPicks;                                          // ...of which went to an alive but unhealthy server
+    ShardedCounter                                          emptyPicks;                                             // Picks that found no server
+    ShardedCounter                                          rejectedPicks;                                          // Picks refused because every candidate server was at its concurrency limit
+};
+
+// Builder for the Prometheus text exposition format (version 0.0.4)
+class PrometheusWriter {
+private:
+    std::string                                             _text;
+
+    void appendLabels(const std::string& labels);
+    void appendValue(double value);
+
+public:
+    // "# HELP" and "# TYPE" lines; type is counter, gauge or histogram
+    void family(const std::string& name, const std::string& help, const std::string& type);
+
+    // One sample line; labels are preformatted (see label())
+    void sample(const std::string& name, const std::string& labels, double value);
+
+    // Bucket, sum and count lines of a histogram
+    void histogram(const std::string& name, const std::string& labels, const LatencyHistogram::Snapshot& snapshot);
+
+    // name="value" with the value escaped
+    static std::string label(const std::string& name, const std::string& value);
+
+    const std::string& text() const;
+};
+
+#endif // METRICS_HPP_
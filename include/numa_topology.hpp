@@ -0,0 +1,37 @@
+#ifndef NUMA_TOPOLOGY_HPP_
+#define NUMA_TOPOLOGY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU to NUMA node map of the host, read once from /sys/devices/system/node on Linux.
+// Elsewhere, or when sysfs has no node directories, every CPU belongs to node 0.
+class NumaTopology {
+private:
+    std::vector<uint32_t>                                   _cpuNode;                                               // Node of each CPU id
+    std::vector<std::vector<uint32_t>>                      _nodeCpus;                                              // CPU ids of each node, never empty
+
+    NumaTopology();
+
+public:
+    // Process-wide topology
+    static const NumaTopology& instance();
+
+    size_t nodeCount() const;
+    size_t cpuCount() const;                                                                                        // Highest CPU id + 1
+    uint32_t nodeOf(uint32_t cpu) const;                                                                            // Node 0 for unknown CPUs
+    const std::vector<uint32_t>& cpusOf(uint32_t node) const;
+
+    // CPU and node the calling thread runs on right now (0 where unknown)
+    static uint32_t currentCpu();
+    uint32_t currentNode() const;
+
+    // Restrict the calling thread to `cpus`; false where unsupported or refused
+    static bool bindCurrentThread(const std::vector<uint32_t>& cpus);
+
+    NumaTopology(const NumaTopology&) = delete;
+    NumaTopology& operator=(const NumaTopology&) = delete;
+};
+
+#endif // NUMA_TOPOLOGY_HPP_
@@ -0,0 +1,102 @@
+#ifndef OUTLIER_DETECTOR_HPP_
+#define OUTLIER_DETECTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "server.hpp"
+
+// Passive health checking from live request outcomes.
+// The data path reports each request through recordOutcome(). A server is ejected (marked
+// unhealthy) on the spot once it reaches the consecutive failure threshold or its error
+// rate over the current window exceeds the threshold. Windows roll by time as outcomes
+// arrive, and the pick path returns servers whose ejection ended through expireDue(), so
+// passive checking works without a health check thread. evaluate(), run periodically by
+// the health check thread, also ejects latency outliers against the pool median.
+// Ejections last baseEjectionTime times the number of recent ejections (capped at 10x), and
+// at most maxEjectionPercent of the pool is ejected at once. Active probes do not mark an
+// ejected server healthy before its ejection ends.
+class OutlierDetector {
+private:
+    static constexpr uint32_t                               kMaxEjectionMultiplier = 10;                            // Cap on repeat ejection scaling
+    static constexpr size_t                                 kMinLatencySamples = 3;                                 // Servers needed for a meaningful median
+    static constexpr uint32_t                               kExpiryCheckPicks = 256;                                // Picks per thread between ejection expiry checks
+    static constexpr std::chrono::milliseconds              kExpiryCheckInterval{100};                              // Minimum time between expiry walks
+
+    std::atomic<bool>                                       _enabled{true};
+    std::atomic<uint32_t>                                   _consecutiveFailureThreshold{5};                        // Failures in a row that eject
+    std::atomic<double>                                     _errorRateThreshold{0.5};                               // Window error rate that ejects
+    std::atomic<uint32_t>                                   _minimumRequests{20};                                   // Window volume before rates count
+    std::atomic<double>                                     _latencyOutlierFactor{3.0};                             // Multiple of the median latency that ejects
+    std::atomic<std::chrono::milliseconds::rep>             _baseEjectionTime{30000};                               // First ejection length (ms)
+    std::atomic<uint32_t>                                   _maxEjectionPercent{50};                                // Share of the pool that may be ejected
+    std::atomic<std::chrono::milliseconds::rep>             _evaluationInterval{1000};                              // Window length between evaluations (ms)
+
+    std::atomic<size_t>                                     _poolSize{0};                                           // Server count of the current snapshot
+    std::atomic<size_t>                                     _ejectedCount{0};                                       // Currently ejected servers
+    std::atomic<std::chrono::steady_clock::rep>             _nextEvaluation{0};                                     // When evaluate() does work again
+    std::atomic<std::chrono::steady_clock::rep>             _nextExpiryCheck{0};                                    // When expireDue() walks the pool again
+
+    // Eject the server unless it is already out or the ejection cap is reached
+    bool eject(Server& server, std::chrono::steady_clock::time_point now);
+
+    // Rejoin a server whose ejection ended; returns true while it stays ejected
+    bool expireIfDue(Server& server, std::chrono::steady_clock::rep nowTicks);
+
+    // Start a new error-rate window once the current one is an evaluation interval old
+    void rollWindow(ServerOutcomeStats& stats, std::chrono::steady_clock::rep nowTicks);
+
+    // Rate-limited walk behind expireDue()
+    void expireSlow(const std::vector<std::shared_ptr<Server>>& servers);
+
+public:
+    // Constructor
+    OutlierDetector() = default;
+
+    // Copy the configuration only
+    OutlierDetector(const OutlierDetector& other);
+    OutlierDetector& operator=(const OutlierDetector& other);
+    ~OutlierDetector() = default;
+
+    // Report one request; returns true if this outcome ejected the server
+    bool recordOutcome(Server& server, bool success, std::chrono::nanoseconds latency);
+
+    // Latency outliers, expired ejections and window rollover (at most once per evaluation interval)
+    void evaluate(const std::vector<std::shared_ptr<Server>>& servers, std::chrono::steady_clock::time_point now);
+
+    // Return servers whose ejection ended; a single load while nothing is ejected, so it is
+    // cheap enough for every pick (call inside the guard with the snapshot's server list)
+    void expireDue(const std::vector<std::shared_ptr<Server>>& servers)
+    {
+        if (_ejectedCount.load(std::memory_order_relaxed) != 0) {
+            expireSlow(servers);
+        }
+    }
+
+    // Pool size the ejection cap is taken from; set whenever a snapshot is published
+    void setPoolSize(size_t servers);
+
+    size_t getEjectedCount() const;
+
+    // Configuration
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    void setConsecutiveFailureThreshold(uint32_t failures);
+    uint32_t getConsecutiveFailureThreshold() const;
+    void setErrorRateThreshold(double rate);
+    double getErrorRateThreshold() const;
+    void setMinimumRequests(uint32_t requests);
+    uint32_t getMinimumRequests() const;
+    void setLatencyOutlierFactor(double factor);
+    double getLatencyOutlierFactor() const;
+    void setBaseEjectionTime(std::chrono::milliseconds duration);
+    std::chrono::milliseconds getBaseEjectionTime() const;
+    void setMaxEjectionPercent(uint32_t percent);
+    uint32_t getMaxEjectionPercent() const;
+    void setEvaluationInterval(std::chrono::milliseconds interval);
+    std::chrono::milliseconds getEvaluationInterval() const;
+};
+
+#endif // OUTLIER_DETECTOR_HPP_
@@ -0,0 +1,71 @@
+#ifndef PEAK_EWMA_LOAD_BALANCER_HPP_
+#define PEAK_EWMA_LOAD_BALANCER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "round_robin_load_balancer.hpp"
+
+// Peak-EWMA engine
+// Picks by predicted latency: each server's peak-EWMA response time (fed by
+// ServerLease::complete() and LoadBalancer::reportOutcome(), read from ServerHotState)
+// times its outstanding requests plus one, divided by its weight. Two random healthy servers are compared
+// (power-of-two-choices), so a pick stays O(1). Servers without latency samples cost
+// nothing while idle, so they get tried, and are costed at the default latency while
+// their first requests are outstanding. A server at its concurrency limit loses to one below
+// it; when both draws are saturated, a scan looks for the cheapest free server.
+class PeakEwmaEngine : public SelectionEngine {
+private:
+    std::atomic<std::chrono::microseconds::rep>             _defaultLatency{10000};                             // Assumed latency before the first sample (us)
+
+    // Predicted cost of sending one more request to snapshot.servers[index]
+    double cost(const ServerSnapshot& snapshot, const SlowStart& slowStart, size_t index, std::chrono::steady_clock::time_point now) const;
+
+public:
+    static constexpr LoadBalancingStrategy                  kStrategy = LoadBalancingStrategy::PEAK_EWMA;
+
+    // Constructor
+    explicit PeakEwmaEngine(std::chrono::microseconds defaultLatency = std::chrono::milliseconds(10));
+
+    // No copy or move (snapshots point to the engine); see clone()
+    PeakEwmaEngine(const PeakEwmaEngine&) = delete;
+    PeakEwmaEngine& operator=(const PeakEwmaEngine&) = delete;
+    ~PeakEwmaEngine() override = default;
+
+    LoadBalancingStrategy strategy() const override;
+    std::unique_ptr<SelectionEngine> clone() const override;
+
+    // Power-of-two-choices on predicted latency, full scan if sampling misses or finds both saturated
+    size_t selectIndex(const ServerSnapshot& snapshot, const SlowStart& slowStart) override;
+
+    // Configuration
+    void setDefaultLatency(std::chrono::microseconds latency);
+    std::chrono::microseconds getDefaultLatency() const;
+};
+
+// Peak-EWMA Load Balancer
+// A LoadBalancer starting on the peak-EWMA engine (see PeakEwmaEngine).
+class PeakEwmaLoadBalancer : public LoadBalancer {
+public:
+    // Constructor
+    explicit PeakEwmaLoadBalancer(
+        const std::vector<std::shared_ptr<Server>>& servers,
+        uint32_t healthCheckInterval = 5000,
+        uint32_t maxHealthCheckFailures = 3,
+        std::chrono::microseconds defaultLatency = std::chrono::milliseconds(10)
+    );
+
+    // Copy/move constructors and assignment operators
+    PeakEwmaLoadBalancer(const PeakEwmaLoadBalancer& other);
+    PeakEwmaLoadBalancer(PeakEwmaLoadBalancer&& other) noexcept;
+    PeakEwmaLoadBalancer& operator=(const PeakEwmaLoadBalancer& other);
+    PeakEwmaLoadBalancer& operator=(PeakEwmaLoadBalancer&& other) noexcept;
+    ~PeakEwmaLoadBalancer() override;
+
+    // Configuration
+    void setDefaultLatency(std::chrono::microseconds latency);
+    std::chrono::microseconds getDefaultLatency() const;
+};
+
+#endif // PEAK_EWMA_LOAD_BALANCER_HPP_
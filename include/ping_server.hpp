@@ -12,9 +12,8 @@
 #include <thread>
 #include <mutex>
 #include "server.hpp"
-
-// Forward declaration
-struct ResolvedAddress;
+#include "probe_engine.hpp"
+#include "dns_resolver.hpp"
 
 class PingServer {
 private:
@@ -25,18 +24,17 @@ private:
     std::atomic<size_t>                                     _threadPoolSize{4};       // Thread pool size
     
     // DNS cache
-    struct DNSCacheEntry {
-        std::string resolvedIP;
-        std::chrono::steady_clock::time_point expiryTime;
-    };
-    
-    std::unordered_map<std::string, DNSCacheEntry>          _dnsCache;               // Cache for DNS resolution
-    std::mutex                                              _dnsCacheMutex;          // Mutex for DNS cache
-    std::chrono::seconds                                    _dnsCacheTTL{300};       // DNS cache TTL (5 minutes)
+    DnsResolver                                             _resolver;               // Async resolver with prefetch (default TTL 5 minutes)
     
     // Function type for custom ping implementations
     using PingImplementation = std::function<bool(const std::string&, std::chrono::milliseconds)>;
     PingImplementation                                      _pingImplementation;      // Custom ping implementation
+    std::atomic<bool>                                       _usingDefaultPing{true};  // Sweeps go through the probe engine
+    
+    // Non-blocking sweep engine (not thread-safe, one sweep at a time)
+    ProbeEngine                                             _probeEngine;            // Multiplexed TCP connect probes
+    std::mutex                                              _probeEngineMutex;       // Serializes sweeps on the engine
+    std::atomic<size_t>                                     _maxProbesInFlight{1024}; // Applied to the engine per sweep
 
     // Default ping implementation
     bool defaultPingImplementation(const std::string& serverAddress, std::chrono::milliseconds timeout);
@@ -44,11 +42,19 @@ private:
     // Background ping worker function
     void pingWorker(const std::vector<std::shared_ptr<Server>>& servers);
     
-    // DNS resolution with caching
-    std::string resolveHostname(const std::string& hostname);
+    // Resolve a host and port into an endpoint, waiting up to `wait` for a first lookup
+    bool resolveEndpoint(const std::string& host, uint16_t port, ServerEndpoint& endpoint, std::chrono::milliseconds wait);
+    
+    // Update health, failure count, liveness and probe metrics from one probe result
+    static void applyPingResult(Server& server, bool result, std::chrono::nanoseconds elapsed);
+    
+    // Mark a server with live pooled sockets alive and healthy; no probe was sent, so the
+    // probe counters and the probe latency histogram are left alone
+    static void applyPooledLiveness(Server& server);
     
-    // Parse server address 
-    bool parseServerAddress(const std::string& serverAddress, std::string& host, int& port);
+    // Sweep with the probe engine, all connects in flight on one thread
+    bool multiplexedPingImplementation(std::vector<std::shared_ptr<Server>>& servers,
+                                       std::chrono::milliseconds timeout);
     
     // Parallel ping implementation
     bool parallelPingImplementation(std::vector<std::shared_ptr<Server>>& servers, 
@@ -84,8 +90,10 @@ public:
     std::chrono::milliseconds getTimeout() const;
     void setInterval(std::chrono::milliseconds interval);
     std::chrono::milliseconds getInterval() const;
-    void setThreadPoolSize(size_t size);
+    void setThreadPoolSize(size_t size);                               // Worker threads for custom ping implementations
     size_t getThreadPoolSize() const;
+    void setMaxProbesInFlight(size_t count);                           // Concurrent connects for the default sweep
+    size_t getMaxProbesInFlight() const;
     void setDNSCacheTTL(std::chrono::seconds ttl);
     std::chrono::seconds getDNSCacheTTL() const;
     
@@ -95,6 +103,7 @@ public:
     
     // DNS cache management
     void clearDNSCache();
+    DnsResolver::Stats getDNSCacheStats() const;
 };
 
 #endif // PING_SERVER_HPP_
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef PROBE_ENGINE_HPP_
+#define PROBE_ENGINE_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <sys/socket.h>
+#endif
+
+// Address of one TCP connect probe
+struct ProbeTarget {
+    sockaddr_storage                                        address{};                                              // Destination (IPv4 or IPv6)
+    socklen_t                                               addressLength{0};                                       // Valid bytes in address, 0 when unresolved
+    size_t                                                  id{0};                                                  // Caller's handle, passed back on completion
+};
+
+// Single-threaded, non-blocking TCP connect engine.
+// Keeps up to maxInFlight connects outstanding at once and waits for all of them with one
+// epoll instance (poll() on other platforms). Timeouts are tracked on a hashed timer wheel,
+// so each probe costs O(1) to arm and expire regardless of how many are in flight.
+class ProbeEngine {
+public:
+    // Called once per target; `elapsed` runs from the connect() call to its outcome (zero when
+    // the probe could not be started)
+    using Completion = std::function<void(size_t id, bool success, std::chrono::nanoseconds elapsed)>;
+
+private:
+    // One outstanding connect
+    struct InFlight {
+        int                                                 fd{-1};                                                 // Socket, -1 when the slot is free
+        size_t                                              id{0};                                                  // Caller's handle
+        uint64_t                                            deadlineTick{0};                                        // Wheel tick at which the probe times out
+        uint32_t                                            generation{0};                                          // Bumped on reuse, invalidates stale wheel entries
+        std::chrono::steady_clock::time_point               startedAt;                                              // When connect() was issued
+    };
+
+    // Wheel entry; stale once the slot's generation moved on
+    struct TimerEntry {
+        uint32_t                                            slot;
+        uint32_t                                            generation;
+    };
+
+    size_t                                                  _maxInFlight;                                           // Concurrent connects per run
+    std::chrono::milliseconds                               _tick;                                                  // Timer wheel resolution
+    int                                                     _pollFd{-1};                                            // epoll instance (Linux only)
+
+    std::vector<InFlight>                                   _slots;                                                 // Outstanding connects, indexed by slot
+    std::vector<uint32_t>                                   _freeSlots;                                             // Unused slot indices
+    std::vector<std::vector<TimerEntry>>                    _wheel;                                                 // Timeout buckets, power of two sized
+    size_t                                                  _inFlightCount{0};
+
+    // Start a connect; returns false if it could not be started for lack of descriptors
+    bool launch(const ProbeTarget& target, uint64_t deadlineTick, const Completion& onComplete);
+
+    // Close the slot's socket and report the result
+    void finish(uint32_t slot, bool success, const Completion& onComplete);
+
+    // Wait up to waitMs for socket readiness and complete ready probes
+    void waitForEvents(int waitMs, const Completion& onComplete);
+
+    // Expire every probe whose deadline is at or before nowTick, walking buckets from fromTick
+    void expire(uint64_t fromTick, uint64_t nowTick, const Completion& onComplete);
+
+    uint64_t currentTick(std::chrono::steady_clock::time_point start) const;
+
+public:
+    // Constructor
+    explicit ProbeEngine(size_t maxInFlight = 1024, std::chrono::milliseconds tick = std::chrono::milliseconds(10));
+    ~ProbeEngine();
+
+    // No copy or move (owns the poll descriptor)
+    ProbeEngine(const ProbeEngine&) = delete;
+    ProbeEngine& operator=(const ProbeEngine&) = delete;
+    ProbeEngine(ProbeEngine&&) = delete;
+    ProbeEngine& operator=(ProbeEngine&&) = delete;
+
+    // Probe every target, calling onComplete exactly once per target on the calling thread.
+    // Returns when all probes have connected, failed or timed out.
+    void run(const std::vector<ProbeTarget>& targets, std::chrono::milliseconds timeout, const Completion& onComplete);
+
+    // Configuration
+    void setMaxInFlight(size_t maxInFlight);
+    size_t getMaxInFlight() const;
+};
+
+#endif // PROBE_ENGINE_HPP_
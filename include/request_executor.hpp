@@ -0,0 +1,152 @@
+#ifndef REQUEST_EXECUTOR_HPP_
+#define REQUEST_EXECUTOR_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "server.hpp"
+#include "server_lease.hpp"
+#include "task.hpp"
+
+class LoadBalancer;
+
+// Asynchronous operation against one backend; co_returns true on success.
+// `attempt` numbers the attempts of one execute() from 0, so results can be kept per attempt.
+// The coroutine should not block: Server::acquireConnection(false) takes a pooled socket
+// without blocking, while the default form may block on a connect for the pool's timeout.
+using RequestFunction = std::function<Task<bool>(Server& server, uint32_t attempt)>;
+
+enum class ExecutionStatus {
+    SUCCEEDED,
+    FAILED,         // Every attempt failed, or the attempt or retry budget ran out
+    NO_SERVER       // No server could be leased for the first attempt
+};
+
+// Outcome of one execute()
+struct ExecutionResult {
+    ExecutionStatus                                         status{ExecutionStatus::NO_SERVER};
+    uint32_t                                                attempts{0};                                            // Attempts started, hedges included
+    uint32_t                                                retries{0};                                             // Attempts started after a failure
+    uint32_t                                                hedges{0};                                              // Attempts started after the hedge delay
+    uint32_t                                                winningAttempt{0};                                      // Attempt that succeeded (valid when SUCCEEDED)
+    std::string                                             serverAddress;                                          // Server of the winning, or else the last, attempt
+
+    bool succeeded() const { return status == ExecutionStatus::SUCCEEDED; }
+};
+
+// Retries and hedged requests on top of a balancer's leases.
+// Each attempt leases a server, preferring one this request has not tried yet, runs the
+// request function on it and reports the outcome through the lease, so failures reach the
+// outlier detector and the concurrency limiter. A failed attempt is retried while attempts
+// and retry budget remain. With hedging on, an attempt still outstanding after the hedge
+// delay (a percentile of recent successful latencies) gets a parallel attempt on another
+// server, and the first success wins. Neither waits on a thread: attempts run as coroutines
+// and the hedge delay is a timer that resumes the request.
+//
+// The retry budget is a token bucket shared by retries and hedges: every request deposits
+// `retryRatio` of a token, every extra attempt withdraws one, and minRetries tokens are added
+// each second so retries still work at low traffic. This bounds the extra load a failing
+// backend pool can cause to retryRatio of the request rate plus minRetries per second.
+// Awaiting code resumes on the thread that finished the awaited attempt, or on one of a few
+// shared hedge worker threads when a hedge delay woke the request; hedged attempts start there.
+//
+// Losing hedged attempts run to completion after execute() returns, so the request function
+// must own what it captures, and the balancer must outlive outstanding attempts.
+class RequestExecutor {
+public:
+    // Counters since construction
+    struct Stats {
+        uint64_t                                            requests{0};
+        uint64_t                                            retries{0};
+        uint64_t                                            hedges{0};
+        uint64_t                                            hedgeWins{0};                                           // Requests won by a hedged attempt
+        uint64_t                                            budgetExhausted{0};                                     // Retries or hedges refused by the budget
+    };
+
+    static constexpr size_t kLatencyBuckets = 96;                                                                   // Quarter-octave buckets from 1us to about 16s
+    static constexpr int64_t kTokenScale = 1000;                                                                    // Budget balance unit per token
+    static constexpr int64_t kMaxBudgetTokens = 100;                                                                // Balance cap above minRetries
+    static constexpr uint32_t kLatencyWindow = 1024;                                                                // Latencies kept at full weight
+    static constexpr size_t kUntriedPicks = 4;                                                                      // Picks spent looking for an untried server
+
+private:
+    // Configuration
+    std::atomic<uint32_t>                                   _maxAttempts{3};                                        // Attempts per request, hedges included
+    std::atomic<double>                                     _retryRatio{0.2};                                       // Budget tokens deposited per request
+    std::atomic<uint32_t>                                   _minRetries{10};                                        // Budget tokens added per second, also the starting balance
+    std::atomic<bool>                                       _hedging{false};
+    std::atomic<double>                                     _hedgePercentile{0.95};                                 // Latency percentile that triggers a hedge
+    std::atomic<uint32_t>                                   _maxHedges{1};                                          // Hedged attempts per request
+    std::atomic<uint32_t>                                   _minHedgeSamples{100};                                  // Successes observed before hedging starts
+    std::atomic<std::chrono::microseconds::rep>             _minHedgeDelay{1000};                                   // Floor of the hedge delay (us)
+
+    // State
+    std::atomic<int64_t>                                    _budgetBalance;                                         // Retry tokens * kTokenScale
+    std::atomic<std::chrono::steady_clock::rep>             _budgetRefilledAt;                                      // Last per-second top-up
+    std::array<std::atomic<uint32_t>, kLatencyBuckets>      _latencyBuckets{};                                      // Successful attempt latencies, halved as they fill
+    std::atomic<uint32_t>                                   _latencySamples{0};
+    std::atomic<uint64_t>                                   _requests{0};
+    std::atomic<uint64_t>                                   _retries{0};
+    std::atomic<uint64_t>                                   _hedges{0};
+    std::atomic<uint64_t>                                   _hedgeWins{0};
+    std::atomic<uint64_t>                                   _budgetExhausted{0};
+
+    // Retry budget
+    void depositBudget();
+    bool withdrawBudget();
+
+    // Latency window for the hedge delay
+    void recordLatency(std::chrono::nanoseconds latency);
+    std::chrono::nanoseconds latencyPercentile(double percentile) const;
+
+    // Attempts of one request and the events that wake it
+    struct Race;
+
+    // One attempt on a leased server; reports to the lease and wakes the request
+    static DetachedTask runAttempt(std::shared_ptr<Race> race, ServerLease lease, uint32_t attempt, RequestExecutor* executor);
+
+    // Lease for the next attempt, preferring servers not in `tried`
+    static ServerLease leaseUntried(LoadBalancer& balancer, const std::vector<const Server*>& tried);
+
+public:
+    // Constructor
+    RequestExecutor();
+
+    // Copy the configuration only
+    RequestExecutor(const RequestExecutor& other);
+    RequestExecutor& operator=(const RequestExecutor& other);
+    ~RequestExecutor() = default;
+
+    // Run `fn` against servers of `balancer` with retries and hedging
+    Task<ExecutionResult> execute(LoadBalancer& balancer, RequestFunction fn);
+
+    // Delay after which an outstanding attempt is hedged, zero while hedging is off or
+    // fewer than minHedgeSamples latencies were seen
+    std::chrono::nanoseconds getHedgeDelay() const;
+
+    Stats getStats() const;
+
+    // Configuration
+    void setMaxAttempts(uint32_t attempts);                                                                         // At least 1
+    uint32_t getMaxAttempts() const;
+    void setRetryBudget(double ratio, uint32_t minRetriesPerSecond);                                                // Ratio clamped to [0, 1]
+    double getRetryRatio() const;
+    uint32_t getMinRetries() const;
+    void setHedging(bool enabled);
+    bool isHedging() const;
+    void setHedgePercentile(double percentile);                                                                     // Clamped to [0.5, 0.999]
+    double getHedgePercentile() const;
+    void setMaxHedges(uint32_t hedges);
+    uint32_t getMaxHedges() const;
+    void setMinHedgeSamples(uint32_t samples);
+    uint32_t getMinHedgeSamples() const;
+    void setMinHedgeDelay(std::chrono::microseconds delay);
+    std::chrono::microseconds getMinHedgeDelay() const;
+};
+
+#endif // REQUEST_EXECUTOR_HPP_
@@ -1,6 +1,7 @@
 #ifndef ROUND_ROBIN_LOAD_BALANCER_HPP_
 #define ROUND_ROBIN_LOAD_BALANCER_HPP_
 
+#include <array>
 #include <vector>
 #include <string>
 #include <atomic>
@@ -10,37 +11,182 @@
 #include <random>
 #include <functional>
 #include <shared_mutex>
+#include <unordered_map>
 #include <future>
 #include <optional>
+#include <span>
 #include "server.hpp"
+#include "server_snapshot.hpp"
 #include "ping_server.hpp"
+#include "health_check_scheduler.hpp"
+#include "outlier_detector.hpp"
+#include "concurrency_limiter.hpp"
+#include "request_executor.hpp"
+#include "cluster_state.hpp"
+#include "health_snapshot.hpp"
+#include "slow_start.hpp"
+#include "epoch_domain.hpp"
+#include "selection_engine.hpp"
+#include "weighted_schedule.hpp"
+#include "server_lease.hpp"
+#include "server_table.hpp"
+#include "locality_tiers.hpp"
 
-// Load balancing strategy enum
-enum class LoadBalancingStrategy {
-    ROUND_ROBIN,
-    WEIGHTED_ROUND_ROBIN,
-    LEAST_CONNECTIONS,
-    IP_HASH
+// Outcome of a bulk server list update
+struct ServerListUpdate {
+    size_t                                                  added{0};                                               // New servers (they start a slow start ramp)
+    size_t                                                  removed{0};                                             // Dropped servers (they drain like removeServer())
+    size_t                                                  kept{0};                                                // Existing servers carried over with their state
+
+    bool changed() const { return added != 0 || removed != 0; }
 };
 
 class LoadBalancer {
 protected:
-    std::vector<std::shared_ptr<Server>>                    _serversList;                                           // List of server objects
-    mutable std::shared_mutex                               _serversMutex;                                          // Read-write lock for server list
-    std::unique_ptr<PingServer>                             _pingServer;                                            // Ping server instance
+    using EngineTable = std::array<std::unique_ptr<SelectionEngine>, kLoadBalancingStrategyCount>;
+    using ServerIndex = std::unordered_map<std::string, std::shared_ptr<Server>>;
+
+    static constexpr size_t                                 kAdmissionAttempts = 4;                                 // Lease races lost before a request is rejected
+
+    std::atomic<const ServerSnapshot*>                      _snapshot{nullptr};                                     // Current published server list
+    mutable std::mutex                                      _serversMutex;                                          // Serializes server list and engine writers
+    mutable EngineTable                                     _engines;                                               // Engines created so far, indexed by strategy
+    ServerIndex                                             _serverIndex;                                           // Address to server for the published list (under _serversMutex)
+    OutlierDetector                                         _outlierDetector;                                       // Passive health checking
+    SlowStart                                               _slowStart;                                             // Weight ramp for new or recovered servers
+    ConcurrencyLimiter                                      _concurrencyLimiter;                                    // Per-server outstanding request limits
+    RequestExecutor                                         _requestExecutor;                                       // Retry and hedging policy of execute()
+    BalancerMetrics                                         _metrics;                                               // Pick counters (never copied)
+    std::atomic<bool>                                       _serverPickMetrics{false};                              // Also count picks per server (opt-in)
     
     // Health check configuration
     mutable std::mutex                                      _configMutex;                                           // Mutex for configuration parameters
     uint32_t                                                _healthCheckInterval;                                   // Base interval between health checks (ms)
     uint32_t                                                _maxHealthCheckFailures;                                // Maximum number of health check failures allowed
+    std::shared_ptr<ClusterState>                           _cluster;                                               // Shared health and load, null when standalone
+    std::shared_ptr<PingServer>                             _pingServer;                                            // Prober and DNS cache, may be shared with other instances
+    
+    // Warm start (under _configMutex)
+    std::string                                             _healthSnapshotPath;                                    // Periodic and shutdown saves, empty when off
+    std::chrono::milliseconds                               _healthSnapshotInterval{30000};                         // Time between periodic saves
+    std::vector<std::weak_ptr<Server>>                      _warmStarted;                                           // Restored servers awaiting their first probe
+    std::chrono::steady_clock::time_point                   _warmStartedAt{};                                       // When they were restored
+    std::chrono::steady_clock::time_point                   _warmStartDeadline{};                                   // Unconfirmed ones turn unhealthy after this
+    std::atomic<std::chrono::steady_clock::rep>             _warmStartPending{0};                                   // _warmStartDeadline while servers await a probe, else 0 (read lock-free by picks)
+    
+    // Load balancing strategy (engine used for new snapshots, written under _serversMutex)
+    std::atomic<LoadBalancingStrategy>                      _strategy;
     
-    // Load balancing strategy
-    LoadBalancingStrategy                                   _strategy;
+    // Locality tiers (applied to new snapshots, under _serversMutex)
+    std::string                                             _localZone;                                             // Zone preferred within a priority, empty for none
+    double                                                  _overflowThreshold{0.7};                                // Healthy fraction below which a tier spills over
     
     // Background health check task
     std::atomic<bool>                                       _healthCheckRunning{false};
     std::future<void>                                       _healthCheckTask;
 
+    // Current snapshot; only valid inside an EpochDomain::Guard
+    const ServerSnapshot* loadSnapshot() const;
+
+    // Swap in a new server list built by the current engine and retire the previous one
+    // (caller holds _serversMutex)
+    void publishSnapshot(std::vector<std::shared_ptr<Server>> servers);
+
+    // Publish `servers` (in that order), reusing indexed servers with the same address
+    // (caller holds _serversMutex)
+    ServerListUpdate replaceServersLocked(const std::vector<std::shared_ptr<Server>>& servers);
+
+    // Defer deletion of an unpublished snapshot; servers absent from its replacement
+    // are handed to the ServerDrainList so outstanding leases stay valid
+    static void retireSnapshot(const ServerSnapshot* snapshot, const ServerSnapshot* replacement);
+
+    // Defer deletion of engines that published snapshots may still point to
+    static void retireEngines(EngineTable& engines);
+
+    // Independent copies of the engines in a table (caller holds the owner's _serversMutex)
+    static EngineTable cloneEngines(const EngineTable& engines);
+
+    // Rebuild the current snapshot, e.g. after engine settings changed
+    void refreshSnapshot();
+
+    // Engine for a strategy, created on first use and kept for the balancer's lifetime
+    SelectionEngine& engine(LoadBalancingStrategy strategy) const;
+    SelectionEngine& engineLocked(LoadBalancingStrategy strategy) const;                                            // Caller holds _serversMutex
+
+    // Typed access for the strategy classes' settings
+    template <typename Engine>
+    Engine& engineAs() const
+    {
+        return static_cast<Engine&>(engine(Engine::kStrategy));
+    }
+
+    // Lease on snapshot->servers[index], or an empty lease for npos or a saturated server (call inside the guard)
+    ServerLease makeLease(const ServerSnapshot& snapshot, size_t index);
+
+    // Count a pick in the balancer and server metrics; returns index unchanged
+    size_t recordPick(const ServerSnapshot& snapshot, size_t index);
+
+    // Pick through `select` (an engine call on `snapshot`). Engines pass over servers at their
+    // concurrency limit and return one only when every candidate is saturated, so such a pick
+    // is rejected at once (npos, counted as a rejection).
+    template <typename Select>
+    size_t admitIndex(const ServerSnapshot& snapshot, Select&& select)
+    {
+        size_t index = select();
+        if (index != ServerSnapshot::npos && snapshot.hotStates[index]->isSaturated()) {
+            _metrics.rejectedPicks.add();
+            return ServerSnapshot::npos;
+        }
+        return recordPick(snapshot, index);
+    }
+
+    // Same for leases, whose slot is taken against the limit atomically: a pick that loses the
+    // last slot to another thread picks again, up to kAdmissionAttempts times
+    template <typename Select>
+    ServerLease admitLease(const ServerSnapshot& snapshot, Select&& select)
+    {
+        for (size_t attempt = 0; attempt < kAdmissionAttempts; ++attempt) {
+            size_t index = select();
+            if (index == ServerSnapshot::npos) {
+                recordPick(snapshot, index);
+                return ServerLease();
+            }
+            if (snapshot.hotStates[index]->isSaturated()) {
+                break;
+            }
+            ServerLease lease = makeLease(snapshot, index);
+            if (lease) {
+                recordPick(snapshot, index);
+                return lease;
+            }
+        }
+        _metrics.rejectedPicks.add();
+        return ServerLease();
+    }
+
+    // Snapshot a pick selects from: the chosen tier's, or the whole list without tiers or
+    // when no tier has an available server (call inside the guard, after snapshot.sync()).
+    // Also returns servers whose outlier ejection ended. Key-based picks choose the tier from
+    // the key hash, so a key keeps its tier as long as the shares do not change.
+    const ServerSnapshot& pickTarget(const ServerSnapshot& snapshot);
+    const ServerSnapshot& pickTarget(const ServerSnapshot& snapshot, uint64_t keyHash);
+    
+    // Lazy expiry of outlier ejections and restored health; costs two loads while neither is pending
+    void expireOnPick(const ServerSnapshot& snapshot);
+
+    // Copy of the current server list
+    std::vector<std::shared_ptr<Server>> copyServers() const;
+
+    // Mark restored servers that no probe confirmed within the validation window unhealthy
+    void expireWarmStart(std::chrono::steady_clock::time_point now);
+    
+    // Same from the pick path, so restored health also ends without the health check loop:
+    // checks the clock every few hundred picks per thread while a window is open
+    void expireWarmStartLazily();
+    
+    // Servers this instance probes itself (all of them without a cluster)
+    static std::vector<std::shared_ptr<Server>> ownedServers(const std::vector<std::shared_ptr<Server>>& servers, const ClusterState* cluster);
+
 public:
     // Constructor
     explicit LoadBalancer(
@@ -60,21 +206,89 @@ public:
     virtual ~LoadBalancer();
     
     // Core functionality
-    virtual std::shared_ptr<Server> getNextServer() = 0;                                                            // Pure virtual method
+    virtual std::shared_ptr<Server> getNextServer();                                                                // Pick a server (shared ownership)
+    ServerLease acquireNextServer();                                                                                // Pick a server and hold a connection slot on it
+    size_t getNextServers(std::span<std::shared_ptr<Server>> out);                                                  // Fill `out` with picks, returns count written
+    size_t acquireNextServers(std::span<ServerLease> out);                                                          // Batch of leases, returns count written
     bool performHealthCheck();                                                                                      // Perform health check on all servers
     
+    // Passive health checking
+    bool reportOutcome(Server& server, bool success, std::chrono::nanoseconds latency);                             // Request result from the data path, true if it ejected the server
+    OutlierDetector& getOutlierDetector();
+    SlowStart& getSlowStart();                                                                                      // Ramp applied by the weighted and least-load engines
+    
+    // Admission control: pickers skip servers at their concurrency limit (Server::setConcurrencyLimit(),
+    // or adaptive limits from the limiter) and reject the request only when every candidate server
+    // is saturated. Rejections return an empty result like an empty pool and count as rejectedPicks.
+    ConcurrencyLimiter& getConcurrencyLimiter();
+    
+    // Asynchronous execution: co_await execute(fn) runs fn on a leased server, retrying failures
+    // on other servers and hedging slow attempts per the executor's policy; outcomes feed passive
+    // health and the concurrency limits. The balancer must outlive the attempts it started.
+    Task<ExecutionResult> execute(RequestFunction fn);
+    RequestExecutor& getRequestExecutor();
+    
     // Server management
     bool addServer(std::shared_ptr<Server> server);                                                                 // Add a new server
     bool removeServer(const std::string& serverAddress);                                                            // Remove a server
-    std::vector<std::shared_ptr<Server>> getServers() const;                                                        // Get all servers
+    std::vector<std::shared_ptr<Server>> getServers() const;                                                        // Get all servers (a copy of the list)
+    
+    // Call fn(Server&) for each server in the published list, without copying it; fn runs
+    // inside the read-side section, so it should not block
+    template <typename Fn>
+    void forEachServer(Fn&& fn) const
+    {
+        EpochDomain::Guard guard;
+        const ServerSnapshot* snapshot = loadSnapshot();
+        if (snapshot) {
+            for (const auto& server : snapshot->servers) {
+                fn(*server);
+            }
+        }
+    }
+    
+    // Bulk updates (e.g. service discovery): the delta is computed against an address index,
+    // servers already present keep their state and connections and take the new weight, and
+    // the result is published in one snapshot swap. Nothing is published when nothing changed.
+    ServerListUpdate replaceServers(const std::vector<std::shared_ptr<Server>>& servers);                            // Make the list exactly `servers`
+    ServerListUpdate replaceServers(const std::vector<std::string>& serverAddresses);                               // Same, creating servers for new addresses in the ServerTable
+    ServerListUpdate applyDiff(
+        const std::vector<std::shared_ptr<Server>>& added,
+        const std::vector<std::string>& removedAddresses
+    );                                                                                                              // Removals first, then appended additions
     
     // Configuration
     void setHealthCheckInterval(uint32_t milliseconds);
     uint32_t getHealthCheckInterval() const;
     void setMaxHealthCheckFailures(uint32_t failures);
     uint32_t getMaxHealthCheckFailures() const;
-    void setStrategy(LoadBalancingStrategy strategy);
+    void setStrategy(LoadBalancingStrategy strategy);                                                               // Live switch; picks in flight finish on the old engine
     LoadBalancingStrategy getStrategy() const;
+    void setClusterState(std::shared_ptr<ClusterState> cluster);                                                    // Share health and load with other instances (null to leave)
+    std::shared_ptr<ClusterState> getClusterState() const;
+    void setPingServer(std::shared_ptr<PingServer> pingServer);                                                     // Prober used by health checks, e.g. one for a cluster (null stops probing)
+    std::shared_ptr<PingServer> getPingServer() const;
+    
+    // Locality: servers are grouped into tiers by (priority, local zone first). The first
+    // tier takes all picks while at least `threshold` of its servers are available and
+    // overflows to the next tiers in proportion as it degrades. Changes republish the list.
+    void setLocalZone(const std::string& zone);
+    std::string getLocalZone() const;
+    void setOverflowThreshold(double threshold);                                                                    // Clamped to [0.01, 1]
+    double getOverflowThreshold() const;
+    std::vector<TierStats> getTierStats() const;                                                                    // Empty when all servers share one tier
+    
+    // Warm start: last-known health, weights, latency averages and endpoints on disk.
+    // Restored health is provisional: servers neither probed nor given health by the cluster
+    // owner by the end of the validation window (default: twice the health check interval)
+    // turn unhealthy, with or without the health check loop running.
+    bool saveHealthSnapshot(const std::string& path) const;
+    size_t loadHealthSnapshot(
+        const std::string& path,
+        std::chrono::milliseconds validationWindow = std::chrono::milliseconds(0),
+        std::chrono::seconds maxAge = std::chrono::minutes(10)
+    );                                                                                                              // Returns the number of servers restored
+    void setHealthSnapshotPath(const std::string& path, std::chrono::milliseconds interval = std::chrono::seconds(30)); // Saved by the health check loop and when it stops (empty to disable)
     
     // Health check control
     void startHealthChecks();
@@ -85,21 +299,130 @@ public:
     size_t getServerCount() const;
     size_t getHealthyServerCount() const;
     double getAverageLoad() const;
+    const BalancerMetrics& getMetrics() const;
+    
+    // Per-server pick counts (lb_server_picks_total) cost each pick a write to the picked
+    // server's cold block, so they are off unless enabled; the balancer-wide counters are always kept
+    void setServerPickMetrics(bool enabled);
+    bool getServerPickMetrics() const;
+    std::string exportMetrics() const;                                                                              // Balancer, server and DNS metrics in Prometheus text format
 };
 
 
 
-// Concrete implementation for Round Robin
-class RoundRobinLoadBalancer : public LoadBalancer {
+// How round robin threads obtain their position in the rotation
+enum class CursorMode {
+    SHARED,         // One atomic cursor advanced by every pick
+    PER_THREAD,     // Each thread walks its own cache-line-padded cursor from a staggered offset
+    BATCHED         // Threads reserve ranges of the shared cursor and consume them locally
+};
+
+// Round robin engine: a cursor over the snapshot, skipping unavailable servers
+class RoundRobinEngine : public SelectionEngine {
 private:
-    std::atomic<size_t>                                     _currentServerIndex{0};                             // Index of the current server
+    // Cursor state owned by one thread (indexed by EpochDomain::currentThreadIndex())
+    struct alignas(64) ThreadCursor {
+        std::atomic<uint64_t>                               next{0};                                            // Next ticket for this thread
+        std::atomic<uint64_t>                               end{0};                                             // End of the reserved range (BATCHED)
+    };
+
+    static constexpr uint64_t                               kCursorBatchSize = 64;                              // Tickets reserved per fetch_add in BATCHED mode
+
+    std::atomic<uint64_t>                                   _currentServerIndex{0};                             // Shared ticket cursor
+    std::atomic<CursorMode>                                 _cursorMode{CursorMode::SHARED};
+    std::atomic<ThreadCursor*>                              _threadCursors{nullptr};                            // Allocated on first use of a per-thread mode
+
+    // Allocate the per-thread cursors once (safe against concurrent pickers)
+    void ensureThreadCursors();
+
+    // First of `count` consecutive tickets for the calling thread according to the cursor mode
+    uint64_t nextTicket(uint64_t count = 1);
+
+public:
+    static constexpr LoadBalancingStrategy                  kStrategy = LoadBalancingStrategy::ROUND_ROBIN;
+
+    // Constructor
+    RoundRobinEngine() = default;
+
+    // No copy or move (snapshots point to the engine); see clone()
+    RoundRobinEngine(const RoundRobinEngine&) = delete;
+    RoundRobinEngine& operator=(const RoundRobinEngine&) = delete;
+    ~RoundRobinEngine() override;
+
+    LoadBalancingStrategy strategy() const override;
+    std::unique_ptr<SelectionEngine> clone() const override;
+
+    // Round robin over the snapshot, skipping unavailable servers
+    size_t selectIndex(const ServerSnapshot& snapshot, const SlowStart& slowStart) override;
+
+    // One walk from a single cursor advance of out.size()
+    size_t selectIndices(const ServerSnapshot& snapshot, const SlowStart& slowStart, std::span<size_t> out) override;
+
+    // Move the shared cursor on without picking
+    void advance(uint64_t count = 1);
+
+    // Cursor mode (opt-in per-thread cursors for many picker threads)
+    void setCursorMode(CursorMode mode);
+    CursorMode getCursorMode() const;
+};
+
+// Weighted round robin engine: tickets into a weighted schedule attached to each snapshot
+class WeightedRoundRobinEngine : public SelectionEngine {
+private:
+    // Snapshot carrying the weighted schedule built for its server list. The schedule follows
+    // weight and health changes of these servers in place as the snapshot syncs.
+    struct WeightedSnapshot : ServerSnapshot {
+        mutable WeightedSchedule                            schedule;                                           // Fenwick-backed weighted ticket schedule
+
+        explicit WeightedSnapshot(std::vector<std::shared_ptr<Server>> serverList);
+
+    protected:
+        void onStateChanged(size_t index) const override;
+    };
+
+    std::atomic<uint64_t>                                   _currentServerIndex{0};                             // Ticket counter into the schedule
+
+    // Weight a server holds in the schedule: its weight while available, zero otherwise
+    static uint32_t scheduledWeight(const ServerHotState& state);
+    static std::vector<uint32_t> scheduledWeights(const std::vector<const ServerHotState*>& states);
+
+    // Index for one ticket, skipping unavailable servers and thinning out ramping ones in
+    // proportion to the other servers' weights (the pool ramping together keeps its weights)
+    static size_t selectForTicket(const WeightedSnapshot& snapshot, const SlowStart& slowStart, uint64_t ticket);
 
+public:
+    static constexpr LoadBalancingStrategy                  kStrategy = LoadBalancingStrategy::WEIGHTED_ROUND_ROBIN;
+
+    // Constructor
+    WeightedRoundRobinEngine() = default;
+
+    // No copy or move (snapshots point to the engine); see clone()
+    WeightedRoundRobinEngine(const WeightedRoundRobinEngine&) = delete;
+    WeightedRoundRobinEngine& operator=(const WeightedRoundRobinEngine&) = delete;
+    ~WeightedRoundRobinEngine() override = default;
+
+    LoadBalancingStrategy strategy() const override;
+    std::unique_ptr<SelectionEngine> clone() const override;
+
+    // Build a snapshot with the weighted schedule for its servers
+    ServerSnapshot* buildSnapshot(std::vector<std::shared_ptr<Server>> servers) const override;
+
+    // Follow the weighted schedule, skipping unavailable servers
+    size_t selectIndex(const ServerSnapshot& snapshot, const SlowStart& slowStart) override;
+
+    // Consecutive tickets from a single counter advance of out.size()
+    size_t selectIndices(const ServerSnapshot& snapshot, const SlowStart& slowStart, std::span<size_t> out) override;
+};
+
+// Concrete implementation for Round Robin
+class RoundRobinLoadBalancer : public LoadBalancer {
 public:
     // Constructor with default values
     explicit RoundRobinLoadBalancer(
         const std::vector<std::shared_ptr<Server>>& servers,
         uint32_t healthCheckInterval = 5000,
-        uint32_t maxHealthCheckFailures = 3
+        uint32_t maxHealthCheckFailures = 3,
+        CursorMode cursorMode = CursorMode::SHARED
     );
     
     // Rule of five
@@ -109,23 +432,16 @@ public:
     RoundRobinLoadBalancer& operator=(RoundRobinLoadBalancer&& other) noexcept;
     ~RoundRobinLoadBalancer() override;
     
-    // Implementation of the virtual method
-    std::shared_ptr<Server> getNextServer() override;
-    
     // Helper method for updating current server index
     void updateCurrentServer();
+
+    // Cursor mode (opt-in per-thread cursors for many picker threads)
+    void setCursorMode(CursorMode mode);
+    CursorMode getCursorMode() const;
 };
 
 // Weighted Round Robin Load Balancer
 class WeightedRoundRobinLoadBalancer : public LoadBalancer {
-private:
-    std::atomic<size_t>                                     _currentServerIndex{0};
-    std::vector<std::shared_ptr<Server>>                    _weightedServersList;                               // List with duplicates based on weight
-    mutable std::mutex                                      _weightedListMutex;                                 // Mutex for weighted list
-    
-    // Update the weighted servers list
-    void updateWeightedList();
-
 public:
     // Constructor
     explicit WeightedRoundRobinLoadBalancer(
@@ -140,9 +456,6 @@ public:
     WeightedRoundRobinLoadBalancer& operator=(const WeightedRoundRobinLoadBalancer& other);
     WeightedRoundRobinLoadBalancer& operator=(WeightedRoundRobinLoadBalancer&& other) noexcept;
     ~WeightedRoundRobinLoadBalancer() override;
-    
-    // Implementation of the virtual method
-    std::shared_ptr<Server> getNextServer() override;
 };
 
 #endif // ROUND_ROBIN_LOAD_BALANCER_HPP_
\ No newline at end of file
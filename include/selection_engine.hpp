@@ -0,0 +1,56 @@
+#ifndef SELECTION_ENGINE_HPP_
+#define SELECTION_ENGINE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "server.hpp"
+#include "server_snapshot.hpp"
+#include "slow_start.hpp"
+
+// Load balancing strategy enum
+enum class LoadBalancingStrategy {
+    ROUND_ROBIN,
+    WEIGHTED_ROUND_ROBIN,
+    LEAST_CONNECTIONS,
+    IP_HASH,
+    PEAK_EWMA
+};
+
+constexpr size_t kLoadBalancingStrategyCount = 5;                                                                   // Number of LoadBalancingStrategy values
+
+// Selection algorithm behind a LoadBalancer.
+// An engine builds the snapshots it picks from (attaching any precomputed selection state)
+// and is stored in each snapshot it built, so publishing a snapshot switches the server list
+// and the algorithm in one atomic swap. Engines hold only their own cursors and settings;
+// connection counts, health and latency stay with the servers, so switching loses nothing.
+// The select calls run inside an EpochDomain::Guard, concurrently from many threads.
+class SelectionEngine {
+public:
+    virtual ~SelectionEngine() = default;
+
+    // Engine with default settings for a strategy
+    static std::unique_ptr<SelectionEngine> create(LoadBalancingStrategy strategy);
+
+    virtual LoadBalancingStrategy strategy() const = 0;
+
+    // Copy of the settings and cursors, for copying balancers
+    virtual std::unique_ptr<SelectionEngine> clone() const = 0;
+
+    // Snapshot factory; the default carries no extra selection state
+    virtual ServerSnapshot* buildSnapshot(std::vector<std::shared_ptr<Server>> servers) const;
+
+    // Index of the chosen server in a non-empty snapshot built by this engine, or ServerSnapshot::npos
+    virtual size_t selectIndex(const ServerSnapshot& snapshot, const SlowStart& slowStart) = 0;
+
+    // Fill `out` with picks from one snapshot and return how many were written (a prefix
+    // of `out`). The default calls selectIndex() per element.
+    virtual size_t selectIndices(const ServerSnapshot& snapshot, const SlowStart& slowStart, std::span<size_t> out);
+
+    // Pick for an affinity key hash; engines without affinity ignore the key
+    virtual size_t selectForKey(const ServerSnapshot& snapshot, const SlowStart& slowStart, uint64_t keyHash);
+};
+
+#endif // SELECTION_ENGINE_HPP_
@@ -6,29 +6,49 @@
 #include <mutex>
 #include <atomic>
 #include <memory>
+#include "server_hot_state.hpp"
+#include "server_endpoint.hpp"
+#include "connection_pool.hpp"
+#include "server_outcome_stats.hpp"
+#include "metrics.hpp"
 
 class Server {
 private:
+    // Hot state (pick path): alive/healthy bits, weight, connections on a pooled cache line
+    ServerHotState*                                         _hot;                                   // Owned block from ServerHotStatePool
+
+    // Cold state (health checker / management)
     std::string                                             _serverAddress;                         // Address of the server    
-    std::atomic<bool>                                       _isAlive{true};                         // Atomic bool for thread safety
-    std::atomic<bool>                                       _isHealthy{false};                      // Health status
-    std::chrono::time_point<std::chrono::steady_clock>      _lastHealthCheck;                       // Last health check timestamp
-    mutable std::mutex                                      _timeMutex;                             // Mutex for timestamp access
-    std::atomic<uint32_t>                                   _weight{1};                             // Server weight for weighted algorithms
-    std::atomic<uint32_t>                                   _currentConnections{0};                 // Current connection count
+    std::string                                             _host;                                  // Host part of the address
+    uint16_t                                                _port{0};                               // Port part of the address
+    bool                                                    _addressValid{false};                   // Address parsed successfully
+    std::atomic<const ServerEndpoint*>                      _endpoint{nullptr};                     // Resolved address, epoch-reclaimed on change
+    std::atomic<std::chrono::steady_clock::rep>             _lastHealthCheck;                       // Last health check timestamp (steady_clock ticks)
     std::atomic<uint32_t>                                   _failureCount{0};                       // Consecutive failures
+    ServerOutcomeStats                                      _outcomes;                              // Passive health counters from the data path
+    ServerMetrics                                           _metrics;                               // Pick and probe counters for export
+    std::atomic<ConnectionPool*>                            _connectionPool{nullptr};               // Keepalive sockets, null until enabled
+    std::string                                             _zone;                                  // Locality zone, empty when unknown
+    mutable std::mutex                                      _zoneMutex;                             // Guards _zone
+    std::atomic<uint32_t>                                   _priority{0};                           // Locality priority, lower is preferred
+    uint32_t                                                _tableSlot{UINT32_MAX};                 // ServerTable slot, UINT32_MAX when allocated elsewhere
+
+    // Parse the address once; literal IPs get their endpoint right away
+    void parseAddress();
 
+    // Publish an endpoint copy (or none) and retire the previous one
+    void replaceEndpoint(const ServerEndpoint* endpoint);
 
 public:
 // Constructors with explicit keyword to prevent implicit conversions
 explicit Server(const std::string& serverAddress, uint32_t weight = 1);
 explicit Server(std::string&& serverAddress, uint32_t weight = 1);
 
-// Rule of five
+// Rule of five; moves take a fresh hot state block and copy the endpoint, so they can throw
 Server(const Server& other);
-Server(Server&& other) noexcept;
+Server(Server&& other);
 Server& operator=(const Server& other);
-Server& operator=(Server&& other) noexcept;
+Server& operator=(Server&& other);
 virtual ~Server();
 
 // Getters
@@ -41,14 +61,18 @@ uint32_t getCurrentConnections() const;
 uint32_t getFailureCount() const;
 
     // Setters
-    void setHealthy(bool isHealthy);
+    void setHealthy(bool isHealthy);                                    // Becoming healthy starts a slow start ramp
     void updateLastHealthCheck();
     void setWeight(uint32_t weight);
     void setAlive(bool isAlive);
     
-    // Connection management
+    // Connection management (local connections are counted by ServerLease). The manual calls
+    // share that count but bypass the concurrency limit; a decrement stops at zero.
     void incrementConnections();
     void decrementConnections();
+    void setRemoteConnections(uint32_t connections);                    // Other balancer instances' count (ClusterState)
+    void setConcurrencyLimit(uint32_t limit);                           // Max outstanding leases, 0 for no limit
+    uint32_t getConcurrencyLimit() const;
     
     // Failure management
     void incrementFailures();
@@ -57,7 +81,48 @@ uint32_t getFailureCount() const;
     // Calculate effective load (for least connections algorithm)
     double getEffectiveLoad() const;
     
-    friend class RoundRobinLoadBalancer;
+    // Hot state block scanned by the selection path
+    const ServerHotState& hotState() const;
+    
+    // Pre-parsed address
+    const std::string& getHost() const;
+    uint16_t getPort() const;
+    bool hasValidAddress() const;
+    
+    // Copy the resolved endpoint, false until one is known
+    bool getEndpoint(ServerEndpoint& endpoint) const;
+    
+    // Store a freshly resolved endpoint (health checker, on DNS change)
+    void setEndpoint(const ServerEndpoint& endpoint);
+    
+    // Restart the slow start ramp (on add, and on every unhealthy to healthy transition)
+    void beginSlowStart();
+    
+    // Locality; read when the balancer publishes its server list, so republish to regroup
+    void setZone(const std::string& zone);
+    std::string getZone() const;
+    void setPriority(uint32_t priority);
+    uint32_t getPriority() const;
+    
+    // Keepalive connections; the pool lives as long as the server and is never copied
+    ConnectionPool& enableConnectionPool();                             // Create the pool on first call
+    ConnectionPool* getConnectionPool() const;                          // Null until enabled
+    PooledConnection acquireConnection(bool mayConnect = true);         // Socket to the current endpoint, empty without pool or endpoint;
+                                                                        // without mayConnect only an idle one, so it never blocks
+    
+    // Passive health
+    const ServerOutcomeStats& getOutcomeStats() const;
+    void restoreLatency(uint64_t ewmaNanos, double peakMicros);         // Warm start, ignored once samples arrived
+    bool isEjected() const;                                             // Taken out by the outlier detector
+    
+    // Monitoring counters (picks, probes)
+    ServerMetrics& getMetrics();
+    const ServerMetrics& getMetrics() const;
+    
+    friend class ServerLease;
+    friend class OutlierDetector;
+    friend class ConcurrencyLimiter;
+    friend class ServerTable;
 };
 
 #endif // SERVER_HPP_
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef SERVER_BITMAP_HPP_
+#define SERVER_BITMAP_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Fixed-size bitmap over server indices, one bit per server, readable while it is updated.
+// findNext() skips 64 clear bits per step with std::countr_zero, so a pick does not slow
+// down with the number of unavailable servers in front of the next eligible one.
+class ServerBitmap {
+private:
+    size_t                                                  _size{0};                                               // Number of bits
+    size_t                                                  _wordCount{0};
+    std::unique_ptr<std::atomic<uint64_t>[]>                _words;
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Constructor (all bits clear)
+    explicit ServerBitmap(size_t size = 0);
+
+    // No copy or move (readers hold references into the words)
+    ServerBitmap(const ServerBitmap&) = delete;
+    ServerBitmap& operator=(const ServerBitmap&) = delete;
+
+    void set(size_t index, bool value);
+    bool test(size_t index) const;
+
+    // First set bit at or after `from`, wrapping around to the start; npos when none is set
+    size_t findNext(size_t from) const;
+
+    // Index of the set bit with `rank` set bits before it (select), npos when there are
+    // no more than `rank`; counts a word at a time with std::popcount
+    size_t findNth(size_t rank) const;
+
+    // Number of set bits
+    size_t count() const;
+    size_t size() const;
+};
+
+#endif // SERVER_BITMAP_HPP_
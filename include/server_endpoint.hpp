@@ -0,0 +1,34 @@
+#ifndef SERVER_ENDPOINT_HPP_
+#define SERVER_ENDPOINT_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <sys/socket.h>
+#endif
+
+// Binary socket address of a backend, ready to pass to connect()
+struct ServerEndpoint {
+    sockaddr_storage                                        address{};                                              // IPv4 or IPv6 address including the port
+    socklen_t                                               length{0};                                              // Valid bytes in address
+    std::chrono::steady_clock::time_point                   refreshAt{};                                            // Re-resolve after this (max for literal IPs)
+
+    // Split "host[:port]" into its parts (port 80 when omitted)
+    static bool parseAddress(const std::string& serverAddress, std::string& host, uint16_t& port);
+
+    // Endpoint for a literal IPv4/IPv6 host, false if the host is a name
+    static bool fromLiteral(const std::string& host, uint16_t port, ServerEndpoint& endpoint);
+
+    // Set the port on an IPv4 or IPv6 address
+    void setPort(uint16_t port);
+
+    // Same address and port
+    bool sameAddress(const ServerEndpoint& other) const;
+};
+
+#endif // SERVER_ENDPOINT_HPP_
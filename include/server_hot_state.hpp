@@ -0,0 +1,168 @@
+#ifndef SERVER_HOT_STATE_HPP_
+#define SERVER_HOT_STATE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Per-server state read on every pick, isolated on its own cache line so that
+// health checker writes to the cold part of Server never invalidate it.
+struct alignas(64) ServerHotState {
+    static constexpr uint32_t kAlive = 1u << 0;
+    static constexpr uint32_t kHealthy = 1u << 1;
+    static constexpr uint32_t kAvailable = kAlive | kHealthy;
+
+    std::atomic<uint32_t>                                   flags{kAlive};                                          // kAlive | kHealthy bits
+    std::atomic<uint32_t>                                   weight{1};                                              // Server weight for weighted algorithms
+    std::atomic<uint32_t>                                   currentConnections{0};                                  // Current connection count
+    std::atomic<uint32_t>                                   remoteConnections{0};                                   // Connections other balancer instances hold (ClusterState)
+    std::atomic<uint32_t>                                   concurrencyLimit{0};                                    // Outstanding leases allowed, 0 for no limit
+    mutable std::atomic<int64_t>                            rampStart{0};                                           // Slow start begin (steady_clock ticks), 0 when not ramping
+    std::atomic<uint64_t>                                   peakEwma{0};                                            // Peak-EWMA latency: float microseconds << 32 | sample time (ms)
+    uint32_t                                                poolArena{0};                                           // ServerHotStatePool arena owning the block, set once
+
+    static constexpr std::chrono::milliseconds              kPeakEwmaDecay{10000};                                  // Time constant of the peak-EWMA decay
+
+    bool isAlive() const { return (flags.load(std::memory_order_relaxed) & kAlive) != 0; }
+    bool isHealthy() const { return (flags.load(std::memory_order_relaxed) & kHealthy) != 0; }
+    bool isAvailable() const { return (flags.load(std::memory_order_relaxed) & kAvailable) == kAvailable; }
+
+    // At its concurrency limit: new leases are refused until one is released
+    bool isSaturated() const
+    {
+        uint32_t limit = concurrencyLimit.load(std::memory_order_relaxed);
+        return limit != 0 && currentConnections.load(std::memory_order_relaxed) >= limit;
+    }
+
+    // Connections across the cluster: this instance's plus the last reported remote ones
+    uint32_t totalConnections() const { return currentConnections.load(std::memory_order_relaxed) + remoteConnections.load(std::memory_order_relaxed); }
+
+    // Set or clear a flag, skipping the write (and the cache line invalidation) when unchanged.
+    // Returns true if the flag changed.
+    bool setFlag(uint32_t flag, bool value);
+
+    // Take a connection slot unless that would exceed the concurrency limit
+    bool tryAcquireConnection();
+
+    // Store a new weight; returns true if it changed
+    bool setWeight(uint32_t value);
+
+    // Tell schedules built over this state that its weight or flags changed
+    void noteChange() const;
+
+    // Connections per unit of weight
+    double effectiveLoad() const;
+
+    // Fold one request latency into the peak-EWMA. Slower samples replace the average at once;
+    // faster ones pull it down over kPeakEwmaDecay.
+    void recordPeakLatency(std::chrono::nanoseconds latency, std::chrono::steady_clock::time_point now);
+
+    // Peak-EWMA latency in microseconds decayed to `now`, 0 before the first sample
+    double peakLatencyMicros(std::chrono::steady_clock::time_point now) const;
+
+    // Seed the peak-EWMA from a persisted value (warm start) unless it already has samples
+    void seedPeakLatency(double micros, std::chrono::steady_clock::time_point now);
+};
+
+// Process-wide ring of recent ServerHotState changes (weight or flag writes).
+// Schedules remember the last sequence number they applied and replay only the entries
+// after it, so one change costs them one lookup instead of a scan over every server.
+// A reader that falls more than kCapacity entries behind is told to resynchronize fully.
+class HotStateChangeLog {
+private:
+    static constexpr size_t                                 kCapacity = 1024;                                       // Power of two
+
+    struct Slot {
+        std::atomic<uint64_t>                               sequence{0};                                            // Sequence number + 1 once written
+        std::atomic<const ServerHotState*>                  state{nullptr};
+    };
+
+    std::atomic<uint64_t>                                   _head{0};                                               // Next sequence number to hand out
+    Slot                                                    _slots[kCapacity];
+
+    HotStateChangeLog() = default;
+
+public:
+    // Outcome of replaying the log
+    enum class ReplayResult {
+        CAUGHT_UP,      // Every entry up to the head was delivered
+        PENDING,        // A writer has not finished its entry yet; retry from the returned position
+        OVERRUN         // Entries were overwritten before they were read
+    };
+
+    static HotStateChangeLog& instance();
+
+    void record(const ServerHotState* state);
+
+    // Sequence number the next change will receive
+    uint64_t head() const;
+
+    // Deliver entries from `from` on to `visit`; `from` is advanced past every delivered entry
+    template <typename Visitor>
+    ReplayResult replay(uint64_t& from, Visitor&& visit) const
+    {
+        uint64_t end = _head.load(std::memory_order_acquire);
+        if (end - from > kCapacity) {
+            return ReplayResult::OVERRUN;
+        }
+
+        for (; from != end; ++from) {
+            const Slot& slot = _slots[from & (kCapacity - 1)];
+            uint64_t written = slot.sequence.load(std::memory_order_acquire);
+            if (written < from + 1) {
+                return ReplayResult::PENDING;
+            }
+
+            const ServerHotState* state = slot.state.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (written != from + 1 || slot.sequence.load(std::memory_order_relaxed) != from + 1) {
+                return ReplayResult::OVERRUN;
+            }
+            visit(state);
+        }
+        return ReplayResult::CAUGHT_UP;
+    }
+
+    HotStateChangeLog(const HotStateChangeLog&) = delete;
+    HotStateChangeLog& operator=(const HotStateChangeLog&) = delete;
+};
+
+// Slab allocator handing out ServerHotState blocks from contiguous chunks, so the
+// states of servers created together sit next to each other for the picker to scan.
+// Each NUMA node has its own arena, picked by the node the constructing thread runs on,
+// so servers built by a thread bound to a node get hot state in that node's memory.
+// A block records its arena, so releasing it locks only that arena.
+class ServerHotStatePool {
+private:
+    static constexpr size_t                                 kBlocksPerChunk = 64;                                   // 4 KiB chunks
+    static constexpr size_t                                 kMaxArenas = 8;                                         // Nodes beyond share arenas
+
+    struct Chunk {
+        ServerHotState                                      blocks[kBlocksPerChunk];
+    };
+
+    struct Arena {
+        std::mutex                                          mutex;                                                  // Allocation happens only on Server construction
+        std::vector<Chunk*>                                 chunks;                                                 // Chunks are never returned to the heap
+        std::vector<ServerHotState*>                        freeList;                                               // Released blocks, reused LIFO
+        size_t                                              nextInChunk{kBlocksPerChunk};                           // Bump index into the newest chunk
+    };
+
+    Arena                                                   _arenas[kMaxArenas];
+
+    ServerHotStatePool() = default;
+
+public:
+    static ServerHotStatePool& instance();
+
+    ServerHotState* acquire();
+    void release(ServerHotState* state);
+
+    ServerHotStatePool(const ServerHotStatePool&) = delete;
+    ServerHotStatePool& operator=(const ServerHotStatePool&) = delete;
+};
+
+#endif // SERVER_HOT_STATE_HPP_
@@ -0,0 +1,104 @@
+#ifndef SERVER_LEASE_HPP_
+#define SERVER_LEASE_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "server.hpp"
+
+class OutlierDetector;
+class ConcurrencyLimiter;
+
+template <typename Policy, typename HealthPolicy, size_t MaxServers>
+class BasicBalancer;
+
+// Move-only handle to a picked server that holds one connection slot on it.
+// The connection count is incremented when the lease is issued and decremented when
+// it is released or destroyed. The lease stores a raw pointer and the index the server
+// had in the snapshot it was picked from, so it costs no shared_ptr refcount traffic.
+// Servers removed from a balancer stay alive until their outstanding leases drain.
+// Finishing a request with complete() feeds the balancer's passive health checking and
+// adaptive concurrency limits. A server at its concurrency limit issues no lease.
+// With pooling enabled on the server, connection() hands out a keepalive socket that
+// returns to the pool with the slot, so the count also tracks pooled sockets in use.
+// The lease reports outcomes to the issuing balancer's detector and limiter through raw
+// pointers, so it must be released or completed before that balancer is destroyed.
+class ServerLease {
+private:
+    Server*                                                 _server{nullptr};                                       // Leased server, null when empty
+    size_t                                                  _index{0};                                              // Position in the snapshot it was picked from
+    OutlierDetector*                                        _detector{nullptr};                                     // Receives the outcome passed to complete()
+    ConcurrencyLimiter*                                     _limiter{nullptr};                                      // Adapts the server's limit to the outcome
+    std::chrono::steady_clock::time_point                   _issuedAt{};                                            // Start of the request, for latency
+    PooledConnection                                        _connection;                                            // Taken from the server's pool on first use
+
+    friend class LoadBalancer;
+
+    template <typename Policy, typename HealthPolicy, size_t MaxServers>
+    friend class BasicBalancer;
+
+    // Issued by the balancer inside a read-side section; takes the connection slot, or
+    // stays empty when the server is at its concurrency limit
+    ServerLease(Server* server, size_t index, OutlierDetector* detector, ConcurrencyLimiter* limiter = nullptr) noexcept;
+
+public:
+    ServerLease() noexcept = default;
+    ~ServerLease();
+
+    // Move-only
+    ServerLease(const ServerLease&) = delete;
+    ServerLease& operator=(const ServerLease&) = delete;
+    ServerLease(ServerLease&& other) noexcept;
+    ServerLease& operator=(ServerLease&& other) noexcept;
+
+    // Access
+    Server* get() const noexcept;
+    Server& operator*() const noexcept;
+    Server* operator->() const noexcept;
+    explicit operator bool() const noexcept;
+    size_t index() const noexcept;
+
+    // Pooled socket to the server (empty without pooling or on connect failure). Without an
+    // idle socket this connects on the calling thread, blocking it for up to the pool's connect
+    // timeout; with mayConnect false only an idle socket is taken, so coroutines and other
+    // callers that must not block can fall back to connecting asynchronously themselves.
+    PooledConnection& connection(bool mayConnect = true);
+
+    // Give the connection slot (and pooled socket) back early
+    void release() noexcept;
+
+    // Report the request outcome and latency since the lease was issued, then release;
+    // a failed request closes its pooled socket instead of returning it
+    void complete(bool success);
+};
+
+// Keeps servers that left every snapshot alive while they still have leases out
+class ServerDrainList {
+private:
+    std::mutex                                              _mutex;
+    std::vector<std::shared_ptr<Server>>                    _draining;                                              // Removed servers with open connections
+
+    ServerDrainList() = default;
+
+    // Drop servers whose connections have drained (caller holds _mutex)
+    void pruneLocked();
+
+public:
+    static ServerDrainList& instance();
+
+    // Hold a removed server until its connection count reaches zero.
+    // Must only be called once no snapshot can hand the server out anymore.
+    void add(std::shared_ptr<Server> server);
+
+    // Release drained servers now
+    void collect();
+
+    size_t size();
+
+    ServerDrainList(const ServerDrainList&) = delete;
+    ServerDrainList& operator=(const ServerDrainList&) = delete;
+};
+
+#endif // SERVER_LEASE_HPP_
@@ -0,0 +1,35 @@
+#ifndef SERVER_OUTCOME_STATS_HPP_
+#define SERVER_OUTCOME_STATS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Request outcomes reported by the data path, kept with lock-free counters.
+// Written by request threads, read by the OutlierDetector; lives in the cold part of Server.
+// The peak-EWMA the picker reads on every pick is kept in ServerHotState instead.
+struct ServerOutcomeStats {
+    std::atomic<uint32_t>                                   consecutiveFailures{0};                                 // Failed requests in a row
+    std::atomic<uint32_t>                                   windowRequests{0};                                      // Requests in the current window
+    std::atomic<uint32_t>                                   windowFailures{0};                                      // Failures in the current window
+    std::atomic<std::chrono::steady_clock::rep>             windowStartedAt{0};                                     // Start of the current window (steady_clock ticks)
+    std::atomic<uint64_t>                                   latencyEwmaNanos{0};                                    // Smoothed latency, 0 before the first sample
+    std::atomic<std::chrono::steady_clock::rep>             ejectedUntil{0};                                        // Ejection end (steady_clock ticks), 0 when not ejected
+    std::atomic<uint32_t>                                   ejectionCount{0};                                       // Recent ejections, lengthens the next one
+    std::atomic<double>                                     limitEstimate{0.0};                                     // Adaptive concurrency limit before rounding, 0 until tracked
+    std::atomic<uint64_t>                                   baselineLatencyNanos{0};                                // Minimum latency of the current baseline window (gradient limit)
+    std::atomic<std::chrono::steady_clock::rep>             baselineWindowEnd{0};                                   // When the baseline minimum starts over (steady_clock ticks)
+
+    // Count one request; returns the consecutive failure count after it
+    uint32_t record(bool success, std::chrono::nanoseconds latency);
+
+    bool isEjected(std::chrono::steady_clock::time_point now) const;
+
+    // Seed the latency average from a persisted value (warm start) unless it already has samples
+    void seedLatency(uint64_t ewmaNanos);
+
+    // Start a new error-rate window
+    void resetWindow();
+};
+
+#endif // SERVER_OUTCOME_STATS_HPP_
@@ -0,0 +1,70 @@
+#ifndef SERVER_SNAPSHOT_HPP_
+#define SERVER_SNAPSHOT_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "server.hpp"
+#include "server_bitmap.hpp"
+
+class SelectionEngine;
+class LocalityTiers;
+
+// Immutable server list published to the selection path.
+// Readers access it inside an EpochDomain::Guard; writers build a new one and swap it in.
+// Engines that need precomputed selection state derive from it (see SelectionEngine::buildSnapshot()).
+//
+// The server list never changes, but the snapshot's indexes follow the servers' health:
+// sync() replays HotStateChangeLog entries into the available/alive bitmaps and passes each
+// change to onStateChanged() for derived selection state.
+struct ServerSnapshot {
+    static constexpr size_t npos = static_cast<size_t>(-1);                                                         // "No server" index
+    static constexpr size_t kSampleDraws = 4;                                                                       // Plain draws before sampleAvailable() ranks
+
+    std::vector<std::shared_ptr<Server>>                    servers;                                                // Servers in selection order
+    std::vector<const ServerHotState*>                      hotStates;                                              // Hot state per server, scanned without touching Server
+    mutable ServerBitmap                                    available;                                              // Servers both alive and healthy, kept current by sync()
+    mutable ServerBitmap                                    alive;                                                  // Servers alive (healthy or not), kept current by sync()
+    mutable std::atomic<size_t>                             availableCount{0};                                      // Bits set in `available`
+    SelectionEngine*                                        engine{nullptr};                                        // Engine that built the snapshot and picks from it
+    std::unique_ptr<const LocalityTiers>                    tiers;                                                  // Per-tier snapshots, null when all servers share a tier
+
+    explicit ServerSnapshot(std::vector<std::shared_ptr<Server>> serverList);
+    virtual ~ServerSnapshot();
+
+    ServerSnapshot(const ServerSnapshot&) = delete;
+    ServerSnapshot& operator=(const ServerSnapshot&) = delete;
+
+    // Apply hot state changes recorded since the last sync. One caller does the work while
+    // concurrent callers return at once and use the indexes as they are.
+    void sync() const;
+
+    // Uniformly random index from `available` other than `exclude` (npos for none), npos when
+    // no other server is available. A few plain draws first, then a rank drawn from the
+    // available count and looked up with ServerBitmap::findNth(), so the cost stays bounded
+    // when most servers are down and no server is favoured by the ones in front of it.
+    size_t sampleAvailable(size_t exclude = npos) const;
+
+    // First server at or after `from` in `bits` (wrapping) that is below its concurrency limit;
+    // the first set bit when every one is saturated, npos when none is set. Engines use it so
+    // a pick is only refused when all candidates are at their limit.
+    size_t nextUnsaturated(const ServerBitmap& bits, size_t from) const;
+
+protected:
+    // Hook for derived snapshots, called under the sync lock after the bitmaps were updated
+    virtual void onStateChanged(size_t index) const;
+
+private:
+    std::vector<std::pair<const ServerHotState*, size_t>>   _stateIndex;                                            // Hot state to server index, sorted by state
+    mutable std::atomic<uint64_t>                           _syncedSequence{0};                                     // HotStateChangeLog position applied so far
+    mutable std::mutex                                      _syncMutex;                                             // Serializes sync()
+
+    // Copy one server's flags into the bitmaps
+    void refreshIndex(size_t index) const;
+};
+
+#endif // SERVER_SNAPSHOT_HPP_
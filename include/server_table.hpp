@@ -0,0 +1,113 @@
+#ifndef SERVER_TABLE_HPP_
+#define SERVER_TABLE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "server.hpp"
+
+// Stable reference to a ServerTable slot; goes stale when the server is destroyed
+struct ServerHandle {
+    static constexpr uint32_t kInvalidSlot = UINT32_MAX;
+
+    uint32_t                                                slot{kInvalidSlot};
+    uint32_t                                                generation{0};                                          // Slot generation the server was created in
+
+    bool valid() const { return slot != kInvalidSlot; }
+    bool operator==(const ServerHandle& other) const = default;
+};
+
+// Slab of fixed-size slots holding Servers together with their shared_ptr control block.
+// Servers are allocated with std::allocate_shared into a slot, so one server costs no heap
+// allocation of its own, servers created together sit next to each other, and a removed
+// server's slot is reused LIFO by the next one instead of fragmenting the heap. Every slot
+// has a generation counter, bumped when its server is destroyed, which turns handles to the
+// old server stale. Chunks are never returned; the table is process-wide and leaked like
+// ServerHotStatePool, so shared_ptrs released at exit can still give their slot back.
+class ServerTable {
+public:
+    static constexpr size_t kSlotsPerChunk = 64;
+    static constexpr size_t kSlotBytes = (sizeof(Server) + 64 + 63) / 64 * 64;                                      // Server plus the control block, in whole cache lines
+
+private:
+    struct alignas(64) Slot {
+        unsigned char                                       storage[kSlotBytes];
+    };
+
+    struct Chunk {
+        Slot                                                slots[kSlotsPerChunk];
+        std::atomic<uint32_t>                               generations[kSlotsPerChunk]{};
+        std::atomic<Server*>                                servers[kSlotsPerChunk]{};                              // Live server per slot, null when free
+    };
+
+    // Allocator handed to allocate_shared: the control block (with the server inside) goes
+    // into one slot, and destroying the server retires that slot's generation
+    template <typename T>
+    struct SlotAllocator {
+        using value_type = T;
+
+        ServerTable*                                        table;
+        uint32_t                                            slot;
+
+        SlotAllocator(ServerTable* owner, uint32_t index) noexcept : table(owner), slot(index) {}
+
+        template <typename U>
+        SlotAllocator(const SlotAllocator<U>& other) noexcept : table(other.table), slot(other.slot) {}
+
+        T* allocate(size_t count) { return static_cast<T*>(table->storageFor(slot, sizeof(T) * count, alignof(T))); }
+        void deallocate(T* pointer, size_t count) noexcept { table->releaseStorage(slot, pointer, sizeof(T) * count, alignof(T)); }
+
+        template <typename U>
+        void destroy(U* pointer) noexcept
+        {
+            pointer->~U();
+            table->retire(slot);
+        }
+
+        template <typename U>
+        bool operator==(const SlotAllocator<U>& other) const noexcept { return table == other.table && slot == other.slot; }
+    };
+
+    mutable std::mutex                                      _mutex;                                                 // Guards the chunk list and free list
+    std::vector<Chunk*>                                     _chunks;
+    std::vector<uint32_t>                                   _freeList;                                              // Reusable slots, most recently freed last
+    uint32_t                                                _nextSlot{0};                                           // Bump index over all chunks
+    std::atomic<size_t>                                     _live{0};                                               // Servers currently in the table
+
+    ServerTable() = default;
+
+    Chunk& chunkOf(uint32_t slot) const;
+    uint32_t acquireSlot();
+
+    // Slot memory for the control block, from the heap should the block not fit
+    void* storageFor(uint32_t slot, size_t bytes, size_t alignment);
+    void releaseStorage(uint32_t slot, void* pointer, size_t bytes, size_t alignment) noexcept;
+
+    // The slot's server was destroyed: stale its handles
+    void retire(uint32_t slot) noexcept;
+
+public:
+    static ServerTable& instance();
+
+    // New server in a table slot
+    std::shared_ptr<Server> create(const std::string& serverAddress, uint32_t weight = 1);
+
+    // Handle of a server created here, invalid for servers allocated elsewhere
+    ServerHandle handleOf(const Server& server) const;
+
+    // Server a handle refers to, null once it was destroyed. The caller must keep the server
+    // referenced (e.g. through a balancer snapshot) while using the pointer.
+    Server* get(ServerHandle handle) const;
+
+    size_t size() const;                                                                                            // Live servers
+    size_t capacity() const;                                                                                        // Slots allocated so far
+
+    ServerTable(const ServerTable&) = delete;
+    ServerTable& operator=(const ServerTable&) = delete;
+};
+
+#endif // SERVER_TABLE_HPP_
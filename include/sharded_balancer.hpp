@@ -0,0 +1,126 @@
+#ifndef SHARDED_BALANCER_HPP_
+#define SHARDED_BALANCER_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+#include "round_robin_load_balancer.hpp"
+#include "cluster_state.hpp"
+#include "numa_topology.hpp"
+
+// What a ShardedBalancer keeps one replica per
+enum class ShardMode {
+    PER_NODE,       // One shard per NUMA node, serving the threads running on that node
+    PER_CORE        // One shard per CPU (capped by maxShards, contiguous CPUs grouped)
+};
+
+// Builds one shard from its own copies of the servers
+using ShardFactory = std::function<std::unique_ptr<LoadBalancer>(const std::vector<std::shared_ptr<Server>>& servers)>;
+
+// Front-end over per-NUMA-node (or per-core) balancer replicas.
+// Every shard is a complete balancer with its own Server copies, snapshot, cursors and
+// counters, built on a thread bound to the shard's CPUs so that memory is first touched on
+// the shard's node (hot state blocks come from that node's ServerHotStatePool arena). A pick
+// goes to the shard of the CPU the calling thread runs on, so the request path only touches
+// node-local memory and leases count against the local copy.
+//
+// The shards form an InProcessClusterState group: each backend is probed by one shard and
+// the others adopt the result, and every sync interval each shard publishes its connection
+// counts and takes the sum of the other shards' as remote connections, so least-connections
+// and bounded-load picks see the whole process, lagging by at most one interval. Health
+// checks drive that exchange; without them call synchronizeShards(). All shards probe through
+// the first shard's PingServer, so the process runs one probe engine and one DNS resolver
+// however many shards there are; each shard's health check loop only sweeps what it owns.
+//
+// Concurrency limits are enforced by each shard on its own leases. A fixed limit set on a
+// server before it is passed in is divided across the shards (shares differ by at most one,
+// and every shard keeps at least 1), so the process as a whole admits about the configured
+// limit. Adaptive limits are learned per shard from that shard's outcomes, and limiter
+// settings (initial, minimum and maximum limit) apply per shard, so configure them for
+// one shard's share of the traffic. Limits set later through forEachShard() are per shard.
+//
+// Servers passed in are copied, so manage them through this front-end (or forEachShard()).
+// Snapshots republished later by a shard's health check thread are allocated wherever that
+// thread runs.
+class ShardedBalancer {
+private:
+    struct Shard {
+        std::unique_ptr<LoadBalancer>                       balancer;
+        std::vector<uint32_t>                               cpus;                                                   // CPUs routed here, also where it is built
+    };
+
+    std::vector<Shard>                                      _shards;
+    std::vector<uint32_t>                                   _cpuShard;                                              // CPU id to shard index (read-only after construction)
+    ShardMode                                               _mode;
+    std::shared_ptr<InProcessClusterState::Group>           _group;                                                 // Shared by the shards' cluster states
+    std::mutex                                              _managementMutex;                                       // Serializes server list changes across shards
+
+    // Run fn on a thread bound to the shard's CPUs and wait for it; rethrows fn's exception
+    void runOnShard(size_t shard, const std::function<void()>& fn) const;
+
+    // Copy of `server` for one shard, allocated by the calling thread, with the shard's share
+    // of its concurrency limit
+    std::shared_ptr<Server> copyServer(const Server& server, size_t shard) const;
+    std::vector<std::shared_ptr<Server>> copyServers(const std::vector<std::shared_ptr<Server>>& servers, size_t shard) const;
+
+public:
+    // Constructor (maxShards 0 for one per node or core)
+    ShardedBalancer(
+        const std::vector<std::shared_ptr<Server>>& servers,
+        ShardFactory factory,
+        ShardMode mode = ShardMode::PER_NODE,
+        size_t maxShards = 0
+    );
+
+    // Shards are pinned to this object's topology, so it is neither copied nor moved
+    ShardedBalancer(const ShardedBalancer&) = delete;
+    ShardedBalancer& operator=(const ShardedBalancer&) = delete;
+    ~ShardedBalancer();
+
+    // Pick path, served by the calling thread's shard
+    size_t localShardIndex() const;
+    LoadBalancer& localShard();
+    std::shared_ptr<Server> getNextServer();
+    ServerLease acquireNextServer();
+    size_t acquireNextServers(std::span<ServerLease> out);
+    Task<ExecutionResult> execute(RequestFunction fn);                                                              // Retries stay on the shard that started the request
+
+    // Server management, applied to every shard (each builds its own copy on its node)
+    bool addServer(const std::shared_ptr<Server>& server);
+    bool removeServer(const std::string& serverAddress);
+
+    // Call fn(LoadBalancer&) for each shard, e.g. to apply settings everywhere
+    template <typename Fn>
+    void forEachShard(Fn&& fn)
+    {
+        for (auto& shard : _shards) {
+            fn(*shard.balancer);
+        }
+    }
+
+    // Health checks and the cross-shard exchange
+    void startHealthChecks();
+    void stopHealthChecks();
+    void synchronizeShards();                                                                                       // One exchange round now
+    void setSyncInterval(std::chrono::milliseconds interval);
+    std::chrono::milliseconds getSyncInterval() const;
+
+    // Access
+    size_t getShardCount() const;
+    LoadBalancer& getShard(size_t index);
+    const LoadBalancer& getShard(size_t index) const;
+    const std::vector<uint32_t>& getShardCpus(size_t index) const;
+    ShardMode getMode() const;
+
+    // Statistics
+    size_t getServerCount() const;
+    size_t getHealthyServerCount() const;                                                                           // As the local shard sees it
+    uint64_t getTotalPicks() const;                                                                                 // Summed over shards
+};
+
+#endif // SHARDED_BALANCER_HPP_
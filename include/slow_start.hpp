@@ -0,0 +1,49 @@
+#ifndef SLOW_START_HPP_
+#define SLOW_START_HPP_
+
+#include <atomic>
+#include <chrono>
+#include "server_hot_state.hpp"
+
+// Shape of the slow start ramp
+enum class RampCurve {
+    LINEAR,         // floor + (1 - floor) * progress
+    EXPONENTIAL     // floor ^ (1 - progress), doubling-style growth
+};
+
+// Slow start for servers that were just added or just became healthy.
+// During the window their effective weight ramps from floor * weight up to the full weight.
+// The ramp start lives in the server's hot state, so reading the factor on the selection
+// path is a couple of relaxed loads (plus a clock read only while a ramp is running).
+// A window of zero (the default) disables slow start.
+class SlowStart {
+private:
+    std::atomic<std::chrono::milliseconds::rep>             _window{0};                                             // Ramp length (ms), 0 disables
+    std::atomic<double>                                     _floor{0.1};                                            // Starting fraction of the weight
+    std::atomic<RampCurve>                                  _curve{RampCurve::LINEAR};
+
+public:
+    // Constructor
+    SlowStart() = default;
+
+    // Copy configuration
+    SlowStart(const SlowStart& other);
+    SlowStart& operator=(const SlowStart& other);
+    ~SlowStart() = default;
+
+    // Fraction of the weight a server gets right now, 1.0 outside a ramp
+    double factor(const ServerHotState& state) const;
+
+    // weight * factor, as used by the weighted and least-connection engines
+    double effectiveWeight(const ServerHotState& state) const;
+
+    // Configuration
+    void setWindow(std::chrono::milliseconds window);
+    std::chrono::milliseconds getWindow() const;
+    void setFloor(double floor);
+    double getFloor() const;
+    void setCurve(RampCurve curve);
+    RampCurve getCurve() const;
+};
+
+#endif // SLOW_START_HPP_
@@ -0,0 +1,144 @@
+#ifndef TASK_HPP_
+#define TASK_HPP_
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+// Lazily started coroutine producing a T. The body runs when the task is awaited, and the
+// awaiting coroutine is resumed by symmetric transfer when it finishes, on whichever thread
+// completed the last operation the body awaited. Exceptions propagate to the awaiter.
+template <typename T>
+class Task {
+public:
+    struct promise_type {
+        std::optional<T>                                    value;
+        std::exception_ptr                                  error;
+        std::coroutine_handle<>                             continuation;                                           // Coroutine awaiting this one
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+            {
+                std::coroutine_handle<> next = handle.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void return_value(T result) { value = std::move(result); }
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+private:
+    std::coroutine_handle<promise_type>                     _handle;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+
+public:
+    Task() noexcept = default;
+
+    ~Task()
+    {
+        if (_handle) {
+            _handle.destroy();
+        }
+    }
+
+    // Move-only
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept : _handle(std::exchange(other._handle, {})) {}
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (_handle) {
+                _handle.destroy();
+            }
+            _handle = std::exchange(other._handle, {});
+        }
+        return *this;
+    }
+
+    // Awaiting starts the body
+    bool await_ready() const noexcept { return !_handle || _handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        _handle.promise().continuation = awaiting;
+        return _handle;
+    }
+
+    T await_resume()
+    {
+        if (_handle.promise().error) {
+            std::rethrow_exception(_handle.promise().error);
+        }
+        return std::move(*_handle.promise().value);
+    }
+};
+
+// Fire-and-forget coroutine: starts at once and frees its frame when it finishes.
+// The body must not let exceptions escape.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+namespace task_detail {
+    template <typename T>
+    struct SyncState {
+        std::mutex                                          mutex;
+        std::condition_variable                             finished;
+        bool                                                done{false};
+        std::optional<T>                                    value;
+        std::exception_ptr                                  error;
+    };
+
+    // Parameters live in the coroutine frame, so nothing dangles while it is suspended
+    template <typename T>
+    DetachedTask runToCompletion(Task<T>& task, SyncState<T>& state)
+    {
+        try {
+            state.value.emplace(co_await task);
+        } catch (...) {
+            state.error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.done = true;
+        state.finished.notify_all();
+    }
+}
+
+// Run a task from non-coroutine code and block the calling thread until it finishes
+template <typename T>
+T syncWait(Task<T> task)
+{
+    task_detail::SyncState<T> state;
+    task_detail::runToCompletion(task, state);
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.finished.wait(lock, [&state]() { return state.done; });
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+    return std::move(*state.value);
+}
+
+#endif // TASK_HPP_
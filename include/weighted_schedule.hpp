@@ -0,0 +1,57 @@
+#ifndef WEIGHTED_SCHEDULE_HPP_
+#define WEIGHTED_SCHEDULE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Weighted round robin schedule with O(servers) memory and in-place weight updates.
+// A period of totalWeight() tickets is laid out as consecutive weight ranges, kept in a
+// Fenwick tree so that both finding a ticket's owner and changing one weight cost O(log N).
+// Tickets are permuted by a stride coprime to the period (close to the golden ratio), so
+// every server receives exactly its weight per period and its picks are spread evenly
+// instead of being bunched together.
+//
+// pick() may run concurrently with setWeight(); a pick racing an update sees either weight
+// for the changing server and may miss by one range, but always returns npos or an index
+// below size(). setWeight() calls must be serialized by the caller.
+class WeightedSchedule {
+private:
+    size_t                                                  _size{0};
+    size_t                                                  _topStep{0};                                            // Highest power of two <= _size
+    std::unique_ptr<std::atomic<uint64_t>[]>                _tree;                                                  // Fenwick tree over weights, 1-based
+    std::unique_ptr<std::atomic<uint32_t>[]>                _weights;                                               // Current weight per server
+    std::atomic<uint64_t>                                   _totalWeight{0};                                        // Period length in tickets
+    std::atomic<uint64_t>                                   _stride{1};                                             // Ticket permutation stride
+
+    // Stride coprime to the period closest to period * (golden ratio - 1)
+    static uint64_t computeStride(uint64_t period);
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Build from per-server weights in O(N); zero weights receive no tickets
+    explicit WeightedSchedule(const std::vector<uint32_t>& weights = {});
+
+    // No copy or move (readers hold references into the tree)
+    WeightedSchedule(const WeightedSchedule&) = delete;
+    WeightedSchedule& operator=(const WeightedSchedule&) = delete;
+
+    // Index of the server owning a ticket, or npos when every weight is zero
+    size_t pick(uint64_t ticket) const;
+
+    // Index of the server owning a position in [0, totalWeight())
+    size_t serverAt(uint64_t position) const;
+
+    // Change one server's weight in O(log N); returns true if it changed
+    bool setWeight(size_t index, uint32_t weight);
+    uint32_t weightAt(size_t index) const;
+
+    uint64_t totalWeight() const;
+    size_t size() const;
+    bool empty() const;
+};
+
+#endif // WEIGHTED_SCHEDULE_HPP_
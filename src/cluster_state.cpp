@@ -0,0 +1,795 @@
+#include "cluster_state.hpp"
+#include "ip_hash_load_balancer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <thread>
+
+// Platform-specific includes
+#ifdef _WIN32
+    #define close closesocket
+#else
+    #include <netinet/in.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    uint64_t mix64(uint64_t value)
+    {
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ULL;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBULL;
+        value ^= value >> 31;
+        return value;
+    }
+
+    int64_t steadyMillis()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Published health word: owner version in the high bits, hot state flags in the low byte
+    constexpr uint64_t kFlagBits = 8;
+    constexpr uint64_t kFlagMask = (uint64_t{1} << kFlagBits) - 1;
+
+    uint64_t healthWord(uint64_t version, uint32_t flags)
+    {
+        return (version << kFlagBits) | (flags & kFlagMask);
+    }
+}
+
+// ClusterState implementation
+ClusterState::ClusterState(uint64_t memberId)
+    : _memberId([memberId]() {
+          if (memberId != 0) {
+              return memberId;
+          }
+          std::random_device device;
+          uint64_t id = 0;
+          while (id == 0) {
+              id = (static_cast<uint64_t>(device()) << 32) ^ device();
+          }
+          return id;
+      }())
+{
+}
+
+uint64_t ClusterState::serverKey(const Server& server)
+{
+    // Zero and all ones mark free and released shared memory records
+    uint64_t key = IpHashEngine::hashKey(server.getServerAddress());
+    return key != 0 && key != ~uint64_t{0} ? key : 1;
+}
+
+uint64_t ClusterState::ownerOf(uint64_t key, const std::vector<uint64_t>& members)
+{
+    uint64_t owner = 0;
+    uint64_t bestScore = 0;
+    for (uint64_t member : members) {
+        uint64_t score = mix64(key ^ mix64(member));
+        if (owner == 0 || score > bestScore) {
+            owner = member;
+            bestScore = score;
+        }
+    }
+    return owner;
+}
+
+void ClusterState::applyHealth(Server& server, uint32_t flags)
+{
+    // The owner's probe stands in for ours, so adopted health also confirms a warm start
+    server.setAlive((flags & ServerHotState::kAlive) != 0);
+    server.setHealthy((flags & ServerHotState::kHealthy) != 0 && !server.isEjected());
+    server.updateLastHealthCheck();
+}
+
+uint32_t ClusterState::healthFlags(const Server& server)
+{
+    return server.hotState().flags.load(std::memory_order_relaxed) & ServerHotState::kAvailable;
+}
+
+uint64_t ClusterState::getMemberId() const
+{
+    return _memberId;
+}
+
+void ClusterState::setSyncInterval(std::chrono::milliseconds interval)
+{
+    _syncInterval.store((std::max)(interval.count(), std::chrono::milliseconds::rep(1)), std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds ClusterState::getSyncInterval() const
+{
+    return std::chrono::milliseconds(_syncInterval.load(std::memory_order_relaxed));
+}
+
+void ClusterState::setMemberTimeout(std::chrono::milliseconds timeout)
+{
+    _memberTimeout.store((std::max)(timeout.count(), std::chrono::milliseconds::rep(1)), std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds ClusterState::getMemberTimeout() const
+{
+    return std::chrono::milliseconds(_memberTimeout.load(std::memory_order_relaxed));
+}
+
+// SharedMemoryClusterState implementation
+struct SharedMemoryClusterState::Segment {
+    static constexpr uint64_t kMagic = 0x4C42435332000000ULL;                                                       // "LBCS2"
+
+    struct Member {
+        std::atomic<uint64_t>                               id{0};                                                  // 0 when the slot is free
+        std::atomic<int64_t>                                heartbeat{0};                                           // steady_clock ms of the last synchronize()
+    };
+
+    struct Record {
+        std::atomic<uint64_t>                               key{0};                                                 // Server key, 0 when never used, kReleasedKey when freed
+        std::atomic<uint64_t>                               health{0};                                              // healthWord() published by the owner, 0 before the first
+        std::atomic<int64_t>                                lastSeen{0};                                            // steady_clock ms a member last reported the server
+        std::atomic<uint32_t>                               connections[kMaxMembers];                               // Connections per member slot
+    };
+
+    std::atomic<uint64_t>                                   magic;                                                  // Set by the creator once the layout is valid
+    uint64_t                                                recordCount;
+    Member                                                  members[kMaxMembers];
+
+    Record* records() { return reinterpret_cast<Record*>(this + 1); }
+
+    static size_t sizeFor(size_t recordCount) { return sizeof(Segment) + recordCount * sizeof(Record); }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "Shared memory counters must be lock-free to work across processes");
+
+// Constructor
+SharedMemoryClusterState::SharedMemoryClusterState(const std::string& name, size_t serverSlots, uint64_t memberId)
+    : ClusterState(memberId)
+{
+    #ifndef _WIN32
+        if (name.empty() || serverSlots == 0) {
+            return;
+        }
+
+        std::string path = name.front() == '/' ? name : "/" + name;
+        size_t size = Segment::sizeFor(serverSlots);
+
+        // The creator sizes the segment; zero-filled memory already is an empty cluster
+        bool created = true;
+        int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0 && errno == EEXIST) {
+            created = false;
+            fd = shm_open(path.c_str(), O_RDWR, 0600);
+        }
+        if (fd < 0) {
+            return;
+        }
+
+        if (created && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            shm_unlink(path.c_str());
+            return;
+        }
+
+        // Joiners wait (briefly) for the creator to size the segment
+        struct stat info{};
+        for (int attempt = 0; !created && attempt < 100; ++attempt) {
+            if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= size) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (!created && (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != size)) {
+            ::close(fd);
+            return; // Missing, or created with another slot count
+        }
+
+        void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return;
+        }
+
+        auto* segment = static_cast<Segment*>(mapping);
+        if (created) {
+            segment->recordCount = serverSlots;
+            segment->magic.store(Segment::kMagic, std::memory_order_release);
+        } else {
+            for (int attempt = 0; attempt < 100 && segment->magic.load(std::memory_order_acquire) != Segment::kMagic; ++attempt) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            if (segment->magic.load(std::memory_order_acquire) != Segment::kMagic || segment->recordCount != serverSlots) {
+                munmap(mapping, size);
+                return;
+            }
+        }
+
+        _segment = segment;
+        _mappedSize = size;
+        if (!joinSegment()) {
+            munmap(mapping, size);
+            _segment = nullptr;
+            _mappedSize = 0;
+        }
+    #else
+        (void)name;
+        (void)serverSlots;
+    #endif
+}
+
+// Destructor
+SharedMemoryClusterState::~SharedMemoryClusterState()
+{
+    #ifndef _WIN32
+        if (_segment) {
+            // Free the slot; the counters in our column are cleared by the next member taking it
+            uint64_t id = getMemberId();
+            _segment->members[_memberSlot].id.compare_exchange_strong(id, 0, std::memory_order_acq_rel);
+            munmap(_segment, _mappedSize);
+        }
+    #endif
+}
+
+bool SharedMemoryClusterState::isOpen() const
+{
+    return _segment != nullptr;
+}
+
+bool SharedMemoryClusterState::unlink(const std::string& name)
+{
+    #ifndef _WIN32
+        std::string path = !name.empty() && name.front() == '/' ? name : "/" + name;
+        return shm_unlink(path.c_str()) == 0;
+    #else
+        (void)name;
+        return false;
+    #endif
+}
+
+// Claim a free or stale member slot and clear its counters
+bool SharedMemoryClusterState::joinSegment()
+{
+    int64_t now = steadyMillis();
+    int64_t timeout = getMemberTimeout().count();
+
+    for (size_t slot = 0; slot < kMaxMembers; ++slot) {
+        Segment::Member& member = _segment->members[slot];
+        uint64_t id = member.id.load(std::memory_order_acquire);
+        if (id != 0 && now - member.heartbeat.load(std::memory_order_acquire) <= timeout) {
+            continue;
+        }
+        if (!member.id.compare_exchange_strong(id, getMemberId(), std::memory_order_acq_rel)) {
+            continue;
+        }
+
+        member.heartbeat.store(now, std::memory_order_release);
+        Segment::Record* records = _segment->records();
+        for (size_t i = 0; i < _segment->recordCount; ++i) {
+            records[i].connections[slot].store(0, std::memory_order_relaxed);
+        }
+        _memberSlot = slot;
+        return true;
+    }
+    return false;
+}
+
+// Record slot for a server key, claiming a free one if needed
+size_t SharedMemoryClusterState::recordFor(uint64_t key)
+{
+    Segment::Record* records = _segment->records();
+    auto cached = _recordIndex.find(key);
+    if (cached != _recordIndex.end()) {
+        if (records[cached->second].key.load(std::memory_order_acquire) == key) {
+            return cached->second;
+        }
+        _recordIndex.erase(cached); // Released while we were not reporting it
+    }
+
+    // Linear probing: the chain of a key ends at a never-used slot, released slots are passed
+    // over and the first of them is reused when the key is not found
+    size_t count = _segment->recordCount;
+    size_t start = static_cast<size_t>(key % count);
+    while (true) {
+        size_t reusable = kNoRecord;
+        size_t end = kNoRecord;
+        for (size_t i = 0; i < count; ++i) {
+            size_t slot = start + i < count ? start + i : start + i - count;
+            uint64_t current = records[slot].key.load(std::memory_order_acquire);
+            if (current == key) {
+                _recordIndex.emplace(key, slot);
+                return slot;
+            }
+            if (current == kReleasedKey && reusable == kNoRecord) {
+                reusable = slot;
+            } else if (current == 0) {
+                end = slot;
+                break;
+            }
+        }
+
+        size_t slot = reusable != kNoRecord ? reusable : end;
+        if (slot == kNoRecord) {
+            return kNoRecord;
+        }
+        uint64_t expected = reusable != kNoRecord ? kReleasedKey : 0;
+        if (records[slot].key.compare_exchange_strong(expected, key, std::memory_order_acq_rel)) {
+            records[slot].lastSeen.store(steadyMillis(), std::memory_order_relaxed);
+            _recordIndex.emplace(key, slot);
+            return slot;
+        }
+        // Another member took the slot first (possibly for this key); probe again
+    }
+}
+
+// Free records no live member reported within the member timeout
+void SharedMemoryClusterState::releaseStale(int64_t now, int64_t timeout)
+{
+    Segment::Record* records = _segment->records();
+    for (size_t slot = 0; slot < _segment->recordCount; ++slot) {
+        Segment::Record& record = records[slot];
+        uint64_t key = record.key.load(std::memory_order_acquire);
+        if (key == 0 || key == kReleasedKey || now - record.lastSeen.load(std::memory_order_relaxed) <= timeout) {
+            continue;
+        }
+
+        // Clear the record, then free it unless a member reported the server meanwhile (its
+        // counters return with its next round)
+        record.health.store(0, std::memory_order_relaxed);
+        for (auto& connections : record.connections) {
+            connections.store(0, std::memory_order_relaxed);
+        }
+        if (now - record.lastSeen.load(std::memory_order_acquire) <= timeout) {
+            continue;
+        }
+        record.key.compare_exchange_strong(key, kReleasedKey, std::memory_order_acq_rel);
+        _recordIndex.erase(key);
+    }
+}
+
+bool SharedMemoryClusterState::ownsProbe(const Server& server) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_segment || _members.empty()) {
+        return true; // Not clustered (yet): probe everything
+    }
+    return ownerOf(serverKey(server), _members) == getMemberId();
+}
+
+void SharedMemoryClusterState::synchronize(const std::vector<std::shared_ptr<Server>>& servers)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_segment) {
+        return;
+    }
+
+    // Rejoin when our slot was taken over while we were stalled
+    if (_segment->members[_memberSlot].id.load(std::memory_order_acquire) != getMemberId() && !joinSegment()) {
+        _members.clear();
+        return;
+    }
+
+    int64_t now = steadyMillis();
+    int64_t timeout = getMemberTimeout().count();
+    _segment->members[_memberSlot].heartbeat.store(now, std::memory_order_release);
+
+    _members.clear();
+    _remoteSlots.clear();
+    for (size_t slot = 0; slot < kMaxMembers; ++slot) {
+        const Segment::Member& member = _segment->members[slot];
+        uint64_t id = member.id.load(std::memory_order_acquire);
+        if (id != 0 && now - member.heartbeat.load(std::memory_order_acquire) <= timeout) {
+            _members.push_back(id);
+            if (slot != _memberSlot) {
+                _remoteSlots.push_back(slot);
+            }
+        }
+    }
+
+    Segment::Record* records = _segment->records();
+    for (const auto& server : servers) {
+        uint64_t key = serverKey(*server);
+        size_t slot = recordFor(key);
+        if (slot == kNoRecord) {
+            continue; // Segment full; this server stays local-only
+        }
+
+        Segment::Record& record = records[slot];
+        record.lastSeen.store(now, std::memory_order_relaxed);
+        record.connections[_memberSlot].store(server->getCurrentConnections(), std::memory_order_relaxed);
+
+        uint32_t remote = 0;
+        for (size_t remoteSlot : _remoteSlots) {
+            remote += record.connections[remoteSlot].load(std::memory_order_relaxed);
+        }
+        server->setRemoteConnections(remote);
+
+        uint64_t word = record.health.load(std::memory_order_acquire);
+        if (ownerOf(key, _members) == getMemberId()) {
+            uint32_t flags = healthFlags(*server);
+            if (word == 0 || (word & kFlagMask) != flags) {
+                record.health.store(healthWord((word >> kFlagBits) + 1, flags), std::memory_order_release);
+            }
+        } else if (word != 0) {
+            applyHealth(*server, static_cast<uint32_t>(word & kFlagMask));
+        }
+    }
+
+    // One pass over the table per member timeout frees what nobody reports any more
+    if (now >= _nextRelease) {
+        _nextRelease = now + timeout;
+        releaseStale(now, timeout);
+    }
+}
+
+// GossipClusterState implementation
+namespace {
+    // Datagram layout, all fields big-endian:
+    //   header: magic u32, version u16, entry count u16, member id u64, flags u32, reserved u32
+    //   entry:  server key u64, health word u64, connections u32, reserved u32
+    constexpr uint32_t kGossipMagic = 0x4C424753;                                                                   // "LBGS"
+    constexpr uint16_t kGossipVersion = 1;
+    constexpr uint32_t kGossipReset = 1u << 0;                                                                      // Receiver drops this member's previous counts
+    constexpr size_t kGossipHeaderBytes = 24;
+    constexpr size_t kGossipEntryBytes = 24;
+
+    void putBigEndian(uint8_t* out, uint64_t value, size_t bytes)
+    {
+        for (size_t i = 0; i < bytes; ++i) {
+            out[i] = static_cast<uint8_t>(value >> (8 * (bytes - 1 - i)));
+        }
+    }
+
+    uint64_t getBigEndian(const uint8_t* in, size_t bytes)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value = (value << 8) | in[i];
+        }
+        return value;
+    }
+}
+
+// Constructor
+GossipClusterState::GossipClusterState(uint16_t port, uint64_t memberId)
+    : ClusterState(memberId)
+{
+    #ifdef _WIN32
+        WSADATA wsaData;
+        WSAStartup(MAKEWORD(2, 2), &wsaData);
+    #endif
+
+    int sock = static_cast<int>(::socket(AF_INET, SOCK_DGRAM, 0));
+    if (sock < 0) {
+        return;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (::bind(sock, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(sock);
+        return;
+    }
+
+    #ifdef _WIN32
+        u_long mode = 1;
+        ioctlsocket(sock, FIONBIO, &mode);
+    #else
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(sock, F_SETFD, FD_CLOEXEC);
+    #endif
+    _socket = sock;
+}
+
+// Destructor
+GossipClusterState::~GossipClusterState()
+{
+    if (_socket >= 0) {
+        close(_socket);
+    }
+
+    #ifdef _WIN32
+        WSACleanup();
+    #endif
+}
+
+bool GossipClusterState::isOpen() const
+{
+    return _socket >= 0;
+}
+
+bool GossipClusterState::addPeer(const std::string& address)
+{
+    std::string host;
+    uint16_t port;
+    ServerEndpoint endpoint;
+    if (!ServerEndpoint::parseAddress(address, host, port) ||
+        !ServerEndpoint::fromLiteral(host, port, endpoint) ||
+        endpoint.address.ss_family != AF_INET) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& peer : _peers) {
+        if (peer.endpoint.sameAddress(endpoint)) {
+            return false;
+        }
+    }
+    Peer peer;
+    peer.endpoint = endpoint;
+    _peers.push_back(std::move(peer));
+    return true;
+}
+
+bool GossipClusterState::ownsProbe(const Server& server) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_members.empty()) {
+        return true; // Not synchronized yet: probe everything
+    }
+    return ownerOf(serverKey(server), _members) == getMemberId();
+}
+
+// Apply every datagram waiting on the socket
+void GossipClusterState::receive(Clock::time_point now)
+{
+    uint8_t buffer[kMaxDatagramBytes];
+
+    while (true) {
+        ServerEndpoint from;
+        from.length = sizeof(from.address);
+        auto received = ::recvfrom(_socket, reinterpret_cast<char*>(buffer), sizeof(buffer), 0,
+                                   reinterpret_cast<sockaddr*>(&from.address), &from.length);
+        if (received < 0) {
+            return; // Drained (or a transient error; the next round retries)
+        }
+
+        size_t size = static_cast<size_t>(received);
+        if (size < kGossipHeaderBytes ||
+            getBigEndian(buffer, 4) != kGossipMagic ||
+            getBigEndian(buffer + 4, 2) != kGossipVersion) {
+            continue;
+        }
+
+        size_t entryCount = static_cast<size_t>(getBigEndian(buffer + 6, 2));
+        uint64_t memberId = getBigEndian(buffer + 8, 8);
+        uint32_t flags = static_cast<uint32_t>(getBigEndian(buffer + 16, 4));
+        if (memberId == 0 || memberId == getMemberId() || size < kGossipHeaderBytes + entryCount * kGossipEntryBytes) {
+            continue;
+        }
+
+        auto peer = std::find_if(_peers.begin(), _peers.end(),
+                                 [&](const Peer& candidate) { return candidate.endpoint.sameAddress(from); });
+        if (peer == _peers.end()) {
+            continue; // Only configured peers take part
+        }
+
+        if (peer->memberId != memberId || (flags & kGossipReset) != 0) {
+            peer->connections.clear();
+        }
+        peer->memberId = memberId;
+        peer->lastHeard = now;
+
+        const uint8_t* entry = buffer + kGossipHeaderBytes;
+        for (size_t i = 0; i < entryCount; ++i, entry += kGossipEntryBytes) {
+            uint64_t key = getBigEndian(entry, 8);
+            uint64_t word = getBigEndian(entry + 8, 8);
+            peer->connections[key] = static_cast<uint32_t>(getBigEndian(entry + 16, 4));
+
+            // Health travels with its owner's version; the newest one wins
+            HealthRecord& health = _health[key];
+            health.lastSeen = now;
+            if ((word >> kFlagBits) > health.version) {
+                health.version = word >> kFlagBits;
+                health.flags = static_cast<uint32_t>(word & kFlagMask);
+            }
+        }
+    }
+}
+
+// Send entries to every peer, split into datagrams
+void GossipClusterState::send(const std::vector<uint8_t>& entries, size_t entryCount, bool fullState)
+{
+    constexpr size_t kEntriesPerDatagram = (kMaxDatagramBytes - kGossipHeaderBytes) / kGossipEntryBytes;
+    uint8_t buffer[kMaxDatagramBytes];
+
+    // Always at least one datagram: it doubles as the heartbeat
+    size_t sent = 0;
+    do {
+        size_t count = (std::min)(entryCount - sent, kEntriesPerDatagram);
+        bool reset = fullState && sent == 0;
+
+        putBigEndian(buffer, kGossipMagic, 4);
+        putBigEndian(buffer + 4, kGossipVersion, 2);
+        putBigEndian(buffer + 6, count, 2);
+        putBigEndian(buffer + 8, getMemberId(), 8);
+        putBigEndian(buffer + 16, reset ? kGossipReset : 0, 4);
+        putBigEndian(buffer + 20, 0, 4);
+        if (count != 0) {
+            std::memcpy(buffer + kGossipHeaderBytes, entries.data() + sent * kGossipEntryBytes, count * kGossipEntryBytes);
+        }
+
+        size_t size = kGossipHeaderBytes + count * kGossipEntryBytes;
+        for (const auto& peer : _peers) {
+            ::sendto(_socket, reinterpret_cast<const char*>(buffer), static_cast<int>(size), 0,
+                     reinterpret_cast<const sockaddr*>(&peer.endpoint.address), peer.endpoint.length);
+        }
+        sent += count;
+    } while (sent < entryCount);
+}
+
+void GossipClusterState::synchronize(const std::vector<std::shared_ptr<Server>>& servers)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_socket < 0) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    receive(now);
+
+    _members.assign(1, getMemberId());
+    std::vector<const Peer*> livePeers;
+    for (const auto& peer : _peers) {
+        if (peer.memberId != 0 && now - peer.lastHeard <= getMemberTimeout()) {
+            _members.push_back(peer.memberId);
+            livePeers.push_back(&peer);
+        }
+    }
+
+    // Full rounds also forget servers that were removed since the last one, and health
+    // nobody reported for the member timeout
+    bool fullState = _round++ % kFullStateRounds == 0;
+    if (fullState) {
+        _sent.clear();
+        for (auto it = _health.begin(); it != _health.end();) {
+            it = now - it->second.lastSeen > getMemberTimeout() ? _health.erase(it) : std::next(it);
+        }
+    }
+
+    std::vector<uint8_t> entries;
+    size_t entryCount = 0;
+    for (const auto& server : servers) {
+        uint64_t key = serverKey(*server);
+        uint32_t connections = server->getCurrentConnections();
+
+        uint32_t remote = 0;
+        for (const Peer* peer : livePeers) {
+            auto it = peer->connections.find(key);
+            remote += it != peer->connections.end() ? it->second : 0;
+        }
+        server->setRemoteConnections(remote);
+
+        HealthRecord& health = _health[key];
+        health.lastSeen = now;
+        if (ownerOf(key, _members) == getMemberId()) {
+            uint32_t flags = healthFlags(*server);
+            if (health.version == 0 || health.flags != flags) {
+                ++health.version;
+                health.flags = flags;
+            }
+        } else if (health.version != 0) {
+            applyHealth(*server, health.flags);
+        }
+
+        // Health learned from others is forwarded too, so it reaches peers we share only indirectly
+        SentState& last = _sent[key];
+        if (!last.sent || last.connections != connections || last.healthVersion != health.version) {
+            last = SentState{health.version, connections, true};
+
+            entries.resize(entries.size() + kGossipEntryBytes);
+            uint8_t* entry = entries.data() + entryCount * kGossipEntryBytes;
+            putBigEndian(entry, key, 8);
+            putBigEndian(entry + 8, health.version != 0 ? healthWord(health.version, health.flags) : 0, 8);
+            putBigEndian(entry + 16, connections, 4);
+            putBigEndian(entry + 20, 0, 4);
+            ++entryCount;
+        }
+    }
+
+    send(entries, entryCount, fullState);
+}
+
+// InProcessClusterState implementation
+struct InProcessClusterState::Group {
+    struct Record {
+        uint64_t                                            health{0};                                              // Health word, 0 until the owner published
+        int64_t                                             lastSeen{0};                                            // Last synchronize() that reported the server (ms)
+        std::unordered_map<uint64_t, uint32_t>              connections;                                            // Member id to its connection count
+    };
+
+    std::mutex                                              mutex;
+    std::unordered_map<uint64_t, int64_t>                   heartbeats;                                             // Member id to last synchronize() (ms)
+    std::unordered_map<uint64_t, Record>                    records;                                                // Server key to record
+    int64_t                                                 nextRelease{0};                                         // When stale records are dropped next (ms)
+};
+
+std::shared_ptr<InProcessClusterState::Group> InProcessClusterState::makeGroup()
+{
+    return std::make_shared<Group>();
+}
+
+// Constructor
+InProcessClusterState::InProcessClusterState(std::shared_ptr<Group> group, uint64_t memberId)
+    : ClusterState(memberId),
+      _group(group ? std::move(group) : makeGroup())
+{
+    std::lock_guard<std::mutex> lock(_group->mutex);
+    _group->heartbeats[getMemberId()] = steadyMillis();
+}
+
+// Destructor
+InProcessClusterState::~InProcessClusterState()
+{
+    std::lock_guard<std::mutex> lock(_group->mutex);
+    _group->heartbeats.erase(getMemberId());
+    for (auto& entry : _group->records) {
+        entry.second.connections.erase(getMemberId());
+    }
+}
+
+bool InProcessClusterState::ownsProbe(const Server& server) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_members.empty()) {
+        return true; // Not synchronized yet: probe everything
+    }
+    return ownerOf(serverKey(server), _members) == getMemberId();
+}
+
+void InProcessClusterState::synchronize(const std::vector<std::shared_ptr<Server>>& servers)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::lock_guard<std::mutex> groupLock(_group->mutex);
+
+    int64_t now = steadyMillis();
+    int64_t timeout = getMemberTimeout().count();
+    _group->heartbeats[getMemberId()] = now;
+
+    _members.clear();
+    for (const auto& member : _group->heartbeats) {
+        if (now - member.second <= timeout) {
+            _members.push_back(member.first);
+        }
+    }
+
+    // Drop servers no member reported for the member timeout, once per timeout
+    if (now >= _group->nextRelease) {
+        _group->nextRelease = now + timeout;
+        for (auto it = _group->records.begin(); it != _group->records.end();) {
+            it = now - it->second.lastSeen > timeout ? _group->records.erase(it) : std::next(it);
+        }
+    }
+
+    for (const auto& server : servers) {
+        uint64_t key = serverKey(*server);
+        Group::Record& record = _group->records[key];
+        record.lastSeen = now;
+        record.connections[getMemberId()] = server->getCurrentConnections();
+
+        uint32_t remote = 0;
+        for (uint64_t member : _members) {
+            if (member != getMemberId()) {
+                auto counted = record.connections.find(member);
+                remote += counted != record.connections.end() ? counted->second : 0;
+            }
+        }
+        server->setRemoteConnections(remote);
+
+        if (ownerOf(key, _members) == getMemberId()) {
+            uint32_t flags = healthFlags(*server);
+            if (record.health == 0 || (record.health & kFlagMask) != flags) {
+                record.health = healthWord((record.health >> kFlagBits) + 1, flags);
+            }
+        } else if (record.health != 0) {
+            applyHealth(*server, static_cast<uint32_t>(record.health & kFlagMask));
+        }
+    }
+}
@@ -0,0 +1,211 @@
+#include "concurrency_limiter.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Windowed minimum of the request latency; stands in for the no-load latency. An average
+    // would drift up to a persistently inflated latency, the minimum only follows it once a
+    // whole window passes without a fast request, so the window starts over periodically.
+    uint64_t updateBaseline(ServerOutcomeStats& stats, uint64_t sample, std::chrono::steady_clock::duration window)
+    {
+        auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+        auto windowEnd = stats.baselineWindowEnd.load(std::memory_order_relaxed);
+        if (now >= windowEnd &&
+            stats.baselineWindowEnd.compare_exchange_strong(windowEnd, now + window.count(), std::memory_order_relaxed)) {
+            stats.baselineLatencyNanos.store(sample, std::memory_order_relaxed);
+            return sample;
+        }
+
+        uint64_t current = stats.baselineLatencyNanos.load(std::memory_order_relaxed);
+        while (current == 0 || sample < current) {
+            if (stats.baselineLatencyNanos.compare_exchange_weak(current, sample, std::memory_order_relaxed)) {
+                return sample;
+            }
+        }
+        return current;
+    }
+}
+
+// Copy constructor
+ConcurrencyLimiter::ConcurrencyLimiter(const ConcurrencyLimiter& other)
+{
+    *this = other;
+}
+
+// Copy assignment
+ConcurrencyLimiter& ConcurrencyLimiter::operator=(const ConcurrencyLimiter& other)
+{
+    if (this != &other) {
+        _mode.store(other._mode.load());
+        _initialLimit.store(other._initialLimit.load());
+        _minLimit.store(other._minLimit.load());
+        _maxLimit.store(other._maxLimit.load());
+        _backoffRatio.store(other._backoffRatio.load());
+        _latencyTimeout.store(other._latencyTimeout.load());
+        _rttTolerance.store(other._rttTolerance.load());
+        _smoothing.store(other._smoothing.load());
+        _baselineWindow.store(other._baselineWindow.load());
+
+        // Limit estimates belong to the servers
+    }
+    return *this;
+}
+
+void ConcurrencyLimiter::store(Server& server, double estimate)
+{
+    double low = static_cast<double>(_minLimit.load(std::memory_order_relaxed));
+    double high = static_cast<double>(_maxLimit.load(std::memory_order_relaxed));
+    estimate = std::clamp(estimate, low, high);
+    server._outcomes.limitEstimate.store(estimate, std::memory_order_relaxed);
+
+    // Skip the store when the rounded limit is unchanged, so steady state leaves the hot line alone
+    uint32_t limit = static_cast<uint32_t>(estimate);
+    if (server._hot->concurrencyLimit.load(std::memory_order_relaxed) != limit) {
+        server._hot->concurrencyLimit.store(limit, std::memory_order_relaxed);
+    }
+}
+
+// Adapt the limit to one request outcome. Racing completions may drop each other's update;
+// an estimate only needs to follow the trend, so no CAS loop is spent on it.
+void ConcurrencyLimiter::recordOutcome(Server& server, bool success, std::chrono::nanoseconds latency)
+{
+    ConcurrencyLimitMode mode = _mode.load(std::memory_order_relaxed);
+    if (mode == ConcurrencyLimitMode::FIXED) {
+        return;
+    }
+
+    ServerOutcomeStats& stats = server._outcomes;
+    double estimate = stats.limitEstimate.load(std::memory_order_relaxed);
+    if (estimate == 0.0) {
+        // First outcome: the server starts at the initial limit whatever this one says
+        estimate = static_cast<double>(_initialLimit.load(std::memory_order_relaxed));
+        store(server, estimate);
+    }
+
+    // The finishing request still holds its slot, so this includes it
+    double inflight = static_cast<double>(server._hot->currentConnections.load(std::memory_order_relaxed));
+    uint64_t sample = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+
+    if (mode == ConcurrencyLimitMode::AIMD) {
+        auto timeout = std::chrono::milliseconds(_latencyTimeout.load(std::memory_order_relaxed));
+        bool dropped = !success || (timeout.count() > 0 && latency > timeout);
+        if (dropped) {
+            estimate *= _backoffRatio.load(std::memory_order_relaxed);
+        } else if (inflight * 2.0 >= estimate) {
+            // Grow only while the limit is actually being used
+            estimate += 1.0;
+        }
+        store(server, estimate);
+        return;
+    }
+
+    // GRADIENT: failures say nothing about queueing, and their latency would skew the averages
+    if (!success || sample == 0) {
+        return;
+    }
+
+    uint64_t recent = stats.latencyEwmaNanos.load(std::memory_order_relaxed);
+    auto window = std::chrono::milliseconds(_baselineWindow.load(std::memory_order_relaxed));
+    uint64_t baseline = updateBaseline(stats, sample, window);
+    if (recent == 0) {
+        recent = sample;
+    }
+
+    double gradient = std::clamp(_rttTolerance.load(std::memory_order_relaxed) * static_cast<double>(baseline) /
+                                 static_cast<double>(recent), 0.5, 1.0);
+    double next = estimate * gradient + std::sqrt(estimate);  // sqrt(limit) queue allowance keeps probing upwards
+    if (next > estimate && inflight * 2.0 < estimate) {
+        return; // Application limited: no evidence the server could take more
+    }
+
+    double smoothing = _smoothing.load(std::memory_order_relaxed);
+    store(server, estimate * (1.0 - smoothing) + next * smoothing);
+}
+
+// Configuration
+void ConcurrencyLimiter::setMode(ConcurrencyLimitMode mode)
+{
+    _mode.store(mode);
+}
+
+ConcurrencyLimitMode ConcurrencyLimiter::getMode() const
+{
+    return _mode.load();
+}
+
+void ConcurrencyLimiter::setInitialLimit(uint32_t limit)
+{
+    _initialLimit.store(limit > 0 ? limit : 1);
+}
+
+uint32_t ConcurrencyLimiter::getInitialLimit() const
+{
+    return _initialLimit.load();
+}
+
+void ConcurrencyLimiter::setLimitRange(uint32_t minLimit, uint32_t maxLimit)
+{
+    minLimit = (std::max)(minLimit, 1u);
+    _minLimit.store(minLimit);
+    _maxLimit.store((std::max)(maxLimit, minLimit));
+}
+
+uint32_t ConcurrencyLimiter::getMinLimit() const
+{
+    return _minLimit.load();
+}
+
+uint32_t ConcurrencyLimiter::getMaxLimit() const
+{
+    return _maxLimit.load();
+}
+
+void ConcurrencyLimiter::setBackoffRatio(double ratio)
+{
+    _backoffRatio.store(std::clamp(ratio, 0.5, 0.99));
+}
+
+double ConcurrencyLimiter::getBackoffRatio() const
+{
+    return _backoffRatio.load();
+}
+
+void ConcurrencyLimiter::setLatencyTimeout(std::chrono::milliseconds timeout)
+{
+    _latencyTimeout.store((std::max)(timeout.count(), std::chrono::milliseconds::rep(0)));
+}
+
+std::chrono::milliseconds ConcurrencyLimiter::getLatencyTimeout() const
+{
+    return std::chrono::milliseconds(_latencyTimeout.load());
+}
+
+void ConcurrencyLimiter::setRttTolerance(double tolerance)
+{
+    _rttTolerance.store((std::max)(tolerance, 1.0));
+}
+
+double ConcurrencyLimiter::getRttTolerance() const
+{
+    return _rttTolerance.load();
+}
+
+void ConcurrencyLimiter::setSmoothing(double smoothing)
+{
+    _smoothing.store(std::clamp(smoothing, 0.01, 1.0));
+}
+
+double ConcurrencyLimiter::getSmoothing() const
+{
+    return _smoothing.load();
+}
+
+void ConcurrencyLimiter::setBaselineWindow(std::chrono::milliseconds window)
+{
+    _baselineWindow.store((std::max)(window.count(), std::chrono::milliseconds::rep(1)));
+}
+
+std::chrono::milliseconds ConcurrencyLimiter::getBaselineWindow() const
+{
+    return std::chrono::milliseconds(_baselineWindow.load());
+}
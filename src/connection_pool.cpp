@@ -0,0 +1,408 @@
+#include "connection_pool.hpp"
+#include <algorithm>
+
+// Platform-specific includes
+#ifdef _WIN32
+    #define close closesocket
+#else
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <errno.h>
+#endif
+
+namespace {
+    // Non-blocking, close-on-exec TCP socket with keepalive and no Nagle delay
+    int openSocket(int family)
+    {
+        #ifdef _WIN32
+            int sock = static_cast<int>(::socket(family, SOCK_STREAM, 0));
+            if (sock >= 0) {
+                u_long mode = 1;
+                ioctlsocket(sock, FIONBIO, &mode);
+            }
+        #elif defined(__linux__)
+            int sock = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        #else
+            int sock = ::socket(family, SOCK_STREAM, 0);
+            if (sock >= 0) {
+                fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+                fcntl(sock, F_SETFD, FD_CLOEXEC);
+            }
+        #endif
+
+        if (sock >= 0) {
+            int on = 1;
+            setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char*>(&on), sizeof(on));
+            setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on));
+        }
+        return sock;
+    }
+
+    bool wouldBlock()
+    {
+        #ifdef _WIN32
+            int error = WSAGetLastError();
+            return error == WSAEWOULDBLOCK || error == WSAEINPROGRESS;
+        #else
+            return errno == EINPROGRESS || errno == EAGAIN || errno == EWOULDBLOCK;
+        #endif
+    }
+
+    // Wait for a connect in progress to finish
+    bool awaitConnected(int sock, std::chrono::milliseconds timeout)
+    {
+        #ifdef _WIN32
+            WSAPOLLFD descriptor{};
+            descriptor.fd = static_cast<SOCKET>(sock);
+            descriptor.events = POLLOUT;
+            if (WSAPoll(&descriptor, 1, static_cast<int>(timeout.count())) <= 0) {
+                return false;
+            }
+        #else
+            pollfd descriptor{};
+            descriptor.fd = sock;
+            descriptor.events = POLLOUT;
+            if (::poll(&descriptor, 1, static_cast<int>(timeout.count())) <= 0) {
+                return false;
+            }
+        #endif
+
+        int error = 0;
+        socklen_t len = sizeof(error);
+        if (getsockopt(sock, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &len) != 0) {
+            return false;
+        }
+        return error == 0;
+    }
+}
+
+// PooledConnection implementation
+
+// Constructor
+PooledConnection::PooledConnection(ConnectionPool* pool, int fd, uint32_t generation, bool reused) noexcept
+    : _pool(pool),
+      _fd(fd),
+      _generation(generation),
+      _reused(reused)
+{
+}
+
+// Destructor
+PooledConnection::~PooledConnection()
+{
+    release();
+}
+
+// Move constructor
+PooledConnection::PooledConnection(PooledConnection&& other) noexcept
+    : _pool(other._pool),
+      _fd(other._fd),
+      _generation(other._generation),
+      _reused(other._reused),
+      _broken(other._broken)
+{
+    other._pool = nullptr;
+    other._fd = -1;
+}
+
+// Move assignment
+PooledConnection& PooledConnection::operator=(PooledConnection&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        _pool = other._pool;
+        _fd = other._fd;
+        _generation = other._generation;
+        _reused = other._reused;
+        _broken = other._broken;
+        other._pool = nullptr;
+        other._fd = -1;
+    }
+    return *this;
+}
+
+// Access
+int PooledConnection::fd() const noexcept
+{
+    return _fd;
+}
+
+bool PooledConnection::reused() const noexcept
+{
+    return _reused;
+}
+
+PooledConnection::operator bool() const noexcept
+{
+    return _fd >= 0;
+}
+
+void PooledConnection::markBroken() noexcept
+{
+    _broken = true;
+}
+
+void PooledConnection::release() noexcept
+{
+    if (_pool && _fd >= 0) {
+        _pool->giveBack(_fd, _generation, _broken);
+    }
+    _pool = nullptr;
+    _fd = -1;
+    _broken = false;
+}
+
+// ConnectionPool implementation
+
+// Constructor
+ConnectionPool::ConnectionPool()
+{
+    #ifdef _WIN32
+        WSADATA wsaData;
+        WSAStartup(MAKEWORD(2, 2), &wsaData);
+    #endif
+}
+
+// Destructor
+ConnectionPool::~ConnectionPool()
+{
+    for (const auto& idle : _idle) {
+        closeSocket(idle.fd);
+    }
+
+    #ifdef _WIN32
+        WSACleanup();
+    #endif
+}
+
+void ConnectionPool::closeSocket(int fd)
+{
+    close(fd);
+}
+
+// Nothing to read on an idle keepalive socket: data or EOF both mean it cannot be reused
+bool ConnectionPool::isLive(int fd)
+{
+    char byte;
+    auto received = ::recv(fd, &byte, 1, MSG_PEEK);
+    return received < 0 && wouldBlock();
+}
+
+void ConnectionPool::useEndpointLocked(const ServerEndpoint& endpoint, std::vector<int>& toClose)
+{
+    if (_endpoint.length != 0 && _endpoint.sameAddress(endpoint)) {
+        return;
+    }
+
+    for (const auto& idle : _idle) {
+        toClose.push_back(idle.fd);
+    }
+    _closedIdle.fetch_add(_idle.size(), std::memory_order_relaxed);
+    _idle.clear();
+    _endpoint = endpoint;
+    ++_generation;
+}
+
+int ConnectionPool::connect(const ServerEndpoint& endpoint)
+{
+    int sock = endpoint.length != 0 ? openSocket(endpoint.address.ss_family) : -1;
+    if (sock < 0) {
+        _connectFailures.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+
+    int result = ::connect(sock, reinterpret_cast<const sockaddr*>(&endpoint.address), endpoint.length);
+    if (result != 0 && !(wouldBlock() && awaitConnected(sock, getConnectTimeout()))) {
+        closeSocket(sock);
+        _connectFailures.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+
+    _connects.fetch_add(1, std::memory_order_relaxed);
+    return sock;
+}
+
+void ConnectionPool::giveBack(int fd, uint32_t generation, bool broken) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!broken && generation == _generation && _idle.size() < _maxIdle.load(std::memory_order_relaxed)) {
+            _idle.push_back({fd, Clock::now()});
+            return;
+        }
+    }
+
+    (broken ? _closedDead : _closedIdle).fetch_add(1, std::memory_order_relaxed);
+    closeSocket(fd);
+}
+
+// Live idle connection, or a new one
+int ConnectionPool::takeIdle(const ServerEndpoint& endpoint, uint32_t& generation)
+{
+    std::vector<int> toClose;
+    int fd = -1;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        useEndpointLocked(endpoint, toClose);
+        generation = _generation;
+
+        // Warmest first; dead ones found on the way are dropped
+        while (!_idle.empty()) {
+            IdleConnection idle = _idle.back();
+            _idle.pop_back();
+            if (isLive(idle.fd)) {
+                fd = idle.fd;
+                break;
+            }
+            toClose.push_back(idle.fd);
+            _closedDead.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    for (int dead : toClose) {
+        closeSocket(dead);
+    }
+
+    if (fd >= 0) {
+        _reuses.fetch_add(1, std::memory_order_relaxed);
+    }
+    return fd;
+}
+
+PooledConnection ConnectionPool::acquire(const ServerEndpoint& endpoint)
+{
+    uint32_t generation;
+    int fd = takeIdle(endpoint, generation);
+    if (fd >= 0) {
+        return PooledConnection(this, fd, generation, true);
+    }
+
+    fd = connect(endpoint);
+    return fd >= 0 ? PooledConnection(this, fd, generation, false) : PooledConnection();
+}
+
+PooledConnection ConnectionPool::tryAcquire(const ServerEndpoint& endpoint)
+{
+    uint32_t generation;
+    int fd = takeIdle(endpoint, generation);
+    return fd >= 0 ? PooledConnection(this, fd, generation, true) : PooledConnection();
+}
+
+// Connect until targetIdle sockets are idle
+size_t ConnectionPool::prewarm(const ServerEndpoint& endpoint)
+{
+    std::vector<int> toClose;
+    size_t missing;
+    uint32_t generation;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        useEndpointLocked(endpoint, toClose);
+        size_t target = (std::min)(_targetIdle.load(std::memory_order_relaxed), _maxIdle.load(std::memory_order_relaxed));
+        missing = target > _idle.size() ? target - _idle.size() : 0;
+        generation = _generation;
+    }
+    for (int fd : toClose) {
+        closeSocket(fd);
+    }
+
+    size_t opened = 0;
+    for (; opened < missing; ++opened) {
+        int fd = connect(endpoint);
+        if (fd < 0) {
+            break; // Backend refuses; the next round tries again
+        }
+        giveBack(fd, generation, false);
+    }
+    return opened;
+}
+
+// Close idle sockets that died, expired or point at an old endpoint
+size_t ConnectionPool::maintain(const ServerEndpoint& endpoint, Clock::time_point now)
+{
+    std::vector<int> toClose;
+    size_t live;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        useEndpointLocked(endpoint, toClose);
+
+        auto idleTimeout = getIdleTimeout();
+        auto kept = std::remove_if(_idle.begin(), _idle.end(), [&](const IdleConnection& idle) {
+            bool expired = now - idle.idleSince > idleTimeout;
+            bool dead = !expired && !isLive(idle.fd);
+            if (expired || dead) {
+                toClose.push_back(idle.fd);
+                (expired ? _closedIdle : _closedDead).fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        });
+        _idle.erase(kept, _idle.end());
+        live = _idle.size();
+    }
+
+    for (int fd : toClose) {
+        closeSocket(fd);
+    }
+    return live;
+}
+
+size_t ConnectionPool::idleCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _idle.size();
+}
+
+ConnectionPool::Stats ConnectionPool::getStats() const
+{
+    Stats stats;
+    stats.connects = _connects.load(std::memory_order_relaxed);
+    stats.connectFailures = _connectFailures.load(std::memory_order_relaxed);
+    stats.reuses = _reuses.load(std::memory_order_relaxed);
+    stats.closedIdle = _closedIdle.load(std::memory_order_relaxed);
+    stats.closedDead = _closedDead.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Configuration
+void ConnectionPool::setMaxIdle(size_t count)
+{
+    _maxIdle.store(count, std::memory_order_relaxed);
+}
+
+size_t ConnectionPool::getMaxIdle() const
+{
+    return _maxIdle.load(std::memory_order_relaxed);
+}
+
+void ConnectionPool::setTargetIdle(size_t count)
+{
+    _targetIdle.store(count, std::memory_order_relaxed);
+}
+
+size_t ConnectionPool::getTargetIdle() const
+{
+    return _targetIdle.load(std::memory_order_relaxed);
+}
+
+void ConnectionPool::setIdleTimeout(std::chrono::milliseconds timeout)
+{
+    _idleTimeout.store(timeout.count(), std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds ConnectionPool::getIdleTimeout() const
+{
+    return std::chrono::milliseconds(_idleTimeout.load(std::memory_order_relaxed));
+}
+
+void ConnectionPool::setConnectTimeout(std::chrono::milliseconds timeout)
+{
+    _connectTimeout.store((std::max)(timeout.count(), std::chrono::milliseconds::rep(1)), std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds ConnectionPool::getConnectTimeout() const
+{
+    return std::chrono::milliseconds(_connectTimeout.load(std::memory_order_relaxed));
+}
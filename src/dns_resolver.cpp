@@ -0,0 +1,308 @@
+#include "dns_resolver.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+// Platform-specific includes
+#ifndef _WIN32
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <netdb.h>
+#endif
+
+// Constructor
+DnsResolver::DnsResolver(std::chrono::seconds ttl, size_t workerCount)
+    : _ttl(ttl)
+{
+    size_t count = (std::max)(workerCount, size_t(1));
+    _workers.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        _workers.emplace_back(&DnsResolver::workerLoop, this);
+    }
+}
+
+// Destructor
+DnsResolver::~DnsResolver()
+{
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _stopping = true;
+    }
+    _queueReady.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+DnsResolver::Shard& DnsResolver::shardFor(const std::string& host)
+{
+    return _shards[std::hash<std::string>{}(host) & (kShardCount - 1)];
+}
+
+DnsResolver::RecordsPtr DnsResolver::parseLiteral(const std::string& host)
+{
+    ResolvedAddress record;
+
+    auto* ipv4 = reinterpret_cast<sockaddr_in*>(&record.address);
+    if (inet_pton(AF_INET, host.c_str(), &ipv4->sin_addr) == 1) {
+        ipv4->sin_family = AF_INET;
+        record.length = sizeof(sockaddr_in);
+        return std::make_shared<const Records>(1, record);
+    }
+
+    auto* ipv6 = reinterpret_cast<sockaddr_in6*>(&record.address);
+    if (inet_pton(AF_INET6, host.c_str(), &ipv6->sin6_addr) == 1) {
+        ipv6->sin6_family = AF_INET6;
+        record.length = sizeof(sockaddr_in6);
+        return std::make_shared<const Records>(1, record);
+    }
+
+    return nullptr;
+}
+
+void DnsResolver::scheduleLocked(const std::string& host, Entry& entry)
+{
+    if (entry.refreshing) {
+        return; // Coalesce with the resolution already underway
+    }
+
+    entry.refreshing = true;
+    if (!entry.records && !entry.pending) {
+        entry.pending = std::make_shared<Pending>();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _queue.push_back(host);
+    }
+    _queueReady.notify_one();
+}
+
+// Lookup
+DnsResolver::RecordsPtr DnsResolver::resolve(const std::string& host, std::chrono::milliseconds wait, Clock::time_point* refreshAt)
+{
+    if (RecordsPtr literal = parseLiteral(host)) {
+        if (refreshAt) {
+            *refreshAt = Clock::time_point::max();
+        }
+        return literal;
+    }
+
+    Shard& shard = shardFor(host);
+    auto now = Clock::now();
+
+    // Hand out the entry's records, treating a remembered failure as nothing known
+    auto answer = [refreshAt](const Entry& entry) -> RecordsPtr {
+        if (refreshAt) {
+            *refreshAt = entry.refreshAt;
+        }
+        return entry.records && !entry.records->empty() ? entry.records : nullptr;
+    };
+
+    // Fast path: fresh records under the shared lock
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(host);
+        if (it != shard.entries.end() && it->second.records && now < it->second.refreshAt) {
+            RecordsPtr records = answer(it->second);
+            (records ? _hits : _misses).add();
+            return records;
+        }
+    }
+
+    std::shared_ptr<Pending> pending;
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        Entry& entry = shard.entries[host];
+
+        if (!entry.records || now >= entry.refreshAt) {
+            scheduleLocked(host, entry);
+        }
+
+        // Stale records are served while the refresh runs
+        if (entry.records) {
+            RecordsPtr records = answer(entry);
+            if (records) {
+                _hits.add();
+                if (now >= entry.refreshAt) {
+                    _staleHits.add();
+                }
+            } else {
+                _misses.add();
+            }
+            return records;
+        }
+        pending = entry.pending;
+    }
+
+    // First lookup of this name: wait for the shared resolution
+    _misses.add();
+    if (pending) {
+        std::unique_lock<std::mutex> lock(pending->mutex);
+        pending->done.wait_for(lock, wait, [&pending]() { return pending->finished; });
+    }
+
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.entries.find(host);
+    return it != shard.entries.end() ? answer(it->second) : nullptr;
+}
+
+void DnsResolver::prefetch(const std::string& host)
+{
+    if (parseLiteral(host)) {
+        return;
+    }
+
+    Shard& shard = shardFor(host);
+    auto now = Clock::now();
+
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(host);
+        if (it != shard.entries.end() && (it->second.refreshing || (it->second.records && now < it->second.refreshAt))) {
+            return;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    Entry& entry = shard.entries[host];
+    if (!entry.records || now >= entry.refreshAt) {
+        scheduleLocked(host, entry);
+    }
+}
+
+// Background resolution
+void DnsResolver::workerLoop()
+{
+    while (true) {
+        std::string host;
+        {
+            std::unique_lock<std::mutex> lock(_queueMutex);
+            _queueReady.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+            if (_stopping) {
+                return;
+            }
+            host = std::move(_queue.front());
+            _queue.pop_front();
+        }
+
+        resolveNow(host);
+    }
+}
+
+void DnsResolver::resolveNow(const std::string& host)
+{
+    auto records = std::make_shared<Records>();
+
+    struct addrinfo hints, *result = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) == 0) {
+        for (struct addrinfo* info = result; info; info = info->ai_next) {
+            if ((info->ai_family != AF_INET && info->ai_family != AF_INET6) ||
+                info->ai_addrlen > sizeof(sockaddr_storage)) {
+                continue;
+            }
+
+            ResolvedAddress record;
+            memcpy(&record.address, info->ai_addr, info->ai_addrlen);
+            record.length = static_cast<socklen_t>(info->ai_addrlen);
+
+            // getaddrinfo() can repeat an address once per protocol
+            bool duplicate = std::any_of(records->begin(), records->end(), [&record](const ResolvedAddress& existing) {
+                return existing.length == record.length && memcmp(&existing.address, &record.address, record.length) == 0;
+            });
+            if (!duplicate) {
+                records->push_back(record);
+            }
+        }
+        freeaddrinfo(result);
+    }
+
+    std::chrono::seconds ttl;
+    double refreshFraction;
+    {
+        std::lock_guard<std::mutex> lock(_configMutex);
+        ttl = _ttl;
+        refreshFraction = _refreshFraction;
+    }
+
+    std::shared_ptr<Pending> pending;
+    {
+        Shard& shard = shardFor(host);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        Entry& entry = shard.entries[host];
+        auto now = Clock::now();
+
+        if (!records->empty()) {
+            entry.records = std::move(records);
+            entry.refreshAt = now + std::chrono::duration_cast<Clock::duration>(ttl * refreshFraction);
+        } else {
+            // Keep any previous records and retry later; remember the failure otherwise
+            if (!entry.records) {
+                entry.records = std::make_shared<const Records>();
+            }
+            entry.refreshAt = now + (std::min)(ttl, std::chrono::seconds(kNegativeTTL));
+        }
+
+        entry.refreshing = false;
+        pending = std::move(entry.pending);
+    }
+
+    if (pending) {
+        {
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            pending->finished = true;
+        }
+        pending->done.notify_all();
+    }
+}
+
+// Configuration
+void DnsResolver::setTTL(std::chrono::seconds ttl)
+{
+    std::lock_guard<std::mutex> lock(_configMutex);
+    _ttl = ttl;
+}
+
+std::chrono::seconds DnsResolver::getTTL() const
+{
+    std::lock_guard<std::mutex> lock(_configMutex);
+    return _ttl;
+}
+
+void DnsResolver::setRefreshFraction(double fraction)
+{
+    std::lock_guard<std::mutex> lock(_configMutex);
+    _refreshFraction = std::clamp(fraction, 0.0, 1.0);
+}
+
+double DnsResolver::getRefreshFraction() const
+{
+    std::lock_guard<std::mutex> lock(_configMutex);
+    return _refreshFraction;
+}
+
+// Drop cached names; entries with a resolution underway stay so their waiters are woken
+void DnsResolver::clear()
+{
+    for (auto& shard : _shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        std::erase_if(shard.entries, [](const auto& item) {
+            return !item.second.refreshing;
+        });
+    }
+}
+
+// Statistics
+DnsResolver::Stats DnsResolver::getStats() const
+{
+    Stats stats;
+    stats.hits = _hits.value();
+    stats.staleHits = _staleHits.value();
+    stats.misses = _misses.value();
+    return stats;
+}
@@ -0,0 +1,159 @@
+#include "epoch_domain.hpp"
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+// Owns the calling thread's slot and hands it back when the thread exits
+struct EpochDomain::SlotHandle {
+    size_t index;
+
+    SlotHandle() : index(EpochDomain::instance().acquireSlot()) {}
+    ~SlotHandle() { EpochDomain::instance().releaseSlot(index); }
+};
+
+// Guard implementation
+EpochDomain::Guard::Guard()
+    : _slot(&EpochDomain::instance().localSlot())
+{
+    if (_slot->nesting++ == 0) {
+        // Announce the epoch before loading any protected pointer (store-load ordering)
+        _slot->epoch.store(EpochDomain::instance()._globalEpoch.load(std::memory_order_relaxed),
+                           std::memory_order_seq_cst);
+    }
+}
+
+EpochDomain::Guard::~Guard()
+{
+    if (--_slot->nesting == 0) {
+        _slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+// Process-wide domain, intentionally leaked so late-exiting threads never see it destroyed
+EpochDomain& EpochDomain::instance()
+{
+    static EpochDomain* domain = new EpochDomain();
+    return *domain;
+}
+
+size_t EpochDomain::currentThreadIndex()
+{
+    EpochDomain& domain = instance();
+    return static_cast<size_t>(&domain.localSlot() - domain._slots);
+}
+
+// Thread slot management
+EpochDomain::ThreadSlot& EpochDomain::localSlot()
+{
+    thread_local SlotHandle handle;
+    return _slots[handle.index];
+}
+
+size_t EpochDomain::acquireSlot()
+{
+    std::lock_guard<std::mutex> lock(_slotMutex);
+
+    size_t highWater = _slotHighWater.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < highWater; ++i) {
+        if (!_slots[i].inUse.load(std::memory_order_relaxed)) {
+            _slots[i].inUse.store(true, std::memory_order_relaxed);
+            return i;
+        }
+    }
+
+    if (highWater >= kMaxThreads) {
+        throw std::runtime_error("EpochDomain: thread slots exhausted");
+    }
+
+    _slots[highWater].inUse.store(true, std::memory_order_relaxed);
+    _slotHighWater.store(highWater + 1, std::memory_order_release);
+    return highWater;
+}
+
+void EpochDomain::releaseSlot(size_t index)
+{
+    std::lock_guard<std::mutex> lock(_slotMutex);
+    _slots[index].epoch.store(0, std::memory_order_release);
+    _slots[index].nesting = 0;
+    _slots[index].inUse.store(false, std::memory_order_relaxed);
+}
+
+// Reclamation
+uint64_t EpochDomain::minActiveEpoch() const
+{
+    uint64_t minEpoch = std::numeric_limits<uint64_t>::max();
+    size_t highWater = _slotHighWater.load(std::memory_order_acquire);
+
+    for (size_t i = 0; i < highWater; ++i) {
+        uint64_t epoch = _slots[i].epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0 && epoch < minEpoch) {
+            minEpoch = epoch;
+        }
+    }
+
+    return minEpoch;
+}
+
+std::vector<std::function<void()>> EpochDomain::collectLocked(uint64_t safeEpoch)
+{
+    std::vector<std::function<void()>> ready;
+
+    auto it = _retired.begin();
+    while (it != _retired.end()) {
+        if (it->epoch <= safeEpoch) {
+            ready.push_back(std::move(it->reclaimer));
+            it = _retired.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return ready;
+}
+
+void EpochDomain::retire(std::function<void()> reclaimer)
+{
+    if (!reclaimer) {
+        return;
+    }
+
+    // Readers that entered before this bump may still hold the old version
+    uint64_t epoch = _globalEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(_retireMutex);
+        _retired.push_back({epoch, std::move(reclaimer)});
+        ready = collectLocked(minActiveEpoch());
+    }
+
+    // Run reclaimers outside the lock so they may retire further entries
+    for (auto& fn : ready) {
+        fn();
+    }
+}
+
+void EpochDomain::synchronize()
+{
+    uint64_t target = _globalEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+    while (minActiveEpoch() < target) {
+        std::this_thread::yield();
+    }
+
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(_retireMutex);
+        ready = collectLocked(target);
+    }
+
+    for (auto& fn : ready) {
+        fn();
+    }
+}
+
+size_t EpochDomain::pendingCount() const
+{
+    std::lock_guard<std::mutex> lock(_retireMutex);
+    return _retired.size();
+}
@@ -0,0 +1,175 @@
+#include "health_check_scheduler.hpp"
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <string>
+
+namespace {
+    // splitmix64 finalizer, spreads std::hash output over the interval
+    uint64_t mix64(uint64_t value)
+    {
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ULL;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBULL;
+        value ^= value >> 31;
+        return value;
+    }
+}
+
+// Constructor
+HealthCheckScheduler::HealthCheckScheduler(
+    std::chrono::milliseconds baseInterval,
+    double jitterFraction,
+    uint32_t maxBackoffMultiplier
+) : _baseInterval((std::max)(baseInterval, std::chrono::milliseconds(1))),
+    _jitterFraction(std::clamp(jitterFraction, 0.0, 0.5)),
+    _maxBackoffMultiplier((std::max)(maxBackoffMultiplier, 1u)),
+    _offsetSalt(std::random_device{}()),
+    _earliestDue(Clock::now()),
+    _random(std::random_device{}())
+{
+}
+
+std::chrono::milliseconds HealthCheckScheduler::granularity() const
+{
+    return (std::max)(_baseInterval / 100, std::chrono::milliseconds(10));
+}
+
+std::chrono::milliseconds HealthCheckScheduler::adaptiveInterval(const Entry& entry) const
+{
+    // Count state changes between adjacent results in the history
+    if (entry.samples >= 2) {
+        uint32_t pairMask = (1u << (entry.samples - 1)) - 1;
+        uint32_t transitions = static_cast<uint32_t>(std::popcount((entry.history ^ (entry.history >> 1)) & pairMask));
+        if (transitions >= kFlapTransitions) {
+            return (std::max)(_baseInterval / 2, granularity());
+        }
+    }
+
+    // Back off exponentially after the first failure, up to the cap
+    if (entry.consecutiveFailures > 1) {
+        uint32_t shift = (std::min)(entry.consecutiveFailures - 1, 31u);
+        uint64_t multiplier = (std::min)(uint64_t(1) << shift, static_cast<uint64_t>(_maxBackoffMultiplier));
+        return _baseInterval * static_cast<int64_t>(multiplier);
+    }
+
+    return _baseInterval;
+}
+
+HealthCheckScheduler::Clock::duration HealthCheckScheduler::jittered(std::chrono::milliseconds interval)
+{
+    std::uniform_real_distribution<double> spread(-_jitterFraction, _jitterFraction);
+    auto base = std::chrono::duration_cast<Clock::duration>(interval);
+    return base + std::chrono::duration_cast<Clock::duration>(base * spread(_random));
+}
+
+// Servers due for a probe
+std::vector<std::shared_ptr<Server>> HealthCheckScheduler::collectDue(const std::vector<std::shared_ptr<Server>>& servers, Clock::time_point now)
+{
+    std::vector<std::shared_ptr<Server>> due;
+    Clock::time_point earliest = now + _baseInterval;
+    ++_pass;
+
+    for (const auto& server : servers) {
+        auto [it, inserted] = _entries.try_emplace(server.get());
+        Entry& entry = it->second;
+
+        if (inserted) {
+            // First probe at a stable, hashed position within the interval
+            uint64_t hash = mix64(std::hash<std::string>{}(server->getServerAddress()) ^ _offsetSalt);
+            entry.interval = _baseInterval;
+            entry.nextDue = now + std::chrono::milliseconds(hash % static_cast<uint64_t>(_baseInterval.count()));
+        }
+        entry.seenPass = _pass;
+
+        if (entry.nextDue <= now) {
+            // Provisional, recordResults() replaces it once the probe has run
+            entry.nextDue = now + entry.interval;
+            due.push_back(server);
+        } else {
+            earliest = (std::min)(earliest, entry.nextDue);
+        }
+    }
+
+    // Forget servers that left the list
+    std::erase_if(_entries, [this](const auto& item) {
+        return item.second.seenPass != _pass;
+    });
+
+    _earliestDue = earliest;
+    return due;
+}
+
+// Schedule the next probe from each result
+void HealthCheckScheduler::recordResults(const std::vector<std::shared_ptr<Server>>& probed, Clock::time_point now)
+{
+    for (const auto& server : probed) {
+        auto it = _entries.find(server.get());
+        if (it == _entries.end()) {
+            continue;
+        }
+
+        Entry& entry = it->second;
+        bool healthy = server->isHealthy();
+
+        entry.history = static_cast<uint8_t>((entry.history << 1) | (healthy ? 1 : 0));
+        entry.samples = static_cast<uint8_t>((std::min)(entry.samples + 1, 8));
+        entry.consecutiveFailures = healthy ? 0 : entry.consecutiveFailures + 1;
+        entry.interval = adaptiveInterval(entry);
+        entry.nextDue = now + jittered(entry.interval);
+
+        _earliestDue = (std::min)(_earliestDue, entry.nextDue);
+    }
+}
+
+HealthCheckScheduler::Clock::time_point HealthCheckScheduler::nextWakeup(Clock::time_point now) const
+{
+    return std::clamp(_earliestDue, now + granularity(), now + _baseInterval);
+}
+
+// Configuration
+void HealthCheckScheduler::setBaseInterval(std::chrono::milliseconds interval)
+{
+    interval = (std::max)(interval, std::chrono::milliseconds(1));
+    if (interval == _baseInterval) {
+        return;
+    }
+
+    // Pending probes keep their due time, the new interval applies from each server's next probe
+    _baseInterval = interval;
+    for (auto& [server, entry] : _entries) {
+        entry.interval = adaptiveInterval(entry);
+    }
+}
+
+std::chrono::milliseconds HealthCheckScheduler::getBaseInterval() const
+{
+    return _baseInterval;
+}
+
+void HealthCheckScheduler::setJitterFraction(double fraction)
+{
+    _jitterFraction = std::clamp(fraction, 0.0, 0.5);
+}
+
+double HealthCheckScheduler::getJitterFraction() const
+{
+    return _jitterFraction;
+}
+
+void HealthCheckScheduler::setMaxBackoffMultiplier(uint32_t multiplier)
+{
+    _maxBackoffMultiplier = (std::max)(multiplier, 1u);
+}
+
+uint32_t HealthCheckScheduler::getMaxBackoffMultiplier() const
+{
+    return _maxBackoffMultiplier;
+}
+
+std::chrono::milliseconds HealthCheckScheduler::getServerInterval(const Server& server) const
+{
+    auto it = _entries.find(&server);
+    return it != _entries.end() ? it->second.interval : _baseInterval;
+}
@@ -0,0 +1,317 @@
+#include "health_snapshot.hpp"
+#include "ip_hash_load_balancer.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// Platform-specific includes
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <netinet/in.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+static_assert(sizeof(HealthSnapshot::Header) == 48, "Snapshot header layout changed");
+static_assert(sizeof(HealthSnapshot::Record) == 64, "Snapshot record layout changed");
+static_assert(std::endian::native == std::endian::little, "Snapshot files are little-endian");
+
+namespace {
+    uint64_t checksumOf(const uint8_t* data, size_t size)
+    {
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= data[i];
+            hash *= 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    uint64_t addressHash(const std::string& serverAddress)
+    {
+        return IpHashEngine::hashKey(serverAddress);
+    }
+
+    void storeEndpoint(const ServerEndpoint& endpoint, HealthSnapshot::Record& record)
+    {
+        if (endpoint.address.ss_family == AF_INET) {
+            const auto& address = reinterpret_cast<const sockaddr_in&>(endpoint.address);
+            record.endpointFamily = 4;
+            record.endpointPort = ntohs(address.sin_port);
+            std::memcpy(record.endpointAddress, &address.sin_addr, sizeof(address.sin_addr));
+        } else if (endpoint.address.ss_family == AF_INET6) {
+            const auto& address = reinterpret_cast<const sockaddr_in6&>(endpoint.address);
+            record.endpointFamily = 6;
+            record.endpointPort = ntohs(address.sin6_port);
+            std::memcpy(record.endpointAddress, &address.sin6_addr, sizeof(address.sin6_addr));
+            record.endpointScope = address.sin6_scope_id;
+        }
+    }
+
+    bool loadEndpoint(const HealthSnapshot::Record& record, ServerEndpoint& endpoint)
+    {
+        endpoint = ServerEndpoint{};
+        if (record.endpointFamily == 4) {
+            auto& address = reinterpret_cast<sockaddr_in&>(endpoint.address);
+            address.sin_family = AF_INET;
+            address.sin_port = htons(record.endpointPort);
+            std::memcpy(&address.sin_addr, record.endpointAddress, sizeof(address.sin_addr));
+            endpoint.length = sizeof(sockaddr_in);
+            return true;
+        }
+        if (record.endpointFamily == 6) {
+            auto& address = reinterpret_cast<sockaddr_in6&>(endpoint.address);
+            address.sin6_family = AF_INET6;
+            address.sin6_port = htons(record.endpointPort);
+            std::memcpy(&address.sin6_addr, record.endpointAddress, sizeof(address.sin6_addr));
+            address.sin6_scope_id = record.endpointScope;
+            endpoint.length = sizeof(sockaddr_in6);
+            return true;
+        }
+        return false;
+    }
+}
+
+// Destructor
+HealthSnapshot::~HealthSnapshot()
+{
+    close();
+}
+
+void HealthSnapshot::close()
+{
+    #ifndef _WIN32
+        if (_mapped) {
+            munmap(const_cast<uint8_t*>(_data), _size);
+        }
+    #endif
+    _data = nullptr;
+    _size = 0;
+    _mapped = false;
+    _buffer.clear();
+}
+
+const HealthSnapshot::Header& HealthSnapshot::header() const
+{
+    return *reinterpret_cast<const Header*>(_data);
+}
+
+const HealthSnapshot::Record* HealthSnapshot::records() const
+{
+    return reinterpret_cast<const Record*>(_data + sizeof(Header));
+}
+
+const char* HealthSnapshot::strings() const
+{
+    return reinterpret_cast<const char*>(records() + header().recordCount);
+}
+
+// Write the servers' state to `path`
+bool HealthSnapshot::save(const std::string& path, const std::vector<std::shared_ptr<Server>>& servers)
+{
+    std::vector<Record> records;
+    records.reserve(servers.size());
+    std::string strings;
+
+    for (const auto& server : servers) {
+        const std::string& address = server->getServerAddress();
+        const ServerHotState& hot = server->hotState();
+        const ServerOutcomeStats& outcomes = server->getOutcomeStats();
+
+        Record record{};
+        record.addressHash = addressHash(address);
+        record.addressOffset = static_cast<uint32_t>(strings.size());
+        record.addressLength = static_cast<uint32_t>(address.size());
+        record.flags = hot.flags.load(std::memory_order_relaxed) & ServerHotState::kAvailable;
+        record.weight = hot.weight.load(std::memory_order_relaxed);
+        record.latencyEwmaNanos = outcomes.latencyEwmaNanos.load(std::memory_order_relaxed);
+        record.peakLatencyMicros = static_cast<float>(hot.peakLatencyMicros(std::chrono::steady_clock::now()));
+
+        ServerEndpoint endpoint;
+        if (server->getEndpoint(endpoint)) {
+            storeEndpoint(endpoint, record);
+        }
+
+        records.push_back(record);
+        strings += address;
+    }
+
+    std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        return a.addressHash < b.addressHash;
+    });
+
+    Header header{};
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.recordSize = sizeof(Record);
+    header.recordCount = records.size();
+    header.stringBytes = strings.size();
+    header.writtenAtMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::vector<uint8_t> body(records.size() * sizeof(Record) + strings.size());
+    if (!records.empty()) {
+        std::memcpy(body.data(), records.data(), records.size() * sizeof(Record));
+    }
+    if (!strings.empty()) {
+        std::memcpy(body.data() + records.size() * sizeof(Record), strings.data(), strings.size());
+    }
+    header.checksum = checksumOf(body.data(), body.size());
+
+    // Temporary file, then rename over the previous snapshot
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size()));
+        out.flush();
+        if (!out) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+    #ifdef _WIN32
+        bool renamed = MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+    #else
+        bool renamed = std::rename(temporary.c_str(), path.c_str()) == 0;
+    #endif
+    if (!renamed) {
+        std::remove(temporary.c_str());
+    }
+    return renamed;
+}
+
+// Map and validate a snapshot
+bool HealthSnapshot::open(const std::string& path, std::chrono::seconds maxAge)
+{
+    close();
+
+    #ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+            ::close(fd);
+            return false;
+        }
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        _data = static_cast<const uint8_t*>(mapping);
+        _size = static_cast<size_t>(info.st_size);
+        _mapped = true;
+    #else
+        std::ifstream in(path, std::ios::binary);
+        _buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (_buffer.size() < sizeof(Header)) {
+            close();
+            return false;
+        }
+        _data = _buffer.data();
+        _size = _buffer.size();
+    #endif
+
+    // Layout, size and checksum must all match before any record is trusted
+    const Header& head = header();
+    bool valid = head.magic == kMagic &&
+                 head.version == kVersion &&
+                 head.recordSize == sizeof(Record) &&
+                 head.recordCount <= (_size - sizeof(Header)) / sizeof(Record) &&
+                 head.stringBytes == _size - sizeof(Header) - head.recordCount * sizeof(Record) &&
+                 head.checksum == checksumOf(_data + sizeof(Header), _size - sizeof(Header));
+
+    if (valid) {
+        auto age = std::chrono::system_clock::now() - writtenAt();
+        valid = age <= maxAge;
+    }
+
+    if (valid) {
+        for (size_t i = 0; i < head.recordCount; ++i) {
+            const Record& record = records()[i];
+            if (uint64_t{record.addressOffset} + record.addressLength > head.stringBytes ||
+                (i != 0 && records()[i - 1].addressHash > record.addressHash)) {
+                valid = false;
+                break;
+            }
+        }
+    }
+
+    if (!valid) {
+        close();
+    }
+    return valid;
+}
+
+bool HealthSnapshot::isOpen() const
+{
+    return _data != nullptr;
+}
+
+// Binary search on the hash, then compare addresses within equal hashes
+const HealthSnapshot::Record* HealthSnapshot::find(const std::string& serverAddress) const
+{
+    if (!_data) {
+        return nullptr;
+    }
+
+    uint64_t hash = addressHash(serverAddress);
+    const Record* begin = records();
+    const Record* end = begin + header().recordCount;
+    const Record* it = std::lower_bound(begin, end, hash, [](const Record& record, uint64_t value) {
+        return record.addressHash < value;
+    });
+
+    for (; it != end && it->addressHash == hash; ++it) {
+        if (it->addressLength == serverAddress.size() &&
+            std::memcmp(strings() + it->addressOffset, serverAddress.data(), serverAddress.size()) == 0) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+bool HealthSnapshot::restore(Server& server, std::chrono::steady_clock::time_point endpointRefreshAt) const
+{
+    const Record* record = find(server.getServerAddress());
+    if (!record) {
+        return false;
+    }
+
+    server.setAlive((record->flags & ServerHotState::kAlive) != 0);
+    server.setHealthy((record->flags & ServerHotState::kHealthy) != 0 && !server.isEjected());
+    server.setWeight(record->weight);
+    server.restoreLatency(record->latencyEwmaNanos, record->peakLatencyMicros);
+
+    // Names get their last resolution back so the first probes skip the lookup
+    ServerEndpoint current;
+    ServerEndpoint saved;
+    if (!server.getEndpoint(current) && loadEndpoint(*record, saved)) {
+        saved.refreshAt = endpointRefreshAt;
+        server.setEndpoint(saved);
+    }
+    return true;
+}
+
+size_t HealthSnapshot::size() const
+{
+    return _data ? static_cast<size_t>(header().recordCount) : 0;
+}
+
+std::chrono::system_clock::time_point HealthSnapshot::writtenAt() const
+{
+    if (!_data) {
+        return std::chrono::system_clock::time_point{};
+    }
+    return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::milliseconds(header().writtenAtMillis)));
+}
@@ -0,0 +1,434 @@
+#include "ip_hash_load_balancer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // Finalizer from splitmix64
+    uint64_t mix64(uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ULL;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    // Jump consistent hash (Lamping & Veach)
+    size_t jumpHash(uint64_t key, size_t buckets)
+    {
+        int64_t bucket = -1;
+        int64_t next = 0;
+
+        while (next < static_cast<int64_t>(buckets)) {
+            bucket = next;
+            key = key * 2862933555777941757ULL + 1;
+            next = static_cast<int64_t>((bucket + 1) * (static_cast<double>(1LL << 31) /
+                                        static_cast<double>((key >> 33) + 1)));
+        }
+
+        return static_cast<size_t>(bucket);
+    }
+
+    bool isPrime(size_t value)
+    {
+        if (value < 2) {
+            return false;
+        }
+        for (size_t divisor = 2; divisor * divisor <= value; ++divisor) {
+            if (value % divisor == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Maglev table size: prime and large enough to keep per-server shares within ~1%
+    size_t maglevTableSize(size_t serverCount, size_t minimum)
+    {
+        size_t size = (std::max)(minimum, serverCount * 100);
+        while (!isPrime(size)) {
+            ++size;
+        }
+        return size;
+    }
+}
+
+// IpHashEngine implementation
+
+// Constructor
+IpHashEngine::IpHashEngine(HashAlgorithm algorithm, double loadBoundFactor)
+    : _algorithm(algorithm),
+      _loadBoundFactor(loadBoundFactor)
+{
+}
+
+LoadBalancingStrategy IpHashEngine::strategy() const
+{
+    return kStrategy;
+}
+
+std::unique_ptr<SelectionEngine> IpHashEngine::clone() const
+{
+    return std::make_unique<IpHashEngine>(getHashAlgorithm(), getLoadBoundFactor());
+}
+
+// Key hashing (FNV-1a with a mixing finalizer)
+uint64_t IpHashEngine::hashKey(const std::string& key, uint64_t seed)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL ^ mix64(seed);
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 0x100000001B3ULL;
+    }
+    return mix64(hash);
+}
+
+// Build a snapshot with the lookup structure for its servers
+ServerSnapshot* IpHashEngine::buildSnapshot(std::vector<std::shared_ptr<Server>> servers) const
+{
+    HashAlgorithm algorithm = _algorithm.load(std::memory_order_relaxed);
+    auto* snapshot = new HashSnapshot(std::move(servers), algorithm);
+    const auto& serverList = snapshot->servers;
+    size_t serverCount = serverList.size();
+
+    if (serverCount == 0) {
+        return snapshot;
+    }
+
+    switch (algorithm) {
+    case HashAlgorithm::RING: {
+        // Points depend only on the server address, so membership changes move few keys
+        snapshot->ring.reserve(serverCount * kVirtualNodesPerServer);
+        for (size_t i = 0; i < serverCount; ++i) {
+            const std::string& address = serverList[i]->getServerAddress();
+            for (size_t node = 0; node < kVirtualNodesPerServer; ++node) {
+                snapshot->ring.emplace_back(hashKey(address, node + 1), static_cast<uint32_t>(i));
+            }
+        }
+        std::sort(snapshot->ring.begin(), snapshot->ring.end());
+        break;
+    }
+
+    case HashAlgorithm::MAGLEV: {
+        size_t tableSize = maglevTableSize(serverCount, kMinMaglevTableSize);
+        std::vector<uint64_t> offsets(serverCount);
+        std::vector<uint64_t> skips(serverCount);
+        std::vector<uint64_t> next(serverCount, 0);
+
+        for (size_t i = 0; i < serverCount; ++i) {
+            const std::string& address = serverList[i]->getServerAddress();
+            offsets[i] = hashKey(address, 0x6D61676C) % tableSize;
+            skips[i] = hashKey(address, 0x736B6970) % (tableSize - 1) + 1;
+        }
+
+        // Servers take turns claiming their next preferred free slot
+        constexpr uint32_t kEmpty = UINT32_MAX;
+        snapshot->table.assign(tableSize, kEmpty);
+        size_t filled = 0;
+        while (filled < tableSize) {
+            for (size_t i = 0; i < serverCount && filled < tableSize; ++i) {
+                uint64_t slot = (offsets[i] + next[i] * skips[i]) % tableSize;
+                while (snapshot->table[slot] != kEmpty) {
+                    ++next[i];
+                    slot = (offsets[i] + next[i] * skips[i]) % tableSize;
+                }
+                snapshot->table[slot] = static_cast<uint32_t>(i);
+                ++next[i];
+                ++filled;
+            }
+        }
+        break;
+    }
+
+    case HashAlgorithm::JUMP:
+        // Stateless; buckets are positions in the server list
+        break;
+    }
+
+    return snapshot;
+}
+
+// Bounded loads: capacity = ceil((1 + epsilon) * (total + 1) / healthy servers)
+uint32_t IpHashEngine::refreshLoadBound(const HashSnapshot& snapshot, double factor)
+{
+    uint32_t bound = 0;
+    if (factor > 0.0) {
+        uint64_t totalConnections = 0;
+        size_t healthyCount = 0;
+        for (const ServerHotState* state : snapshot.hotStates) {
+            if (state->isAvailable()) {
+                totalConnections += state->totalConnections();
+                ++healthyCount;
+            }
+        }
+
+        if (healthyCount != 0) {
+            double average = static_cast<double>(totalConnections + 1) / static_cast<double>(healthyCount);
+            bound = (std::max)(static_cast<uint32_t>(std::ceil((1.0 + factor) * average)), 1u);
+        }
+    }
+
+    snapshot.loadBound.store(bound, std::memory_order_relaxed);
+    snapshot.loadBoundFactor.store(factor, std::memory_order_relaxed);
+    return bound;
+}
+
+// Select the first eligible server along the key's probe sequence
+size_t IpHashEngine::selectForHash(const HashSnapshot& snapshot, uint64_t keyHash)
+{
+    const auto& hotStates = snapshot.hotStates;
+    size_t serverCount = hotStates.size();
+    if (serverCount == 0) {
+        return ServerSnapshot::npos;
+    }
+
+    // Refresh the capacity periodically instead of summing connections on every pick
+    thread_local uint64_t picksSinceRefresh = 0;
+    double factor = _loadBoundFactor.load(std::memory_order_relaxed);
+    uint32_t bound = snapshot.loadBound.load(std::memory_order_relaxed);
+    if ((picksSinceRefresh++ & kLoadBoundRefreshMask) == 0 || snapshot.loadBoundFactor.load(std::memory_order_relaxed) != factor) {
+        bound = refreshLoadBound(snapshot, factor);
+    }
+
+    // Probe position along the structure for this key
+    size_t structureSize = serverCount;
+    size_t base = 0;
+    if (snapshot.algorithm == HashAlgorithm::RING && !snapshot.ring.empty()) {
+        structureSize = snapshot.ring.size();
+        auto it = std::lower_bound(snapshot.ring.begin(), snapshot.ring.end(),
+                                   std::make_pair(keyHash, uint32_t{0}));
+        base = it == snapshot.ring.end() ? 0 : static_cast<size_t>(it - snapshot.ring.begin());
+    } else if (snapshot.algorithm == HashAlgorithm::MAGLEV && !snapshot.table.empty()) {
+        structureSize = snapshot.table.size();
+        base = static_cast<size_t>(keyHash % structureSize);
+    }
+
+    size_t maxProbes = (std::min)(structureSize, serverCount * kMaxProbesPerServer);
+    size_t overflowIndex = serverCount; // Healthy but above the load bound
+    size_t fallbackIndex = serverCount; // Alive but unhealthy
+
+    // A second pass runs with a freshly computed bound when the cached one was too tight
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t attempt = 0; attempt < maxProbes; ++attempt) {
+            size_t index;
+            switch (snapshot.algorithm) {
+            case HashAlgorithm::RING:
+                index = snapshot.ring[(base + attempt) % structureSize].second;
+                break;
+            case HashAlgorithm::MAGLEV:
+                index = snapshot.table[(base + attempt) % structureSize];
+                break;
+            default:
+                index = jumpHash(attempt == 0 ? keyHash : mix64(keyHash + attempt), serverCount);
+                break;
+            }
+
+            const ServerHotState* state = hotStates[index];
+            if (!state->isAlive()) {
+                continue;
+            }
+
+            if (!state->isHealthy()) {
+                if (fallbackIndex == serverCount) {
+                    fallbackIndex = index;
+                }
+                continue;
+            }
+
+            if (state->isSaturated()) {
+                continue; // At its concurrency limit: the key moves on like an overflow
+            }
+
+            if (bound == 0 || state->totalConnections() < bound) {
+                return index;
+            }
+
+            if (overflowIndex == serverCount) {
+                overflowIndex = index;
+            }
+        }
+
+        if (overflowIndex == serverCount || pass == 1) {
+            break;
+        }
+
+        uint32_t refreshed = refreshLoadBound(snapshot, factor);
+        if (refreshed == bound) {
+            break;
+        }
+        bound = refreshed;
+    }
+
+    if (overflowIndex != serverCount) {
+        return overflowIndex;
+    }
+
+    // Probe budget exhausted; take any healthy server below its limit (from a point that stays
+    // the same for the key) before the unhealthy fallback. A saturated server comes back only
+    // when every candidate is saturated.
+    size_t start = static_cast<size_t>(keyHash % serverCount);
+    size_t index = snapshot.nextUnsaturated(snapshot.available, start);
+    if (index != ServerSnapshot::npos) {
+        return index;
+    }
+
+    if (fallbackIndex != serverCount && !hotStates[fallbackIndex]->isSaturated()) {
+        return fallbackIndex;
+    }
+    return snapshot.nextUnsaturated(snapshot.alive, start);
+}
+
+// Keyless pick
+size_t IpHashEngine::selectIndex(const ServerSnapshot& snapshot, const SlowStart&)
+{
+    uint64_t ticket = _pickCounter.fetch_add(1, std::memory_order_relaxed);
+    return selectForHash(static_cast<const HashSnapshot&>(snapshot), mix64(ticket));
+}
+
+size_t IpHashEngine::selectForKey(const ServerSnapshot& snapshot, const SlowStart&, uint64_t keyHash)
+{
+    return selectForHash(static_cast<const HashSnapshot&>(snapshot), keyHash);
+}
+
+// Configuration
+void IpHashEngine::setHashAlgorithm(HashAlgorithm algorithm)
+{
+    _algorithm.store(algorithm, std::memory_order_relaxed);
+}
+
+HashAlgorithm IpHashEngine::getHashAlgorithm() const
+{
+    return _algorithm.load(std::memory_order_relaxed);
+}
+
+void IpHashEngine::setLoadBoundFactor(double factor)
+{
+    _loadBoundFactor.store(factor, std::memory_order_relaxed);
+}
+
+double IpHashEngine::getLoadBoundFactor() const
+{
+    return _loadBoundFactor.load(std::memory_order_relaxed);
+}
+
+// IpHashLoadBalancer implementation
+
+// Constructor
+IpHashLoadBalancer::IpHashLoadBalancer(
+    const std::vector<std::shared_ptr<Server>>& servers,
+    uint32_t healthCheckInterval,
+    uint32_t maxHealthCheckFailures,
+    HashAlgorithm algorithm,
+    double loadBoundFactor
+) : LoadBalancer(servers, LoadBalancingStrategy::IP_HASH, healthCheckInterval, maxHealthCheckFailures)
+{
+    if (servers.empty()) {
+        throw std::invalid_argument("Server list cannot be empty");
+    }
+
+    setHashAlgorithm(algorithm);
+    setLoadBoundFactor(loadBoundFactor);
+}
+
+// Copy constructor (the base copies the engines and their settings)
+IpHashLoadBalancer::IpHashLoadBalancer(const IpHashLoadBalancer& other)
+    : LoadBalancer(other)
+{
+}
+
+// Move constructor
+IpHashLoadBalancer::IpHashLoadBalancer(IpHashLoadBalancer&& other) noexcept
+    : LoadBalancer(std::move(other))
+{
+    // The stolen snapshot already carries its lookup structure
+}
+
+// Copy assignment operator
+IpHashLoadBalancer& IpHashLoadBalancer::operator=(const IpHashLoadBalancer& other)
+{
+    if (this != &other) {
+        LoadBalancer::operator=(other);
+    }
+    return *this;
+}
+
+// Move assignment operator
+IpHashLoadBalancer& IpHashLoadBalancer::operator=(IpHashLoadBalancer&& other) noexcept
+{
+    if (this != &other) {
+        LoadBalancer::operator=(std::move(other));
+    }
+    return *this;
+}
+
+// Destructor
+IpHashLoadBalancer::~IpHashLoadBalancer() = default;
+
+uint64_t IpHashLoadBalancer::hashKey(const std::string& key, uint64_t seed)
+{
+    return IpHashEngine::hashKey(key, seed);
+}
+
+// Sticky pick for a client address
+std::shared_ptr<Server> IpHashLoadBalancer::getServerForClient(const std::string& clientAddress)
+{
+    uint64_t keyHash = hashKey(clientAddress);
+
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
+    if (!snapshot || snapshot->servers.empty()) {
+        _metrics.emptyPicks.add();
+        return nullptr;
+    }
+
+    snapshot->sync();
+    const ServerSnapshot& target = pickTarget(*snapshot, keyHash);
+    size_t index = admitIndex(target, [&]() { return target.engine->selectForKey(target, _slowStart, keyHash); });
+    return index != ServerSnapshot::npos ? target.servers[index] : nullptr;
+}
+
+ServerLease IpHashLoadBalancer::acquireServerForClient(const std::string& clientAddress)
+{
+    uint64_t keyHash = hashKey(clientAddress);
+
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
+    if (!snapshot || snapshot->servers.empty()) {
+        _metrics.emptyPicks.add();
+        return ServerLease();
+    }
+
+    snapshot->sync();
+    const ServerSnapshot& target = pickTarget(*snapshot, keyHash);
+    return admitLease(target, [&]() { return target.engine->selectForKey(target, _slowStart, keyHash); });
+}
+
+// Configuration
+void IpHashLoadBalancer::setHashAlgorithm(HashAlgorithm algorithm)
+{
+    IpHashEngine& hashEngine = engineAs<IpHashEngine>();
+    if (hashEngine.getHashAlgorithm() == algorithm) {
+        return;
+    }
+
+    hashEngine.setHashAlgorithm(algorithm);
+    if (getStrategy() == LoadBalancingStrategy::IP_HASH) {
+        refreshSnapshot();
+    }
+}
+
+HashAlgorithm IpHashLoadBalancer::getHashAlgorithm() const
+{
+    return engineAs<IpHashEngine>().getHashAlgorithm();
+}
+
+void IpHashLoadBalancer::setLoadBoundFactor(double factor)
+{
+    // Snapshots recompute their bound on the next pick that sees the new factor
+    engineAs<IpHashEngine>().setLoadBoundFactor(factor);
+}
+
+double IpHashLoadBalancer::getLoadBoundFactor() const
+{
+    return engineAs<IpHashEngine>().getLoadBoundFactor();
+}
@@ -0,0 +1,160 @@
+#include "least_connections_load_balancer.hpp"
+#include <stdexcept>
+
+// LeastConnectionsEngine implementation
+
+// Constructor
+LeastConnectionsEngine::LeastConnectionsEngine(size_t fullScanThreshold)
+    : _fullScanThreshold(fullScanThreshold)
+{
+}
+
+LoadBalancingStrategy LeastConnectionsEngine::strategy() const
+{
+    return kStrategy;
+}
+
+std::unique_ptr<SelectionEngine> LeastConnectionsEngine::clone() const
+{
+    return std::make_unique<LeastConnectionsEngine>(getFullScanThreshold());
+}
+
+// Load including the pick being made, so weights matter for idle servers too
+double LeastConnectionsEngine::loadOf(const ServerHotState& state, const SlowStart& slowStart)
+{
+    double connections = static_cast<double>(state.totalConnections()) + 1.0;
+    return connections / slowStart.effectiveWeight(state);
+}
+
+// Full scan for the least loaded server
+size_t LeastConnectionsEngine::scanLeastLoaded(const std::vector<const ServerHotState*>& states, const SlowStart& slowStart)
+{
+    size_t serverCount = states.size();
+    size_t bestIndex = serverCount;
+    unsigned bestRank = 0;
+    double bestLoad = 0.0;
+    if (serverCount == 0) {
+        return serverCount;
+    }
+
+    // Ties go to the first server seen, so moving the start spreads equal loads over the pool
+    size_t start = _scanStart.fetch_add(1, std::memory_order_relaxed) % serverCount;
+    for (size_t step = 0, i = start; step < serverCount; ++step, i = i + 1 == serverCount ? 0 : i + 1) {
+        const ServerHotState* state = states[i];
+        if (!state->isAlive()) {
+            continue;
+        }
+
+        // Healthy before alive-only fallbacks; a saturated server only when its group has no other
+        unsigned rank = (state->isHealthy() ? 0u : 2u) + (state->isSaturated() ? 1u : 0u);
+        double load = loadOf(*state, slowStart);
+        if (bestIndex == serverCount || rank < bestRank || (rank == bestRank && load < bestLoad)) {
+            bestIndex = i;
+            bestRank = rank;
+            bestLoad = load;
+        }
+    }
+
+    return bestIndex;
+}
+
+// Select next server using power-of-two-choices least connections
+size_t LeastConnectionsEngine::selectIndex(const ServerSnapshot& snapshot, const SlowStart& slowStart)
+{
+    const auto& hotStates = snapshot.hotStates;
+    size_t serverCount = hotStates.size();
+
+    if (serverCount > _fullScanThreshold.load(std::memory_order_relaxed)) {
+        size_t first = snapshot.sampleAvailable();
+        if (first != ServerSnapshot::npos) {
+            size_t second = snapshot.sampleAvailable(first);
+            bool firstFree = !hotStates[first]->isSaturated();
+            bool secondFree = second != ServerSnapshot::npos && !hotStates[second]->isSaturated();
+
+            if (firstFree && secondFree) {
+                // Lower effective load wins; ties keep the first draw, a uniform choice of the two
+                return loadOf(*hotStates[second], slowStart) < loadOf(*hotStates[first], slowStart) ? second : first;
+            }
+            if (firstFree != secondFree) {
+                return firstFree ? first : second;
+            }
+            // Both draws at their limit: the scan finds a free server if there is one
+        }
+    }
+
+    // Small pool, saturated draws, or no server available (the scan falls back to alive ones)
+    size_t index = scanLeastLoaded(hotStates, slowStart);
+    return index != serverCount ? index : ServerSnapshot::npos;
+}
+
+// Configuration
+void LeastConnectionsEngine::setFullScanThreshold(size_t serverCount)
+{
+    _fullScanThreshold.store(serverCount, std::memory_order_relaxed);
+}
+
+size_t LeastConnectionsEngine::getFullScanThreshold() const
+{
+    return _fullScanThreshold.load(std::memory_order_relaxed);
+}
+
+// LeastConnectionsLoadBalancer implementation
+
+// Constructor
+LeastConnectionsLoadBalancer::LeastConnectionsLoadBalancer(
+    const std::vector<std::shared_ptr<Server>>& servers,
+    uint32_t healthCheckInterval,
+    uint32_t maxHealthCheckFailures,
+    size_t fullScanThreshold
+) : LoadBalancer(servers, LoadBalancingStrategy::LEAST_CONNECTIONS, healthCheckInterval, maxHealthCheckFailures)
+{
+    if (servers.empty()) {
+        throw std::invalid_argument("Server list cannot be empty");
+    }
+
+    setFullScanThreshold(fullScanThreshold);
+}
+
+// Copy constructor (the base copies the engines and their settings)
+LeastConnectionsLoadBalancer::LeastConnectionsLoadBalancer(const LeastConnectionsLoadBalancer& other)
+    : LoadBalancer(other)
+{
+}
+
+// Move constructor
+LeastConnectionsLoadBalancer::LeastConnectionsLoadBalancer(LeastConnectionsLoadBalancer&& other) noexcept
+    : LoadBalancer(std::move(other))
+{
+}
+
+// Copy assignment operator
+LeastConnectionsLoadBalancer& LeastConnectionsLoadBalancer::operator=(const LeastConnectionsLoadBalancer& other)
+{
+    if (this != &other) {
+        LoadBalancer::operator=(other);
+    }
+    return *this;
+}
+
+// Move assignment operator
+LeastConnectionsLoadBalancer& LeastConnectionsLoadBalancer::operator=(LeastConnectionsLoadBalancer&& other) noexcept
+{
+    if (this != &other) {
+        LoadBalancer::operator=(std::move(other));
+    }
+    return *this;
+}
+
+// Destructor
+LeastConnectionsLoadBalancer::~LeastConnectionsLoadBalancer() = default;
+
+// Configuration
+void LeastConnectionsLoadBalancer::setFullScanThreshold(size_t serverCount)
+{
+    engineAs<LeastConnectionsEngine>().setFullScanThreshold(serverCount);
+}
+
+size_t LeastConnectionsLoadBalancer::getFullScanThreshold() const
+{
+    return engineAs<LeastConnectionsEngine>().getFullScanThreshold();
+}
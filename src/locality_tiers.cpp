@@ -0,0 +1,189 @@
+#include "locality_tiers.hpp"
+#include "selection_engine.hpp"
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace {
+    constexpr uint64_t kShareScale = uint64_t{1} << 32;
+
+    // High half of the splitmix64 finalizer
+    uint32_t mixDraw(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+    }
+
+    // Per-thread draw; splitmix64 over a Weyl sequence seeded from the thread's state address
+    uint32_t nextDraw()
+    {
+        thread_local uint64_t state = reinterpret_cast<uintptr_t>(&state) * 0x9E3779B97F4A7C15ULL;
+        return mixDraw(state += 0x9E3779B97F4A7C15ULL);
+    }
+}
+
+// Group servers by (priority, local zone first)
+std::unique_ptr<LocalityTiers> LocalityTiers::build(
+    const std::vector<std::shared_ptr<Server>>& servers,
+    const std::string& localZone,
+    double threshold,
+    SelectionEngine& engine)
+{
+    std::map<std::pair<uint32_t, bool>, std::vector<std::shared_ptr<Server>>> groups;
+    for (const auto& server : servers) {
+        bool local = localZone.empty() || server->getZone() == localZone;
+        groups[{server->getPriority(), !local}].push_back(server);
+    }
+    if (groups.size() < 2) {
+        return nullptr;
+    }
+
+    std::vector<Tier> tiers;
+    tiers.reserve((std::min)(groups.size(), kMaxTiers));
+    for (auto& [key, members] : groups) {
+        if (tiers.size() == kMaxTiers) {
+            // Least preferred groups share the last tier
+            std::vector<std::shared_ptr<Server>> merged = tiers.back().snapshot->servers;
+            merged.insert(merged.end(), members.begin(), members.end());
+            tiers.back().snapshot.reset(engine.buildSnapshot(std::move(merged)));
+            tiers.back().snapshot->engine = &engine;
+            continue;
+        }
+
+        Tier tier;
+        tier.snapshot.reset(engine.buildSnapshot(std::move(members)));
+        tier.snapshot->engine = &engine;
+        tier.priority = key.first;
+        tier.local = !key.second;
+        tiers.push_back(std::move(tier));
+    }
+
+    return std::make_unique<LocalityTiers>(std::move(tiers), threshold);
+}
+
+// Constructor
+LocalityTiers::LocalityTiers(std::vector<Tier> tiers, double threshold)
+    : _tiers(std::move(tiers)),
+      _threshold(std::clamp(threshold, 0.01, 1.0))
+{
+    std::lock_guard<std::mutex> lock(_updateMutex);
+    updateShares();
+}
+
+// Overflow shares: a tier keeps min(1, healthy fraction / threshold) of what the tiers
+// before it left over. When even the sum falls short of 1 (every tier is degraded), the
+// shares are scaled up so the remaining healthy servers take all traffic.
+std::array<double, LocalityTiers::kMaxTiers> LocalityTiers::sharesFor(const std::array<size_t, kMaxTiers>& availableCounts) const
+{
+    std::array<double, kMaxTiers> shares{};
+    double remaining = 1.0;
+    for (size_t i = 0; i < _tiers.size(); ++i) {
+        double healthyFraction = static_cast<double>(availableCounts[i]) / static_cast<double>(_tiers[i].snapshot->servers.size());
+        double eligible = (std::min)(1.0, healthyFraction / _threshold);
+        shares[i] = (std::min)(remaining, eligible);
+        remaining -= shares[i];
+    }
+
+    double total = 1.0 - remaining;
+    if (total > 0.0 && total < 1.0) {
+        for (size_t i = 0; i < _tiers.size(); ++i) {
+            shares[i] /= total;
+        }
+    }
+    return shares;
+}
+
+void LocalityTiers::updateShares() const
+{
+    std::array<size_t, kMaxTiers> counts{};
+    for (size_t i = 0; i < _tiers.size(); ++i) {
+        counts[i] = _tiers[i].snapshot->availableCount.load(std::memory_order_relaxed);
+        _availableSeen[i].store(counts[i], std::memory_order_relaxed);
+    }
+
+    std::array<double, kMaxTiers> shares = sharesFor(counts);
+    double cumulative = 0.0;
+    size_t last = _tiers.size();
+    for (size_t i = 0; i < _tiers.size(); ++i) {
+        cumulative += shares[i];
+        if (shares[i] > 0.0) {
+            last = i;
+        }
+        _cumulative[i].store(static_cast<uint64_t>(cumulative * static_cast<double>(kShareScale)), std::memory_order_relaxed);
+    }
+
+    // No rounding gap at the top: the last tier with a share covers every draw
+    if (last != _tiers.size()) {
+        for (size_t i = last; i < _tiers.size(); ++i) {
+            _cumulative[i].store(kShareScale, std::memory_order_relaxed);
+        }
+    }
+}
+
+void LocalityTiers::sync() const
+{
+    bool changed = false;
+    for (size_t i = 0; i < _tiers.size(); ++i) {
+        _tiers[i].snapshot->sync();
+        changed |= _tiers[i].snapshot->availableCount.load(std::memory_order_relaxed) !=
+                   _availableSeen[i].load(std::memory_order_relaxed);
+    }
+    if (!changed) {
+        return;
+    }
+
+    // Concurrent callers pick with the previous shares
+    std::unique_lock<std::mutex> lock(_updateMutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+        updateShares();
+    }
+}
+
+const ServerSnapshot* LocalityTiers::select() const
+{
+    return selectAt(nextDraw());
+}
+
+const ServerSnapshot* LocalityTiers::selectForKey(uint64_t keyHash) const
+{
+    // Remixed so the tier draw does not follow the engine's use of the same hash
+    return selectAt(mixDraw(keyHash));
+}
+
+const ServerSnapshot* LocalityTiers::selectAt(uint64_t point) const
+{
+    for (size_t i = 0; i < _tiers.size(); ++i) {
+        if (point < _cumulative[i].load(std::memory_order_relaxed)) {
+            return _tiers[i].snapshot.get();
+        }
+    }
+    return nullptr;
+}
+
+size_t LocalityTiers::size() const
+{
+    return _tiers.size();
+}
+
+std::vector<TierStats> LocalityTiers::stats() const
+{
+    std::array<size_t, kMaxTiers> counts{};
+    for (size_t i = 0; i < _tiers.size(); ++i) {
+        counts[i] = _tiers[i].snapshot->availableCount.load(std::memory_order_relaxed);
+    }
+    std::array<double, kMaxTiers> shares = sharesFor(counts);
+
+    std::vector<TierStats> result;
+    result.reserve(_tiers.size());
+    for (size_t i = 0; i < _tiers.size(); ++i) {
+        TierStats tier;
+        tier.priority = _tiers[i].priority;
+        tier.local = _tiers[i].local;
+        tier.servers = _tiers[i].snapshot->servers.size();
+        tier.healthyServers = counts[i];
+        tier.share = shares[i];
+        result.push_back(tier);
+    }
+    return result;
+}
@@ -0,0 +1,124 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// LatencyHistogram implementation
+LatencyHistogram::Snapshot& LatencyHistogram::Snapshot::operator+=(const Snapshot& other)
+{
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sumSeconds += other.sumSeconds;
+    return *this;
+}
+
+void LatencyHistogram::observe(std::chrono::nanoseconds duration)
+{
+    double seconds = std::chrono::duration<double>(duration).count();
+
+    size_t bucket = 0;
+    while (bucket < kBucketCount && seconds > kBoundsSeconds[bucket]) {
+        ++bucket;
+    }
+
+    _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    _sumNanos.fetch_add(static_cast<uint64_t>((std::max)(duration.count(), std::chrono::nanoseconds::rep(0))), std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot result;
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        result.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        result.count += result.buckets[i];
+    }
+    result.sumSeconds = static_cast<double>(_sumNanos.load(std::memory_order_relaxed)) * 1e-9;
+    return result;
+}
+
+// ServerMetrics implementation
+void ServerMetrics::recordProbe(bool success, std::chrono::nanoseconds duration)
+{
+    probes.fetch_add(1, std::memory_order_relaxed);
+    if (success) {
+        probeDuration.observe(duration);
+    } else {
+        probeFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// PrometheusWriter implementation
+void PrometheusWriter::family(const std::string& name, const std::string& help, const std::string& type)
+{
+    _text += "# HELP " + name + " " + help + "\n";
+    _text += "# TYPE " + name + " " + type + "\n";
+}
+
+void PrometheusWriter::appendLabels(const std::string& labels)
+{
+    if (!labels.empty()) {
+        _text += "{" + labels + "}";
+    }
+}
+
+void PrometheusWriter::appendValue(double value)
+{
+    if (std::isinf(value)) {
+        _text += value > 0 ? " +Inf\n" : " -Inf\n";
+        return;
+    }
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), " %.17g\n", value);
+    _text += buffer;
+}
+
+void PrometheusWriter::sample(const std::string& name, const std::string& labels, double value)
+{
+    _text += name;
+    appendLabels(labels);
+    appendValue(value);
+}
+
+void PrometheusWriter::histogram(const std::string& name, const std::string& labels, const LatencyHistogram::Snapshot& snapshot)
+{
+    std::string prefix = labels.empty() ? "" : labels + ",";
+    uint64_t cumulative = 0;
+
+    for (size_t i = 0; i <= LatencyHistogram::kBucketCount; ++i) {
+        cumulative += snapshot.buckets[i];
+
+        char bound[32];
+        if (i < LatencyHistogram::kBucketCount) {
+            std::snprintf(bound, sizeof(bound), "%g", LatencyHistogram::kBoundsSeconds[i]);
+        } else {
+            std::snprintf(bound, sizeof(bound), "+Inf");
+        }
+        sample(name + "_bucket", prefix + "le=\"" + bound + "\"", static_cast<double>(cumulative));
+    }
+
+    sample(name + "_sum", labels, snapshot.sumSeconds);
+    sample(name + "_count", labels, static_cast<double>(snapshot.count));
+}
+
+std::string PrometheusWriter::label(const std::string& name, const std::string& value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '"':  escaped += "\\\""; break;
+            case '\n': escaped += "\\n"; break;
+            default:   escaped += c; break;
+        }
+    }
+    return name + "=\"" + escaped + "\"";
+}
+
+const std::string& PrometheusWriter::text() const
+{
+    return _text;
+}
@@ -0,0 +1,135 @@
+#include "numa_topology.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Platform-specific includes
+#ifdef _WIN32
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace {
+    // Parse a sysfs CPU list such as "0-3,8-11"
+    std::vector<uint32_t> parseCpuList(const std::string& list)
+    {
+        std::vector<uint32_t> cpus;
+        std::stringstream stream(list);
+        std::string range;
+        while (std::getline(stream, range, ',')) {
+            try {
+                size_t dash = range.find('-');
+                unsigned long first = std::stoul(range.substr(0, dash));
+                unsigned long last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                for (unsigned long cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(static_cast<uint32_t>(cpu));
+                }
+            } catch (...) {
+                // Malformed entry (e.g. the trailing newline); skip it
+            }
+        }
+        return cpus;
+    }
+}
+
+// Constructor
+NumaTopology::NumaTopology()
+{
+    #ifdef __linux__
+        // Node ids can have gaps; stop after a run of missing directories
+        for (uint32_t node = 0, missing = 0; missing < 64; ++node) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string list;
+            if (!file || !std::getline(file, list)) {
+                ++missing;
+                continue;
+            }
+            missing = 0;
+
+            std::vector<uint32_t> cpus = parseCpuList(list);
+            if (cpus.empty()) {
+                continue; // Memory-only node
+            }
+            for (uint32_t cpu : cpus) {
+                if (cpu >= _cpuNode.size()) {
+                    _cpuNode.resize(cpu + 1, 0);
+                }
+                _cpuNode[cpu] = static_cast<uint32_t>(_nodeCpus.size());
+            }
+            _nodeCpus.push_back(std::move(cpus));
+        }
+    #endif
+
+    if (_nodeCpus.empty()) {
+        uint32_t cpus = (std::max)(std::thread::hardware_concurrency(), 1u);
+        _nodeCpus.emplace_back();
+        for (uint32_t cpu = 0; cpu < cpus; ++cpu) {
+            _nodeCpus[0].push_back(cpu);
+        }
+        _cpuNode.assign(cpus, 0);
+    }
+}
+
+const NumaTopology& NumaTopology::instance()
+{
+    static NumaTopology* topology = new NumaTopology();
+    return *topology;
+}
+
+size_t NumaTopology::nodeCount() const
+{
+    return _nodeCpus.size();
+}
+
+size_t NumaTopology::cpuCount() const
+{
+    return _cpuNode.size();
+}
+
+uint32_t NumaTopology::nodeOf(uint32_t cpu) const
+{
+    return cpu < _cpuNode.size() ? _cpuNode[cpu] : 0;
+}
+
+const std::vector<uint32_t>& NumaTopology::cpusOf(uint32_t node) const
+{
+    return _nodeCpus[node < _nodeCpus.size() ? node : 0];
+}
+
+uint32_t NumaTopology::currentCpu()
+{
+    #ifdef _WIN32
+        return static_cast<uint32_t>(GetCurrentProcessorNumber());
+    #elif defined(__linux__)
+        int cpu = sched_getcpu();
+        return cpu >= 0 ? static_cast<uint32_t>(cpu) : 0;
+    #else
+        return 0;
+    #endif
+}
+
+uint32_t NumaTopology::currentNode() const
+{
+    return nodeOf(currentCpu());
+}
+
+bool NumaTopology::bindCurrentThread(const std::vector<uint32_t>& cpus)
+{
+    #ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (uint32_t cpu : cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    #else
+        (void)cpus;
+        return false;
+    #endif
+}
@@ -0,0 +1,300 @@
+#include "outlier_detector.hpp"
+#include <algorithm>
+#include <utility>
+
+// Copy constructor
+OutlierDetector::OutlierDetector(const OutlierDetector& other)
+{
+    *this = other;
+}
+
+// Copy assignment
+OutlierDetector& OutlierDetector::operator=(const OutlierDetector& other)
+{
+    if (this != &other) {
+        _enabled.store(other._enabled.load());
+        _consecutiveFailureThreshold.store(other._consecutiveFailureThreshold.load());
+        _errorRateThreshold.store(other._errorRateThreshold.load());
+        _minimumRequests.store(other._minimumRequests.load());
+        _latencyOutlierFactor.store(other._latencyOutlierFactor.load());
+        _baseEjectionTime.store(other._baseEjectionTime.load());
+        _maxEjectionPercent.store(other._maxEjectionPercent.load());
+        _evaluationInterval.store(other._evaluationInterval.load());
+
+        // Ejection state belongs to the servers of the pool it was tracking
+    }
+    return *this;
+}
+
+bool OutlierDetector::eject(Server& server, std::chrono::steady_clock::time_point now)
+{
+    ServerOutcomeStats& stats = server._outcomes;
+    if (stats.ejectedUntil.load(std::memory_order_relaxed) != 0) {
+        return false; // Already out
+    }
+
+    uint32_t percent = _maxEjectionPercent.load(std::memory_order_relaxed);
+    if (percent == 0) {
+        return false;
+    }
+
+    // Reserve one of the ejection slots; small pools may always eject one server
+    size_t poolSize = _poolSize.load(std::memory_order_relaxed);
+    size_t cap = (std::max)(poolSize * percent / 100, size_t(1));
+    size_t ejected = _ejectedCount.load(std::memory_order_relaxed);
+    do {
+        if (ejected >= cap) {
+            return false;
+        }
+    } while (!_ejectedCount.compare_exchange_weak(ejected, ejected + 1, std::memory_order_relaxed));
+
+    // Repeat offenders stay out longer
+    uint32_t multiplier = (std::min)(stats.ejectionCount.load(std::memory_order_relaxed) + 1, kMaxEjectionMultiplier);
+    auto until = now + std::chrono::milliseconds(_baseEjectionTime.load(std::memory_order_relaxed)) * multiplier;
+
+    std::chrono::steady_clock::rep expected = 0;
+    if (!stats.ejectedUntil.compare_exchange_strong(expected, until.time_since_epoch().count(), std::memory_order_acq_rel)) {
+        _ejectedCount.fetch_sub(1, std::memory_order_relaxed);
+        return false; // Another thread ejected it first
+    }
+
+    stats.ejectionCount.fetch_add(1, std::memory_order_relaxed);
+    server.setHealthy(false);
+    return true;
+}
+
+bool OutlierDetector::expireIfDue(Server& server, std::chrono::steady_clock::rep nowTicks)
+{
+    ServerOutcomeStats& stats = server._outcomes;
+    auto until = stats.ejectedUntil.load(std::memory_order_acquire);
+    if (until == 0) {
+        return false;
+    }
+    if (until > nowTicks) {
+        return true;
+    }
+
+    // One thread ends the ejection and gives its slot back
+    if (!stats.ejectedUntil.compare_exchange_strong(until, 0, std::memory_order_acq_rel)) {
+        return stats.ejectedUntil.load(std::memory_order_relaxed) != 0;
+    }
+    size_t ejected = _ejectedCount.load(std::memory_order_relaxed);
+    while (ejected > 0 && !_ejectedCount.compare_exchange_weak(ejected, ejected - 1, std::memory_order_relaxed)) {
+    }
+
+    // Rejoin unless the active checker saw the server fail meanwhile
+    stats.consecutiveFailures.store(0, std::memory_order_relaxed);
+    if (server.isAlive() && server.getFailureCount() == 0) {
+        server.setHealthy(true);
+    }
+    return false;
+}
+
+void OutlierDetector::rollWindow(ServerOutcomeStats& stats, std::chrono::steady_clock::rep nowTicks)
+{
+    auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::milliseconds(_evaluationInterval.load(std::memory_order_relaxed))).count();
+    auto started = stats.windowStartedAt.load(std::memory_order_relaxed);
+    if (nowTicks - started < interval) {
+        return;
+    }
+    if (!stats.windowStartedAt.compare_exchange_strong(started, nowTicks, std::memory_order_relaxed)) {
+        return; // Another thread rolled it
+    }
+
+    // A clean window lets repeat ejection scaling decay
+    uint32_t count = stats.ejectionCount.load(std::memory_order_relaxed);
+    if (count > 0 && stats.ejectedUntil.load(std::memory_order_relaxed) == 0 &&
+        stats.windowFailures.load(std::memory_order_relaxed) == 0) {
+        stats.ejectionCount.store(count - 1, std::memory_order_relaxed);
+    }
+    stats.resetWindow();
+}
+
+// Record a request outcome
+bool OutlierDetector::recordOutcome(Server& server, bool success, std::chrono::nanoseconds latency)
+{
+    auto now = std::chrono::steady_clock::now();
+    rollWindow(server._outcomes, now.time_since_epoch().count());
+    uint32_t consecutiveFailures = server._outcomes.record(success, latency);
+    server._hot->recordPeakLatency(latency, now);
+
+    if (success || !_enabled.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    if (consecutiveFailures >= _consecutiveFailureThreshold.load(std::memory_order_relaxed)) {
+        return eject(server, now);
+    }
+
+    uint32_t requests = server._outcomes.windowRequests.load(std::memory_order_relaxed);
+    uint32_t failures = server._outcomes.windowFailures.load(std::memory_order_relaxed);
+    if (requests >= _minimumRequests.load(std::memory_order_relaxed) &&
+        failures >= _errorRateThreshold.load(std::memory_order_relaxed) * requests) {
+        return eject(server, now);
+    }
+
+    return false;
+}
+
+// Periodic evaluation
+void OutlierDetector::evaluate(const std::vector<std::shared_ptr<Server>>& servers, std::chrono::steady_clock::time_point now)
+{
+    auto nowTicks = now.time_since_epoch().count();
+    if (nowTicks < _nextEvaluation.load(std::memory_order_relaxed)) {
+        return;
+    }
+    auto interval = std::chrono::milliseconds(_evaluationInterval.load(std::memory_order_relaxed));
+    _nextEvaluation.store((now + interval).time_since_epoch().count(), std::memory_order_relaxed);
+
+    _poolSize.store(servers.size(), std::memory_order_relaxed);
+
+    uint32_t minimumRequests = _minimumRequests.load(std::memory_order_relaxed);
+    std::vector<std::pair<uint64_t, Server*>> latencies;
+    size_t ejected = 0;
+
+    for (const auto& server : servers) {
+        ServerOutcomeStats& stats = server->_outcomes;
+        if (expireIfDue(*server, nowTicks)) {
+            ++ejected;
+        } else if (stats.windowRequests.load(std::memory_order_relaxed) >= minimumRequests) {
+            latencies.emplace_back(stats.latencyEwmaNanos.load(std::memory_order_relaxed), server.get());
+        }
+        rollWindow(stats, nowTicks);
+    }
+    _ejectedCount.store(ejected, std::memory_order_relaxed);
+
+    if (!_enabled.load(std::memory_order_relaxed) || latencies.size() < kMinLatencySamples) {
+        return;
+    }
+
+    // Servers far above the pool median are latency outliers
+    size_t middle = latencies.size() / 2;
+    std::nth_element(latencies.begin(), latencies.begin() + middle, latencies.end());
+    double threshold = static_cast<double>(latencies[middle].first) * _latencyOutlierFactor.load(std::memory_order_relaxed);
+
+    for (const auto& [latency, server] : latencies) {
+        if (static_cast<double>(latency) > threshold) {
+            eject(*server, now);
+        }
+    }
+}
+
+// Lazy expiry from the pick path
+void OutlierDetector::expireSlow(const std::vector<std::shared_ptr<Server>>& servers)
+{
+    // Read the clock every few hundred picks per thread, walk the pool at most every 100ms
+    thread_local uint32_t picksUntilCheck = 0;
+    if (picksUntilCheck-- != 0) {
+        return;
+    }
+    picksUntilCheck = kExpiryCheckPicks;
+
+    auto now = std::chrono::steady_clock::now();
+    auto nowTicks = now.time_since_epoch().count();
+    auto next = _nextExpiryCheck.load(std::memory_order_relaxed);
+    if (nowTicks < next ||
+        !_nextExpiryCheck.compare_exchange_strong(next, (now + kExpiryCheckInterval).time_since_epoch().count(), std::memory_order_relaxed)) {
+        return;
+    }
+
+    // Recount so ejected servers that left the pool stop holding slots
+    size_t ejected = 0;
+    for (const auto& server : servers) {
+        if (expireIfDue(*server, nowTicks)) {
+            ++ejected;
+        }
+    }
+    _ejectedCount.store(ejected, std::memory_order_relaxed);
+}
+
+void OutlierDetector::setPoolSize(size_t servers)
+{
+    _poolSize.store(servers, std::memory_order_relaxed);
+}
+
+size_t OutlierDetector::getEjectedCount() const
+{
+    return _ejectedCount.load(std::memory_order_relaxed);
+}
+
+// Configuration
+void OutlierDetector::setEnabled(bool enabled)
+{
+    _enabled.store(enabled);
+}
+
+bool OutlierDetector::isEnabled() const
+{
+    return _enabled.load();
+}
+
+void OutlierDetector::setConsecutiveFailureThreshold(uint32_t failures)
+{
+    _consecutiveFailureThreshold.store(failures > 0 ? failures : 1);
+}
+
+uint32_t OutlierDetector::getConsecutiveFailureThreshold() const
+{
+    return _consecutiveFailureThreshold.load();
+}
+
+void OutlierDetector::setErrorRateThreshold(double rate)
+{
+    _errorRateThreshold.store(std::clamp(rate, 0.0, 1.0));
+}
+
+double OutlierDetector::getErrorRateThreshold() const
+{
+    return _errorRateThreshold.load();
+}
+
+void OutlierDetector::setMinimumRequests(uint32_t requests)
+{
+    _minimumRequests.store(requests > 0 ? requests : 1);
+}
+
+uint32_t OutlierDetector::getMinimumRequests() const
+{
+    return _minimumRequests.load();
+}
+
+void OutlierDetector::setLatencyOutlierFactor(double factor)
+{
+    _latencyOutlierFactor.store((std::max)(factor, 1.0));
+}
+
+double OutlierDetector::getLatencyOutlierFactor() const
+{
+    return _latencyOutlierFactor.load();
+}
+
+void OutlierDetector::setBaseEjectionTime(std::chrono::milliseconds duration)
+{
+    _baseEjectionTime.store((std::max)(duration.count(), std::chrono::milliseconds::rep(1)));
+}
+
+std::chrono::milliseconds OutlierDetector::getBaseEjectionTime() const
+{
+    return std::chrono::milliseconds(_baseEjectionTime.load());
+}
+
+void OutlierDetector::setMaxEjectionPercent(uint32_t percent)
+{
+    _maxEjectionPercent.store((std::min)(percent, 100u));
+}
+
+uint32_t OutlierDetector::getMaxEjectionPercent() const
+{
+    return _maxEjectionPercent.load();
+}
+
+void OutlierDetector::setEvaluationInterval(std::chrono::milliseconds interval)
+{
+    _evaluationInterval.store((std::max)(interval.count(), std::chrono::milliseconds::rep(1)));
+}
+
+std::chrono::milliseconds OutlierDetector::getEvaluationInterval() const
+{
+    return std::chrono::milliseconds(_evaluationInterval.load());
+}
@@ -0,0 +1,156 @@
+#include "peak_ewma_load_balancer.hpp"
+#include <stdexcept>
+
+// PeakEwmaEngine implementation
+
+// Constructor
+PeakEwmaEngine::PeakEwmaEngine(std::chrono::microseconds defaultLatency)
+{
+    setDefaultLatency(defaultLatency);
+}
+
+LoadBalancingStrategy PeakEwmaEngine::strategy() const
+{
+    return kStrategy;
+}
+
+std::unique_ptr<SelectionEngine> PeakEwmaEngine::clone() const
+{
+    return std::make_unique<PeakEwmaEngine>(getDefaultLatency());
+}
+
+// Predicted latency times queue depth, per unit of (slow start adjusted) weight
+double PeakEwmaEngine::cost(const ServerSnapshot& snapshot, const SlowStart& slowStart, size_t index, std::chrono::steady_clock::time_point now) const
+{
+    const ServerHotState* state = snapshot.hotStates[index];
+    uint32_t connections = state->currentConnections.load(std::memory_order_relaxed);
+    double latency = state->peakLatencyMicros(now);
+    if (latency <= 0.0) {
+        // Never measured: try it while idle, cost it pessimistically while requests are out
+        if (connections == 0) {
+            return 0.0;
+        }
+        latency = static_cast<double>(_defaultLatency.load(std::memory_order_relaxed));
+    }
+
+    double outstanding = static_cast<double>(connections) + 1.0;
+    return latency * outstanding / slowStart.effectiveWeight(*state);
+}
+
+// Select next server using power-of-two-choices on peak-EWMA cost
+size_t PeakEwmaEngine::selectIndex(const ServerSnapshot& snapshot, const SlowStart& slowStart)
+{
+    const auto& hotStates = snapshot.hotStates;
+    size_t serverCount = hotStates.size();
+    auto now = std::chrono::steady_clock::now();
+
+    size_t first = snapshot.sampleAvailable();
+    if (first != ServerSnapshot::npos) {
+        size_t second = snapshot.sampleAvailable(first);
+        bool firstFree = !hotStates[first]->isSaturated();
+        bool secondFree = second != ServerSnapshot::npos && !hotStates[second]->isSaturated();
+
+        if (firstFree && secondFree) {
+            // Lower predicted latency wins; ties keep the first draw, a uniform choice of the two
+            return cost(snapshot, slowStart, second, now) < cost(snapshot, slowStart, first, now) ? second : first;
+        }
+        if (firstFree != secondFree) {
+            return firstFree ? first : second;
+        }
+    }
+
+    // Both draws at their limit, or no server available: cheapest healthy, then cheapest
+    // alive, each preferring servers below their limit
+    size_t bestIndex = ServerSnapshot::npos;
+    unsigned bestRank = 0;
+    double bestCost = 0.0;
+
+    for (size_t i = 0; i < serverCount; ++i) {
+        const ServerHotState* state = hotStates[i];
+        if (!state->isAlive()) {
+            continue;
+        }
+
+        unsigned rank = (state->isHealthy() ? 0u : 2u) + (state->isSaturated() ? 1u : 0u);
+        double serverCost = cost(snapshot, slowStart, i, now);
+        if (bestIndex == ServerSnapshot::npos || rank < bestRank || (rank == bestRank && serverCost < bestCost)) {
+            bestIndex = i;
+            bestRank = rank;
+            bestCost = serverCost;
+        }
+    }
+
+    return bestIndex;
+}
+
+// Configuration
+void PeakEwmaEngine::setDefaultLatency(std::chrono::microseconds latency)
+{
+    _defaultLatency.store(latency.count() > 0 ? latency.count() : 1, std::memory_order_relaxed);
+}
+
+std::chrono::microseconds PeakEwmaEngine::getDefaultLatency() const
+{
+    return std::chrono::microseconds(_defaultLatency.load(std::memory_order_relaxed));
+}
+
+// PeakEwmaLoadBalancer implementation
+
+// Constructor
+PeakEwmaLoadBalancer::PeakEwmaLoadBalancer(
+    const std::vector<std::shared_ptr<Server>>& servers,
+    uint32_t healthCheckInterval,
+    uint32_t maxHealthCheckFailures,
+    std::chrono::microseconds defaultLatency
+) : LoadBalancer(servers, LoadBalancingStrategy::PEAK_EWMA, healthCheckInterval, maxHealthCheckFailures)
+{
+    if (servers.empty()) {
+        throw std::invalid_argument("Server list cannot be empty");
+    }
+
+    setDefaultLatency(defaultLatency);
+}
+
+// Copy constructor (the base copies the engines and their settings)
+PeakEwmaLoadBalancer::PeakEwmaLoadBalancer(const PeakEwmaLoadBalancer& other)
+    : LoadBalancer(other)
+{
+}
+
+// Move constructor
+PeakEwmaLoadBalancer::PeakEwmaLoadBalancer(PeakEwmaLoadBalancer&& other) noexcept
+    : LoadBalancer(std::move(other))
+{
+}
+
+// Copy assignment operator
+PeakEwmaLoadBalancer& PeakEwmaLoadBalancer::operator=(const PeakEwmaLoadBalancer& other)
+{
+    if (this != &other) {
+        LoadBalancer::operator=(other);
+    }
+    return *this;
+}
+
+// Move assignment operator
+PeakEwmaLoadBalancer& PeakEwmaLoadBalancer::operator=(PeakEwmaLoadBalancer&& other) noexcept
+{
+    if (this != &other) {
+        LoadBalancer::operator=(std::move(other));
+    }
+    return *this;
+}
+
+// Destructor
+PeakEwmaLoadBalancer::~PeakEwmaLoadBalancer() = default;
+
+// Configuration
+void PeakEwmaLoadBalancer::setDefaultLatency(std::chrono::microseconds latency)
+{
+    engineAs<PeakEwmaEngine>().setDefaultLatency(latency);
+}
+
+std::chrono::microseconds PeakEwmaLoadBalancer::getDefaultLatency() const
+{
+    return engineAs<PeakEwmaEngine>().getDefaultLatency();
+}
@@ -1,6 +1,8 @@
 #include "ping_server.hpp"
+#include "health_check_scheduler.hpp"
 #include <thread>
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -31,7 +33,6 @@ PingServer::PingServer(
     _interval(interval),
     _isRunning(false),
     _threadPoolSize(4),
-    _dnsCacheTTL(300), // Default 5 minutes
     _pingImplementation(std::bind(&PingServer::defaultPingImplementation, 
                                  this, 
                                  std::placeholders::_1, 
@@ -55,95 +56,24 @@ PingServer::~PingServer()
     #endif
 }
 
-// Parse server address to extract hostname/IP and port
-bool PingServer::parseServerAddress(const std::string& serverAddress, std::string& host, int& port)
-{
-    size_t colonPos = serverAddress.find(':');
-    if (colonPos == std::string::npos) {
-        // No port specified, use default HTTP port
-        host = serverAddress;
-        port = 80; 
-        return true;
-    }
-    
-    host = serverAddress.substr(0, colonPos);
-    try {
-        port = std::stoi(serverAddress.substr(colonPos + 1));
-        return true;
-    } catch (...) {
-        return false; // Invalid port
-    }
-}
-
-// DNS resolution with caching
-std::string PingServer::resolveHostname(const std::string& hostname)
-{
-    // Check if IP address (simple check)
-    struct sockaddr_in sa;
-    if (inet_pton(AF_INET, hostname.c_str(), &(sa.sin_addr)) == 1) {
-        return hostname; // Already an IPv4 address
-    }
-    
-    // Check cache first
-    {
-        std::lock_guard<std::mutex> lock(_dnsCacheMutex);
-        auto it = _dnsCache.find(hostname);
-        
-        if (it != _dnsCache.end() && 
-            it->second.expiryTime > std::chrono::steady_clock::now()) {
-            return it->second.resolvedIP;
-        }
-    }
-    
-    // Perform DNS resolution
-    struct addrinfo hints, *result;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_INET;
-    hints.ai_socktype = SOCK_STREAM;
-    
-    if (getaddrinfo(hostname.c_str(), nullptr, &hints, &result) != 0) {
-        return ""; // Resolution failed
-    }
-    
-    char ipStr[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, 
-              &((struct sockaddr_in*)result->ai_addr)->sin_addr,
-              ipStr, 
-              INET_ADDRSTRLEN);
-    
-    std::string resolvedIP = ipStr;
-    freeaddrinfo(result);
-    
-    // Update cache
-    {
-        std::lock_guard<std::mutex> lock(_dnsCacheMutex);
-        _dnsCache[hostname] = {
-            resolvedIP,
-            std::chrono::steady_clock::now() + _dnsCacheTTL
-        };
-    }
-    
-    return resolvedIP;
-}
-
 // Default ping implementation (TCP connect)
 bool PingServer::defaultPingImplementation(const std::string& serverAddress, std::chrono::milliseconds timeout)
 {
     std::string host;
-    int port;
+    uint16_t port;
     
-    if (!parseServerAddress(serverAddress, host, port)) {
+    if (!ServerEndpoint::parseAddress(serverAddress, host, port)) {
         return false; // Invalid address format
     }
     
     // Resolve hostname with caching
-    std::string resolvedIP = resolveHostname(host);
-    if (resolvedIP.empty()) {
+    ServerEndpoint target;
+    if (!resolveEndpoint(host, port, target, timeout)) {
         return false; // Resolution failed
     }
     
     // Create socket
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    int sock = socket(target.address.ss_family, SOCK_STREAM, 0);
     if (sock < 0) {
         return false;
     }
@@ -157,15 +87,8 @@ bool PingServer::defaultPingImplementation(const std::string& serverAddress, std
         fcntl(sock, F_SETFL, flags | O_NONBLOCK);
     #endif
     
-    // Set up address structure
-    struct sockaddr_in serverAddr;
-    memset(&serverAddr, 0, sizeof(serverAddr));
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(port);
-    inet_pton(AF_INET, resolvedIP.c_str(), &(serverAddr.sin_addr));
-    
     // Try to connect
-    int connectResult = connect(sock, (struct sockaddr*)&serverAddr, sizeof(serverAddr));
+    int connectResult = connect(sock, (struct sockaddr*)&target.address, target.length);
     
     // Check for immediate success or in-progress
     bool success = false;
@@ -206,7 +129,135 @@ bool PingServer::defaultPingImplementation(const std::string& serverAddress, std
     return success;
 }
 
-// Parallel ping implementation
+// Record a probe result on the server
+void PingServer::applyPingResult(Server& server, bool result, std::chrono::nanoseconds elapsed)
+{
+    server.getMetrics().recordProbe(result, elapsed);
+    
+    // Update server status; an ejected server stays out until its ejection ends
+    server.setHealthy(result && !server.isEjected());
+    server.updateLastHealthCheck();
+    
+    // Track failures
+    if (!result) {
+        server.incrementFailures();
+        
+        // If too many consecutive failures, mark as not alive
+        if (server.getFailureCount() >= 3) { // Configurable threshold
+            server.setAlive(false);
+        }
+    } else {
+        // Reset failures and ensure it's marked alive
+        server.resetFailures();
+        server.setAlive(true);
+    }
+}
+
+// Pooled sockets stand in for a successful probe
+void PingServer::applyPooledLiveness(Server& server)
+{
+    server.setHealthy(!server.isEjected());
+    server.updateLastHealthCheck();
+    server.resetFailures();
+    server.setAlive(true);
+}
+
+// Resolve host and port into a binary endpoint
+bool PingServer::resolveEndpoint(const std::string& host, uint16_t port, ServerEndpoint& endpoint, std::chrono::milliseconds wait)
+{
+    DnsResolver::Clock::time_point refreshAt;
+    DnsResolver::RecordsPtr records = _resolver.resolve(host, wait, &refreshAt);
+    if (!records) {
+        return false; // Resolution failed
+    }
+    
+    // First record; the resolver keeps the rest for failover
+    const ResolvedAddress& record = records->front();
+    endpoint = ServerEndpoint();
+    memcpy(&endpoint.address, &record.address, record.length);
+    endpoint.length = record.length;
+    endpoint.refreshAt = refreshAt;
+    endpoint.setPort(port);
+    return true;
+}
+
+// Multiplexed ping implementation
+bool PingServer::multiplexedPingImplementation(std::vector<std::shared_ptr<Server>>& servers,
+                                              std::chrono::milliseconds timeout)
+{
+    auto now = std::chrono::steady_clock::now();
+    std::vector<ServerEndpoint> endpoints(servers.size());
+    std::vector<size_t> stale;
+    
+    // Servers with a current endpoint go straight to connect(); queue lookups for the rest
+    for (size_t i = 0; i < servers.size(); ++i) {
+        Server& server = *servers[i];
+        if (!server.hasValidAddress()) {
+            continue;
+        }
+        if (!server.getEndpoint(endpoints[i]) || now >= endpoints[i].refreshAt) {
+            _resolver.prefetch(server.getHost());
+            stale.push_back(i);
+        }
+    }
+    
+    // Cold lookups share one timeout budget for the whole sweep
+    auto resolveDeadline = now + timeout;
+    
+    for (size_t i : stale) {
+        Server& server = *servers[i];
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(resolveDeadline - std::chrono::steady_clock::now());
+        wait = (std::max)(wait, std::chrono::milliseconds(0));
+        
+        ServerEndpoint resolved;
+        if (resolveEndpoint(server.getHost(), server.getPort(), resolved, wait)) {
+            // Republish only when the address or its refresh time moved
+            if (!resolved.sameAddress(endpoints[i]) || resolved.refreshAt != endpoints[i].refreshAt) {
+                server.setEndpoint(resolved);
+            }
+            endpoints[i] = resolved;
+        }
+        // On failure a previously known endpoint keeps being probed
+    }
+    
+    // A live keepalive socket already proves the backend accepts connections
+    std::vector<ProbeTarget> targets;
+    targets.reserve(servers.size());
+    for (size_t i = 0; i < servers.size(); ++i) {
+        ConnectionPool* pool = servers[i]->getConnectionPool();
+        if (pool && endpoints[i].length != 0 && pool->maintain(endpoints[i], now) > 0) {
+            applyPooledLiveness(*servers[i]);
+            continue;
+        }
+        
+        ProbeTarget& target = targets.emplace_back();
+        target.id = i;
+        target.address = endpoints[i].address;
+        target.addressLength = endpoints[i].length; // 0 is reported as failed by the engine
+    }
+    
+    bool allSuccessful = true;
+    {
+        std::lock_guard<std::mutex> lock(_probeEngineMutex);
+        _probeEngine.setMaxInFlight(_maxProbesInFlight.load());
+        _probeEngine.run(targets, timeout, [&servers, &allSuccessful](size_t id, bool result, std::chrono::nanoseconds elapsed) {
+            applyPingResult(*servers[id], result, elapsed);
+            allSuccessful = allSuccessful && result;
+        });
+    }
+    
+    // Top pools of healthy servers back up to their target, off the request path
+    for (size_t i = 0; i < servers.size(); ++i) {
+        ConnectionPool* pool = servers[i]->getConnectionPool();
+        if (pool && endpoints[i].length != 0 && servers[i]->isHealthy()) {
+            pool->prewarm(endpoints[i]);
+        }
+    }
+    
+    return allSuccessful;
+}
+
+// Parallel ping implementation (custom ping implementations may block, so they get threads)
 bool PingServer::parallelPingImplementation(std::vector<std::shared_ptr<Server>>& servers, 
                                           std::chrono::milliseconds timeout)
 {
@@ -214,6 +265,10 @@ bool PingServer::parallelPingImplementation(std::vector<std::shared_ptr<Server>>
         return true;
     }
     
+    if (_usingDefaultPing.load()) {
+        return multiplexedPingImplementation(servers, timeout);
+    }
+    
     size_t serverCount = servers.size();
     size_t poolSize = (std::min)(_threadPoolSize.load(), serverCount);
     
@@ -235,26 +290,12 @@ bool PingServer::parallelPingImplementation(std::vector<std::shared_ptr<Server>>
                 }
                 
                 auto& server = servers[index];
+                auto started = std::chrono::steady_clock::now();
                 bool result = _pingImplementation(server->getServerAddress(), timeout);
+                applyPingResult(*server, result, std::chrono::steady_clock::now() - started);
                 
-                // Update server status
-                server->setHealthy(result);
-                server->updateLastHealthCheck();
-                
-                // Track failures
                 if (!result) {
-                    server->incrementFailures();
-                    
-                    // If too many consecutive failures, mark as not alive
-                    if (server->getFailureCount() >= 3) { // Configurable threshold
-                        server->setAlive(false);
-                    }
-                    
                     allSuccessful.store(false);
-                } else {
-                    // Reset failures and ensure it's marked alive
-                    server->resetFailures();
-                    server->setAlive(true);
                 }
             }
         }));
@@ -275,21 +316,9 @@ bool PingServer::pingServer(const std::shared_ptr<Server>& server)
         return false;
     }
     
+    auto started = std::chrono::steady_clock::now();
     bool result = _pingImplementation(server->getServerAddress(), _timeout);
-    
-    // Update server status
-    server->setHealthy(result);
-    server->updateLastHealthCheck();
-    
-    if (!result) {
-        server->incrementFailures();
-        if (server->getFailureCount() >= 3) { // Configurable threshold
-            server->setAlive(false);
-        }
-    } else {
-        server->resetFailures();
-        server->setAlive(true);
-    }
+    applyPingResult(*server, result, std::chrono::steady_clock::now() - started);
     
     return result;
 }
@@ -348,20 +377,31 @@ bool PingServer::isBackgroundPingRunning() const
 // Background ping worker
 void PingServer::pingWorker(const std::vector<std::shared_ptr<Server>>& servers)
 {
+    // Spread probes over the interval instead of pinging every server at once
+    HealthCheckScheduler scheduler(_interval);
+    
     while (_isRunning.load()) {
-        // Ping all servers in parallel
-        pingServers(servers);
+        auto due = scheduler.collectDue(servers, HealthCheckScheduler::Clock::now());
+        if (!due.empty()) {
+            pingServers(due);
+            scheduler.recordResults(due, HealthCheckScheduler::Clock::now());
+        }
         
-        // Sleep for the interval
-        std::this_thread::sleep_for(_interval);
+        // Sleep until the next batch is due
+        scheduler.setBaseInterval(_interval);
+        std::this_thread::sleep_until(scheduler.nextWakeup(HealthCheckScheduler::Clock::now()));
     }
 }
 
 // Clear DNS cache
 void PingServer::clearDNSCache()
 {
-    std::lock_guard<std::mutex> lock(_dnsCacheMutex);
-    _dnsCache.clear();
+    _resolver.clear();
+}
+
+DnsResolver::Stats PingServer::getDNSCacheStats() const
+{
+    return _resolver.getStats();
 }
 
 // Configuration methods
@@ -395,14 +435,24 @@ size_t PingServer::getThreadPoolSize() const
     return _threadPoolSize.load();
 }
 
+void PingServer::setMaxProbesInFlight(size_t count)
+{
+    _maxProbesInFlight.store(count > 0 ? count : 1);
+}
+
+size_t PingServer::getMaxProbesInFlight() const
+{
+    return _maxProbesInFlight.load();
+}
+
 void PingServer::setDNSCacheTTL(std::chrono::seconds ttl)
 {
-    _dnsCacheTTL = ttl;
+    _resolver.setTTL(ttl);
 }
 
 std::chrono::seconds PingServer::getDNSCacheTTL() const
 {
-    return _dnsCacheTTL;
+    return _resolver.getTTL();
 }
 
 // Set custom ping implementation
@@ -410,6 +460,7 @@ void PingServer::setPingImplementation(PingImplementation implementation)
 {
     if (implementation) {
         _pingImplementation = implementation;
+        _usingDefaultPing.store(false);
     }
 }
 
@@ -420,4 +471,5 @@ void PingServer::resetPingImplementation()
                                    this, 
                                    std::placeholders::_1, 
                                    std::placeholders::_2);
+    _usingDefaultPing.store(true);
 }
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "probe_engine.hpp"
+#include <algorithm>
+
+// Platform-specific includes
+#ifdef _WIN32
+    #define close closesocket
+#else
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <errno.h>
+    #ifdef __linux__
+        #include <sys/epoll.h>
+    #endif
+#endif
+
+namespace {
+    constexpr int kMaxEventsPerWait = 256;
+
+    // Non-blocking, close-on-exec TCP socket for the target's address family
+    int openProbeSocket(int family)
+    {
+        #if defined(__linux__)
+            return ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        #elif defined(_WIN32)
+            int sock = static_cast<int>(::socket(family, SOCK_STREAM, 0));
+            if (sock >= 0) {
+                u_long mode = 1;
+                ioctlsocket(sock, FIONBIO, &mode);
+            }
+            return sock;
+        #else
+            int sock = ::socket(family, SOCK_STREAM, 0);
+            if (sock >= 0) {
+                fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+                fcntl(sock, F_SETFD, FD_CLOEXEC);
+            }
+            return sock;
+        #endif
+    }
+
+    bool connectInProgress()
+    {
+        #ifdef _WIN32
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        #else
+            return errno == EINPROGRESS;
+        #endif
+    }
+
+    bool outOfDescriptors()
+    {
+        #ifdef _WIN32
+            return WSAGetLastError() == WSAEMFILE;
+        #else
+            return errno == EMFILE || errno == ENFILE;
+        #endif
+    }
+
+    bool socketConnected(int sock)
+    {
+        int error = 0;
+        socklen_t len = sizeof(error);
+
+        #ifdef _WIN32
+            if (getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)&error, &len) != 0) {
+        #else
+            if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &len) != 0) {
+        #endif
+                return false;
+            }
+        return error == 0;
+    }
+}
+
+// Constructor
+ProbeEngine::ProbeEngine(size_t maxInFlight, std::chrono::milliseconds tick)
+    : _maxInFlight(maxInFlight > 0 ? maxInFlight : 1),
+      _tick(tick.count() > 0 ? tick : std::chrono::milliseconds(1))
+{
+    #ifdef __linux__
+        // Falls back to poll() if no epoll instance is available
+        _pollFd = epoll_create1(EPOLL_CLOEXEC);
+    #endif
+}
+
+// Destructor
+ProbeEngine::~ProbeEngine()
+{
+    for (auto& slot : _slots) {
+        if (slot.fd >= 0) {
+            close(slot.fd);
+        }
+    }
+
+    #ifdef __linux__
+        if (_pollFd >= 0) {
+            ::close(_pollFd);
+        }
+    #endif
+}
+
+uint64_t ProbeEngine::currentTick(std::chrono::steady_clock::time_point start) const
+{
+    return static_cast<uint64_t>((std::chrono::steady_clock::now() - start) / _tick);
+}
+
+bool ProbeEngine::launch(const ProbeTarget& target, uint64_t deadlineTick, const Completion& onComplete)
+{
+    int sock = openProbeSocket(target.address.ss_family);
+    if (sock < 0) {
+        // Out of descriptors: retry once some of the outstanding probes have finished
+        if (outOfDescriptors() && _inFlightCount > 0) {
+            return false;
+        }
+        onComplete(target.id, false, std::chrono::nanoseconds(0));
+        return true;
+    }
+
+    auto startedAt = std::chrono::steady_clock::now();
+    int connectResult = ::connect(sock, reinterpret_cast<const sockaddr*>(&target.address), target.addressLength);
+    if (connectResult == 0 || !connectInProgress()) {
+        // Finished (or failed) synchronously, nothing to wait for
+        close(sock);
+        onComplete(target.id, connectResult == 0, std::chrono::steady_clock::now() - startedAt);
+        return true;
+    }
+
+    uint32_t slot;
+    if (!_freeSlots.empty()) {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(_slots.size());
+        _slots.emplace_back();
+    }
+
+    InFlight& probe = _slots[slot];
+    probe.fd = sock;
+    probe.id = target.id;
+    probe.deadlineTick = deadlineTick;
+    probe.startedAt = startedAt;
+
+    #ifdef __linux__
+        if (_pollFd >= 0) {
+            epoll_event event{};
+            event.events = EPOLLOUT;
+            event.data.u32 = slot;
+            if (epoll_ctl(_pollFd, EPOLL_CTL_ADD, sock, &event) != 0) {
+                ++_inFlightCount;
+                finish(slot, false, onComplete);
+                return true;
+            }
+        }
+    #endif
+
+    _wheel[deadlineTick & (_wheel.size() - 1)].push_back({slot, probe.generation});
+    ++_inFlightCount;
+    return true;
+}
+
+void ProbeEngine::finish(uint32_t slot, bool success, const Completion& onComplete)
+{
+    InFlight& probe = _slots[slot];
+
+    // Closing the socket also drops it from the epoll set
+    close(probe.fd);
+    probe.fd = -1;
+    probe.generation++;
+    _freeSlots.push_back(slot);
+    --_inFlightCount;
+
+    onComplete(probe.id, success, std::chrono::steady_clock::now() - probe.startedAt);
+}
+
+void ProbeEngine::waitForEvents(int waitMs, const Completion& onComplete)
+{
+    #ifdef __linux__
+        if (_pollFd >= 0) {
+            epoll_event events[kMaxEventsPerWait];
+            int ready = epoll_wait(_pollFd, events, kMaxEventsPerWait, waitMs);
+
+            for (int i = 0; i < ready; ++i) {
+                uint32_t slot = events[i].data.u32;
+                bool success = !(events[i].events & EPOLLERR) && socketConnected(_slots[slot].fd);
+                finish(slot, success, onComplete);
+            }
+            return;
+        }
+    #endif
+
+    // Portable fallback: rebuild the descriptor set from the outstanding slots
+    std::vector<pollfd> descriptors;
+    std::vector<uint32_t> owners;
+    descriptors.reserve(_inFlightCount);
+    owners.reserve(_inFlightCount);
+
+    for (uint32_t slot = 0; slot < _slots.size(); ++slot) {
+        if (_slots[slot].fd >= 0) {
+            pollfd descriptor{};
+            descriptor.fd = _slots[slot].fd;
+            descriptor.events = POLLOUT;
+            descriptors.push_back(descriptor);
+            owners.push_back(slot);
+        }
+    }
+
+    #ifdef _WIN32
+        int ready = WSAPoll(descriptors.data(), static_cast<ULONG>(descriptors.size()), waitMs);
+    #else
+        int ready = ::poll(descriptors.data(), static_cast<nfds_t>(descriptors.size()), waitMs);
+    #endif
+
+    for (size_t i = 0; i < descriptors.size() && ready > 0; ++i) {
+        if (descriptors[i].revents != 0) {
+            bool success = !(descriptors[i].revents & (POLLERR | POLLHUP)) && socketConnected(descriptors[i].fd);
+            finish(owners[i], success, onComplete);
+            --ready;
+        }
+    }
+}
+
+void ProbeEngine::expire(uint64_t fromTick, uint64_t nowTick, const Completion& onComplete)
+{
+    // A gap longer than the wheel visits every bucket once
+    uint64_t bucketCount = _wheel.size();
+    uint64_t steps = (std::min)(nowTick - fromTick + 1, bucketCount);
+
+    for (uint64_t step = 0; step < steps; ++step) {
+        auto& bucket = _wheel[(fromTick + step) & (bucketCount - 1)];
+        size_t kept = 0;
+
+        for (size_t i = 0; i < bucket.size(); ++i) {
+            TimerEntry entry = bucket[i];
+            const InFlight& probe = _slots[entry.slot];
+
+            if (probe.fd < 0 || probe.generation != entry.generation) {
+                continue; // Already completed
+            }
+            if (probe.deadlineTick <= nowTick) {
+                finish(entry.slot, false, onComplete);
+            } else {
+                bucket[kept++] = entry;
+            }
+        }
+        bucket.resize(kept);
+    }
+}
+
+// Run every target to completion on the calling thread
+void ProbeEngine::run(const std::vector<ProbeTarget>& targets, std::chrono::milliseconds timeout, const Completion& onComplete)
+{
+    if (targets.empty()) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t timeoutTicks = (std::max)(static_cast<uint64_t>((timeout + _tick - std::chrono::milliseconds(1)) / _tick),
+                                       uint64_t(1));
+
+    // Size the wheel to cover the timeout so each entry lands in a bucket exactly once
+    size_t bucketCount = 1;
+    while (bucketCount <= timeoutTicks) {
+        bucketCount <<= 1;
+    }
+    _wheel.assign(bucketCount, {});
+
+    size_t next = 0;
+    uint64_t processedTick = 0;
+
+    while (next < targets.size() || _inFlightCount > 0) {
+        // Top up the in-flight window
+        while (next < targets.size() && _inFlightCount < _maxInFlight) {
+            const ProbeTarget& target = targets[next];
+            if (target.addressLength == 0) {
+                onComplete(target.id, false, std::chrono::nanoseconds(0));
+            } else if (!launch(target, currentTick(start) + timeoutTicks, onComplete)) {
+                break;
+            }
+            ++next;
+        }
+
+        if (_inFlightCount == 0) {
+            continue;
+        }
+
+        // Sleep until socket activity or the next wheel tick
+        auto tickEnd = start + _tick * (currentTick(start) + 1);
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(tickEnd - std::chrono::steady_clock::now());
+        waitForEvents(static_cast<int>((std::max)(remaining.count(), std::chrono::milliseconds::rep(0))), onComplete);
+
+        uint64_t nowTick = currentTick(start);
+        if (nowTick > processedTick) {
+            expire(processedTick + 1, nowTick, onComplete);
+            processedTick = nowTick;
+        }
+    }
+}
+
+// Configuration
+void ProbeEngine::setMaxInFlight(size_t maxInFlight)
+{
+    _maxInFlight = maxInFlight > 0 ? maxInFlight : 1;
+}
+
+size_t ProbeEngine::getMaxInFlight() const
+{
+    return _maxInFlight;
+}
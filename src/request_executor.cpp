@@ -0,0 +1,520 @@
+#include "request_executor.hpp"
+#include "round_robin_load_balancer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Process-wide timer thread firing hedge delays. A fired entry only queues its event; the
+    // request it wakes resumes on one of a few worker threads, so a request function or caller
+    // that blocks after a hedge never holds up the timers of other requests.
+    class HedgeTimer {
+    private:
+        struct Entry {
+            Clock::time_point                               due;
+            std::function<void()>                           fire;
+
+            bool operator>(const Entry& other) const { return due > other.due; }
+        };
+
+        std::mutex                                          _mutex;
+        std::condition_variable                             _wake;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<>> _queue;                                      // Earliest first
+        std::mutex                                          _workMutex;
+        std::condition_variable                             _workReady;
+        std::deque<std::coroutine_handle<>>                 _work;                                                  // Requests woken by a hedge delay
+
+        HedgeTimer()
+        {
+            std::thread([this]() { run(); }).detach();
+            unsigned workers = std::clamp(std::thread::hardware_concurrency(), 2u, 8u);
+            for (unsigned i = 0; i < workers; ++i) {
+                std::thread([this]() { work(); }).detach();
+            }
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            for (;;) {
+                if (_queue.empty()) {
+                    _wake.wait(lock);
+                    continue;
+                }
+                // Copy the deadline: pushes while waiting may reallocate the queue
+                Clock::time_point due = _queue.top().due;
+                if (due > Clock::now()) {
+                    _wake.wait_until(lock, due);
+                    continue;
+                }
+
+                Entry entry = _queue.top();
+                _queue.pop();
+                lock.unlock();
+                entry.fire();
+                lock.lock();
+            }
+        }
+
+        void work()
+        {
+            std::unique_lock<std::mutex> lock(_workMutex);
+            for (;;) {
+                _workReady.wait(lock, [this]() { return !_work.empty(); });
+                std::coroutine_handle<> handle = _work.front();
+                _work.pop_front();
+                lock.unlock();
+                handle.resume();
+                lock.lock();
+            }
+        }
+
+    public:
+        // Leaked so the threads never outlive it
+        static HedgeTimer& instance()
+        {
+            static HedgeTimer* timer = new HedgeTimer();
+            return *timer;
+        }
+
+        // Run `fire` on the timer thread at `due`; it must not block
+        void schedule(Clock::time_point due, std::function<void()> fire)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _queue.push({due, std::move(fire)});
+            }
+            _wake.notify_one();
+        }
+
+        // Resume a woken request on a worker thread
+        void resumeOnWorker(std::coroutine_handle<> handle)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_workMutex);
+                _work.push_back(handle);
+            }
+            _workReady.notify_one();
+        }
+    };
+
+    size_t latencyBucket(std::chrono::nanoseconds latency)
+    {
+        double micros = static_cast<double>(latency.count()) / 1000.0;
+        if (micros <= 1.0) {
+            return 0;
+        }
+        auto bucket = static_cast<size_t>(std::log2(micros) * 4.0);
+        return (std::min)(bucket, RequestExecutor::kLatencyBuckets - 1);
+    }
+
+    // Upper bound of a latency bucket
+    std::chrono::nanoseconds bucketBound(size_t bucket)
+    {
+        return std::chrono::nanoseconds(static_cast<int64_t>(1000.0 * std::exp2(static_cast<double>(bucket + 1) / 4.0)));
+    }
+}
+
+// Attempts of one request; finished attempts and hedge timers queue events and wake it
+struct RequestExecutor::Race {
+    struct Event {
+        uint32_t                                            attempt{0};
+        bool                                                success{false};
+        bool                                                timer{false};                                           // Hedge delay elapsed
+        uint32_t                                            generation{0};                                          // Timer arming it belongs to
+    };
+
+    RequestFunction                                         fn;
+    std::mutex                                              mutex;
+    std::deque<Event>                                       events;
+    std::coroutine_handle<>                                 waiter;                                                 // Request suspended in next()
+
+    // Queue an event and hand back the request if it waits
+    std::coroutine_handle<> queue(const Event& event)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(event);
+        return std::exchange(waiter, {});
+    }
+
+    // Finished attempt: resume the request on this thread if it waits
+    void push(const Event& event)
+    {
+        if (std::coroutine_handle<> resume = queue(event)) {
+            resume.resume();
+        }
+    }
+
+    // Hedge delay (on the timer thread): resume the request on a hedge worker if it waits
+    void post(const Event& event)
+    {
+        if (std::coroutine_handle<> resume = queue(event)) {
+            HedgeTimer::instance().resumeOnWorker(resume);
+        }
+    }
+
+    struct NextEvent {
+        Race&                                               race;
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            std::lock_guard<std::mutex> lock(race.mutex);
+            if (!race.events.empty()) {
+                return false;
+            }
+            race.waiter = handle;
+            return true;
+        }
+
+        Event await_resume()
+        {
+            std::lock_guard<std::mutex> lock(race.mutex);
+            Event event = race.events.front();
+            race.events.pop_front();
+            return event;
+        }
+    };
+
+    // Wait for the next event
+    NextEvent next() { return NextEvent{*this}; }
+};
+
+// Constructor
+RequestExecutor::RequestExecutor()
+    : _budgetBalance(static_cast<int64_t>(_minRetries.load()) * kTokenScale),
+      _budgetRefilledAt(Clock::now().time_since_epoch().count())
+{
+}
+
+// Copy constructor
+RequestExecutor::RequestExecutor(const RequestExecutor& other)
+    : _maxAttempts(other._maxAttempts.load()),
+      _retryRatio(other._retryRatio.load()),
+      _minRetries(other._minRetries.load()),
+      _hedging(other._hedging.load()),
+      _hedgePercentile(other._hedgePercentile.load()),
+      _maxHedges(other._maxHedges.load()),
+      _minHedgeSamples(other._minHedgeSamples.load()),
+      _minHedgeDelay(other._minHedgeDelay.load()),
+      _budgetBalance(static_cast<int64_t>(other._minRetries.load()) * kTokenScale),
+      _budgetRefilledAt(Clock::now().time_since_epoch().count())
+{
+}
+
+// Copy assignment
+RequestExecutor& RequestExecutor::operator=(const RequestExecutor& other)
+{
+    if (this != &other) {
+        _maxAttempts.store(other._maxAttempts.load());
+        _retryRatio.store(other._retryRatio.load());
+        _minRetries.store(other._minRetries.load());
+        _hedging.store(other._hedging.load());
+        _hedgePercentile.store(other._hedgePercentile.load());
+        _maxHedges.store(other._maxHedges.load());
+        _minHedgeSamples.store(other._minHedgeSamples.load());
+        _minHedgeDelay.store(other._minHedgeDelay.load());
+    }
+    return *this;
+}
+
+// Retry budget
+void RequestExecutor::depositBudget()
+{
+    int64_t minTokens = static_cast<int64_t>(_minRetries.load(std::memory_order_relaxed));
+    int64_t deposit = static_cast<int64_t>(_retryRatio.load(std::memory_order_relaxed) * kTokenScale);
+
+    // One caller per elapsed second adds the per-second reserve
+    auto now = Clock::now().time_since_epoch().count();
+    auto refilledAt = _budgetRefilledAt.load(std::memory_order_relaxed);
+    if (Clock::duration(now - refilledAt) >= std::chrono::seconds(1) &&
+        _budgetRefilledAt.compare_exchange_strong(refilledAt, now, std::memory_order_relaxed)) {
+        deposit += minTokens * kTokenScale;
+    }
+
+    int64_t cap = (minTokens + kMaxBudgetTokens) * kTokenScale;
+    int64_t balance = _budgetBalance.load(std::memory_order_relaxed);
+    while (balance < cap &&
+           !_budgetBalance.compare_exchange_weak(balance, (std::min)(balance + deposit, cap), std::memory_order_relaxed)) {
+    }
+}
+
+bool RequestExecutor::withdrawBudget()
+{
+    int64_t balance = _budgetBalance.load(std::memory_order_relaxed);
+    while (balance >= kTokenScale) {
+        if (_budgetBalance.compare_exchange_weak(balance, balance - kTokenScale, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    _budgetExhausted.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+// Latency window
+void RequestExecutor::recordLatency(std::chrono::nanoseconds latency)
+{
+    _latencyBuckets[latencyBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+
+    // Halve the counts once the window fills twice, so old latencies fade out
+    if (_latencySamples.fetch_add(1, std::memory_order_relaxed) + 1 == 2 * kLatencyWindow) {
+        for (auto& bucket : _latencyBuckets) {
+            bucket.store(bucket.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+        }
+        _latencySamples.fetch_sub(kLatencyWindow, std::memory_order_relaxed);
+    }
+}
+
+std::chrono::nanoseconds RequestExecutor::latencyPercentile(double percentile) const
+{
+    std::array<uint32_t, kLatencyBuckets> counts;
+    uint64_t total = 0;
+    for (size_t bucket = 0; bucket < kLatencyBuckets; ++bucket) {
+        counts[bucket] = _latencyBuckets[bucket].load(std::memory_order_relaxed);
+        total += counts[bucket];
+    }
+    if (total == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    auto rank = static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(total)));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kLatencyBuckets; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return bucketBound(bucket);
+        }
+    }
+    return bucketBound(kLatencyBuckets - 1);
+}
+
+std::chrono::nanoseconds RequestExecutor::getHedgeDelay() const
+{
+    if (!_hedging.load(std::memory_order_relaxed) ||
+        _latencySamples.load(std::memory_order_relaxed) < _minHedgeSamples.load(std::memory_order_relaxed)) {
+        return std::chrono::nanoseconds(0);
+    }
+    return (std::max)(latencyPercentile(_hedgePercentile.load(std::memory_order_relaxed)),
+                      std::chrono::nanoseconds(getMinHedgeDelay()));
+}
+
+// Attempts
+ServerLease RequestExecutor::leaseUntried(LoadBalancer& balancer, const std::vector<const Server*>& tried)
+{
+    ServerLease fallback;
+    for (size_t pick = 0; pick < kUntriedPicks; ++pick) {
+        ServerLease lease = balancer.acquireNextServer();
+        if (!lease) {
+            break;
+        }
+        if (std::find(tried.begin(), tried.end(), lease.get()) == tried.end()) {
+            return lease;
+        }
+        fallback = std::move(lease);
+    }
+
+    // Every pick was a server already tried; going back to it beats failing
+    return fallback;
+}
+
+DetachedTask RequestExecutor::runAttempt(std::shared_ptr<Race> race, ServerLease lease, uint32_t attempt, RequestExecutor* executor)
+{
+    auto started = Clock::now();
+    bool success = false;
+    try {
+        success = co_await race->fn(*lease, attempt);
+    } catch (...) {
+        success = false;
+    }
+
+    if (success) {
+        executor->recordLatency(Clock::now() - started);
+    }
+    lease.complete(success);
+    race->push({attempt, success, false, 0});
+}
+
+Task<ExecutionResult> RequestExecutor::execute(LoadBalancer& balancer, RequestFunction fn)
+{
+    _requests.fetch_add(1, std::memory_order_relaxed);
+    depositBudget();
+
+    auto race = std::make_shared<Race>();
+    race->fn = std::move(fn);
+
+    ExecutionResult result;
+    std::vector<const Server*> tried;
+    std::vector<std::string> addresses;                     // Per attempt
+    std::vector<bool> isHedge;                              // Per attempt
+    uint32_t running = 0;
+    uint32_t timerGeneration = 0;
+    uint32_t maxAttempts = getMaxAttempts();
+    uint32_t maxHedges = getMaxHedges();
+
+    auto startAttempt = [&](bool hedge) {
+        ServerLease lease = leaseUntried(balancer, tried);
+        if (!lease) {
+            return false;
+        }
+        tried.push_back(lease.get());
+        addresses.push_back(lease->getServerAddress());
+        isHedge.push_back(hedge);
+        result.serverAddress = addresses.back();
+        ++running;
+        runAttempt(race, std::move(lease), result.attempts++, this);
+        return true;
+    };
+
+    // Hedge the outstanding attempts if they are still out after the hedge delay
+    auto armHedge = [&]() {
+        ++timerGeneration;
+        std::chrono::nanoseconds delay = getHedgeDelay();
+        if (delay.count() == 0 || result.hedges >= maxHedges || result.attempts >= maxAttempts) {
+            return;
+        }
+        std::weak_ptr<Race> weak = race;
+        uint32_t generation = timerGeneration;
+        HedgeTimer::instance().schedule(Clock::now() + delay, [weak, generation]() {
+            if (auto pending = weak.lock()) {
+                pending->post({0, false, true, generation});
+            }
+        });
+    };
+
+    if (!startAttempt(false)) {
+        co_return result;
+    }
+    result.status = ExecutionStatus::FAILED;
+    armHedge();
+
+    for (;;) {
+        Race::Event event = co_await race->next();
+
+        if (event.timer) {
+            if (event.generation == timerGeneration && running > 0 && withdrawBudget() && startAttempt(true)) {
+                ++result.hedges;
+                _hedges.fetch_add(1, std::memory_order_relaxed);
+                armHedge();
+            }
+            continue;
+        }
+
+        --running;
+        if (event.success) {
+            result.status = ExecutionStatus::SUCCEEDED;
+            result.winningAttempt = event.attempt;
+            result.serverAddress = addresses[event.attempt];
+            if (isHedge[event.attempt]) {
+                _hedgeWins.fetch_add(1, std::memory_order_relaxed);
+            }
+            co_return result;
+        }
+
+        // A hedge still out may yet succeed
+        if (running > 0) {
+            continue;
+        }
+        if (result.attempts >= maxAttempts || !withdrawBudget() || !startAttempt(false)) {
+            co_return result;
+        }
+        ++result.retries;
+        _retries.fetch_add(1, std::memory_order_relaxed);
+        armHedge();
+    }
+}
+
+RequestExecutor::Stats RequestExecutor::getStats() const
+{
+    Stats stats;
+    stats.requests = _requests.load(std::memory_order_relaxed);
+    stats.retries = _retries.load(std::memory_order_relaxed);
+    stats.hedges = _hedges.load(std::memory_order_relaxed);
+    stats.hedgeWins = _hedgeWins.load(std::memory_order_relaxed);
+    stats.budgetExhausted = _budgetExhausted.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Configuration
+void RequestExecutor::setMaxAttempts(uint32_t attempts)
+{
+    _maxAttempts.store((std::max)(attempts, 1u), std::memory_order_relaxed);
+}
+
+uint32_t RequestExecutor::getMaxAttempts() const
+{
+    return _maxAttempts.load(std::memory_order_relaxed);
+}
+
+void RequestExecutor::setRetryBudget(double ratio, uint32_t minRetriesPerSecond)
+{
+    _retryRatio.store(std::clamp(ratio, 0.0, 1.0), std::memory_order_relaxed);
+    _minRetries.store(minRetriesPerSecond, std::memory_order_relaxed);
+}
+
+double RequestExecutor::getRetryRatio() const
+{
+    return _retryRatio.load(std::memory_order_relaxed);
+}
+
+uint32_t RequestExecutor::getMinRetries() const
+{
+    return _minRetries.load(std::memory_order_relaxed);
+}
+
+void RequestExecutor::setHedging(bool enabled)
+{
+    _hedging.store(enabled, std::memory_order_relaxed);
+}
+
+bool RequestExecutor::isHedging() const
+{
+    return _hedging.load(std::memory_order_relaxed);
+}
+
+void RequestExecutor::setHedgePercentile(double percentile)
+{
+    _hedgePercentile.store(std::clamp(percentile, 0.5, 0.999), std::memory_order_relaxed);
+}
+
+double RequestExecutor::getHedgePercentile() const
+{
+    return _hedgePercentile.load(std::memory_order_relaxed);
+}
+
+void RequestExecutor::setMaxHedges(uint32_t hedges)
+{
+    _maxHedges.store(hedges, std::memory_order_relaxed);
+}
+
+uint32_t RequestExecutor::getMaxHedges() const
+{
+    return _maxHedges.load(std::memory_order_relaxed);
+}
+
+void RequestExecutor::setMinHedgeSamples(uint32_t samples)
+{
+    _minHedgeSamples.store(samples, std::memory_order_relaxed);
+}
+
+uint32_t RequestExecutor::getMinHedgeSamples() const
+{
+    return _minHedgeSamples.load(std::memory_order_relaxed);
+}
+
+void RequestExecutor::setMinHedgeDelay(std::chrono::microseconds delay)
+{
+    _minHedgeDelay.store(delay.count(), std::memory_order_relaxed);
+}
+
+std::chrono::microseconds RequestExecutor::getMinHedgeDelay() const
+{
+    return std::chrono::microseconds(_minHedgeDelay.load(std::memory_order_relaxed));
+}
@@ -3,6 +3,25 @@
 #include <stdexcept>
 #include <thread>
 #include <iostream>
+#include <string_view>
+#include <unordered_set>
+
+namespace {
+    // Point in [0, 1) for a ticket; a Weyl sequence spreads consecutive tickets evenly
+    double admissionPoint(uint64_t ticket)
+    {
+        return static_cast<double>((ticket * 0x9E3779B97F4A7C15ULL) >> 11) * 0x1.0p-53;
+    }
+    
+    // Finalizer from splitmix64
+    uint64_t mix64(uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ULL;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+}
 
 // LoadBalancer base class implementation
 
@@ -12,46 +31,86 @@ LoadBalancer::LoadBalancer(
     LoadBalancingStrategy strategy,
     uint32_t healthCheckInterval,
     uint32_t maxHealthCheckFailures
-) : _serversList(servers),
-    _strategy(strategy),
-    _healthCheckInterval(healthCheckInterval),
+) : _healthCheckInterval(healthCheckInterval),
     _maxHealthCheckFailures(maxHealthCheckFailures),
+    _strategy(strategy),
     _healthCheckRunning(false)
 {
+    {
+        std::lock_guard<std::mutex> lock(_serversMutex);
+        publishSnapshot(servers);
+    }
+
     // Initialize ping server
-    _pingServer = std::make_unique<PingServer>();
+    _pingServer = std::make_shared<PingServer>();
 }
 
 // Copy constructor
 LoadBalancer::LoadBalancer(const LoadBalancer& other)
-    : _strategy(other._strategy),
+    : _outlierDetector(other._outlierDetector),
+      _slowStart(other._slowStart),
+      _concurrencyLimiter(other._concurrencyLimiter),
+      _requestExecutor(other._requestExecutor),
+      _serverPickMetrics(other._serverPickMetrics.load()),
+      _strategy(LoadBalancingStrategy::ROUND_ROBIN),
       _healthCheckRunning(false) // Always start with health checks off
 {
+    auto servers = other.copyServers();
+    
+    {
+        // Same engines with the same settings; the snapshot is rebuilt for them
+        std::lock_guard<std::mutex> otherLock(other._serversMutex);
+        _engines = cloneEngines(other._engines);
+        _strategy.store(other._strategy.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        _localZone = other._localZone;
+        _overflowThreshold = other._overflowThreshold;
+    }
+    
     {
-        std::shared_lock<std::shared_mutex> lock(other._serversMutex);
-        _serversList = other._serversList;
+        std::lock_guard<std::mutex> lock(_serversMutex);
+        publishSnapshot(std::move(servers));
     }
     
     {
         std::lock_guard<std::mutex> configLock(other._configMutex);
         _healthCheckInterval = other._healthCheckInterval;
         _maxHealthCheckFailures = other._maxHealthCheckFailures;
+        _cluster = other._cluster;
     }
     
     // Create a new ping server instance
-    _pingServer = std::make_unique<PingServer>();
+    _pingServer = std::make_shared<PingServer>();
 }
 
 // Move constructor
 LoadBalancer::LoadBalancer(LoadBalancer&& other) noexcept
-    : _serversList(std::move(other._serversList)),
-      _pingServer(std::move(other._pingServer)),
+    : _outlierDetector(other._outlierDetector),
+      _slowStart(other._slowStart),
+      _concurrencyLimiter(other._concurrencyLimiter),
+      _requestExecutor(other._requestExecutor),
+      _serverPickMetrics(other._serverPickMetrics.load()),
+      _strategy(LoadBalancingStrategy::ROUND_ROBIN),
       _healthCheckRunning(false) // Always start with health checks off
 {
+    {
+        // Take over the published snapshot and the engines it points to; the source is left empty
+        std::lock_guard<std::mutex> lock(other._serversMutex);
+        _snapshot.store(other._snapshot.exchange(nullptr, std::memory_order_acq_rel), std::memory_order_release);
+        _engines = std::move(other._engines);
+        _serverIndex = std::move(other._serverIndex);
+        other._serverIndex.clear();
+        _strategy.store(other._strategy.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        _localZone = std::move(other._localZone);
+        _overflowThreshold = other._overflowThreshold;
+    }
+
     std::lock_guard<std::mutex> configLock(other._configMutex);
-    _strategy = other._strategy;
     _healthCheckInterval = other._healthCheckInterval;
     _maxHealthCheckFailures = other._maxHealthCheckFailures;
+    _cluster = std::move(other._cluster);
+    _healthSnapshotPath = std::move(other._healthSnapshotPath);
+    _healthSnapshotInterval = other._healthSnapshotInterval;
+    _pingServer = std::move(other._pingServer);
 }
 
 // Copy assignment
@@ -62,23 +121,46 @@ LoadBalancer& LoadBalancer::operator=(const LoadBalancer& other)
         stopHealthChecks();
         
         {
-            // Copy servers with appropriate locks
-            std::unique_lock<std::shared_mutex> lockThis(_serversMutex);
-            std::shared_lock<std::shared_mutex> lockOther(other._serversMutex);
-            _serversList = other._serversList;
+            // Publish a copy of the other server list, built by copies of its engines
+            auto servers = other.copyServers();
+            EngineTable engines;
+            LoadBalancingStrategy strategy;
+            std::string localZone;
+            double overflowThreshold;
+            {
+                std::lock_guard<std::mutex> otherLock(other._serversMutex);
+                engines = cloneEngines(other._engines);
+                strategy = other._strategy.load(std::memory_order_relaxed);
+                localZone = other._localZone;
+                overflowThreshold = other._overflowThreshold;
+            }
+            
+            std::lock_guard<std::mutex> lock(_serversMutex);
+            std::swap(_engines, engines);
+            _strategy.store(strategy, std::memory_order_relaxed);
+            _localZone = std::move(localZone);
+            _overflowThreshold = overflowThreshold;
+            publishSnapshot(std::move(servers));
+            
+            // Pickers may still be on the previous snapshot and its engine
+            retireEngines(engines);
         }
         
         {
             // Copy configuration with appropriate locks
             std::lock_guard<std::mutex> lockThis(_configMutex);
             std::lock_guard<std::mutex> lockOther(other._configMutex);
-            _strategy = other._strategy;
             _healthCheckInterval = other._healthCheckInterval;
             _maxHealthCheckFailures = other._maxHealthCheckFailures;
+            _cluster = other._cluster;
+            _pingServer = std::make_shared<PingServer>(); // A prober of its own, like the copy constructor
         }
         
-        // Create a new ping server
-        _pingServer = std::make_unique<PingServer>();
+        _outlierDetector = other._outlierDetector;
+        _slowStart = other._slowStart;
+        _concurrencyLimiter = other._concurrencyLimiter;
+        _requestExecutor = other._requestExecutor;
+        _serverPickMetrics.store(other._serverPickMetrics.load());
     }
     return *this;
 }
@@ -91,22 +173,39 @@ LoadBalancer& LoadBalancer::operator=(LoadBalancer&& other) noexcept
         stopHealthChecks();
         
         {
-            // Move servers with appropriate locks
-            std::unique_lock<std::shared_mutex> lock(_serversMutex);
-            _serversList = std::move(other._serversList);
+            // Take over the other snapshot and retire ours
+            std::scoped_lock lock(_serversMutex, other._serversMutex);
+            const ServerSnapshot* incoming = other._snapshot.exchange(nullptr, std::memory_order_acq_rel);
+            const ServerSnapshot* previous = _snapshot.exchange(incoming, std::memory_order_acq_rel);
+            retireSnapshot(previous, incoming);
+            
+            EngineTable engines = std::move(other._engines);
+            std::swap(_engines, engines);
+            retireEngines(engines);
+            _serverIndex = std::move(other._serverIndex);
+            other._serverIndex.clear();
+            _strategy.store(other._strategy.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            _localZone = std::move(other._localZone);
+            _overflowThreshold = other._overflowThreshold;
         }
         
         {
             // Move configuration with appropriate locks
             std::lock_guard<std::mutex> lockThis(_configMutex);
             std::lock_guard<std::mutex> lockOther(other._configMutex);
-            _strategy = other._strategy;
             _healthCheckInterval = other._healthCheckInterval;
             _maxHealthCheckFailures = other._maxHealthCheckFailures;
+            _cluster = std::move(other._cluster);
+            _healthSnapshotPath = std::move(other._healthSnapshotPath);
+            _healthSnapshotInterval = other._healthSnapshotInterval;
+            _pingServer = std::move(other._pingServer);
         }
         
-        // Move ping server
-        _pingServer = std::move(other._pingServer);
+        _outlierDetector = other._outlierDetector;
+        _slowStart = other._slowStart;
+        _concurrencyLimiter = other._concurrencyLimiter;
+        _requestExecutor = other._requestExecutor;
+        _serverPickMetrics.store(other._serverPickMetrics.load());
     }
     return *this;
 }
@@ -115,18 +214,376 @@ LoadBalancer& LoadBalancer::operator=(LoadBalancer&& other) noexcept
 LoadBalancer::~LoadBalancer()
 {
     stopHealthChecks();
+
+    // Readers on other threads may still be inside a guard, so defer the delete
+    retireSnapshot(_snapshot.exchange(nullptr, std::memory_order_acq_rel), nullptr);
+    retireEngines(_engines);
+}
+
+// Snapshot access
+const ServerSnapshot* LoadBalancer::loadSnapshot() const
+{
+    // seq_cst pairs with the guard's epoch announcement
+    return _snapshot.load(std::memory_order_seq_cst);
+}
+
+void LoadBalancer::publishSnapshot(std::vector<std::shared_ptr<Server>> servers)
+{
+    SelectionEngine& selector = engineLocked(_strategy.load(std::memory_order_relaxed));
+    ServerSnapshot* next = selector.buildSnapshot(std::move(servers));
+    next->engine = &selector;
+    next->tiers = LocalityTiers::build(next->servers, _localZone, _overflowThreshold, selector);
+    
+    _outlierDetector.setPoolSize(next->servers.size());
+
+    _serverIndex.clear();
+    _serverIndex.reserve(next->servers.size());
+    for (const auto& server : next->servers) {
+        _serverIndex.emplace(server->getServerAddress(), server);
+    }
+    
+    const ServerSnapshot* previous = _snapshot.exchange(next, std::memory_order_seq_cst);
+    retireSnapshot(previous, next);
+}
+
+void LoadBalancer::retireSnapshot(const ServerSnapshot* snapshot, const ServerSnapshot* replacement)
+{
+    if (!snapshot) {
+        return;
+    }
+    
+    // Servers that are no longer reachable once this snapshot is gone
+    std::vector<std::shared_ptr<Server>> removed;
+    if (replacement) {
+        std::unordered_set<const Server*> kept;
+        kept.reserve(replacement->servers.size());
+        for (const auto& server : replacement->servers) {
+            kept.insert(server.get());
+        }
+        for (const auto& server : snapshot->servers) {
+            if (!kept.count(server.get())) {
+                removed.push_back(server);
+            }
+        }
+    } else {
+        removed = snapshot->servers;
+    }
+    
+    EpochDomain::instance().retire([snapshot, removed = std::move(removed)]() mutable {
+        // After the grace period no picker can lease these servers anymore
+        for (auto& server : removed) {
+            ServerDrainList::instance().add(std::move(server));
+        }
+        delete snapshot;
+    });
+}
+
+void LoadBalancer::refreshSnapshot()
+{
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    const ServerSnapshot* current = _snapshot.load(std::memory_order_acquire);
+    publishSnapshot(current ? current->servers : std::vector<std::shared_ptr<Server>>{});
+}
+
+void LoadBalancer::retireEngines(EngineTable& engines)
+{
+    for (auto& engine : engines) {
+        if (engine) {
+            EpochDomain::instance().retire([retired = engine.release()]() {
+                delete retired;
+            });
+        }
+    }
+}
+
+LoadBalancer::EngineTable LoadBalancer::cloneEngines(const EngineTable& engines)
+{
+    EngineTable copies;
+    for (size_t i = 0; i < engines.size(); ++i) {
+        if (engines[i]) {
+            copies[i] = engines[i]->clone();
+        }
+    }
+    return copies;
+}
+
+// Engine access
+SelectionEngine& LoadBalancer::engine(LoadBalancingStrategy strategy) const
+{
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    return engineLocked(strategy);
+}
+
+SelectionEngine& LoadBalancer::engineLocked(LoadBalancingStrategy strategy) const
+{
+    auto& slot = _engines[static_cast<size_t>(strategy)];
+    if (!slot) {
+        slot = SelectionEngine::create(strategy);
+    }
+    return *slot;
+}
+
+std::vector<std::shared_ptr<Server>> LoadBalancer::copyServers() const
+{
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
+    return snapshot ? snapshot->servers : std::vector<std::shared_ptr<Server>>{};
+}
+
+// Servers this instance probes itself
+std::vector<std::shared_ptr<Server>> LoadBalancer::ownedServers(const std::vector<std::shared_ptr<Server>>& servers, const ClusterState* cluster)
+{
+    if (!cluster) {
+        return servers;
+    }
+
+    std::vector<std::shared_ptr<Server>> owned;
+    owned.reserve(servers.size());
+    for (const auto& server : servers) {
+        if (cluster->ownsProbe(*server)) {
+            owned.push_back(server);
+        }
+    }
+    return owned;
+}
+
+// Pick a server through the snapshot's engine
+std::shared_ptr<Server> LoadBalancer::getNextServer()
+{
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
+    
+    if (!snapshot || snapshot->servers.empty()) {
+        _metrics.emptyPicks.add();
+        return nullptr;
+    }
+    
+    snapshot->sync();
+    const ServerSnapshot& target = pickTarget(*snapshot);
+    size_t index = admitIndex(target, [&]() { return target.engine->selectIndex(target, _slowStart); });
+    return index != ServerSnapshot::npos ? target.servers[index] : nullptr;
+}
+
+// Pick a server and take a connection slot on it
+ServerLease LoadBalancer::acquireNextServer()
+{
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
+    
+    if (!snapshot || snapshot->servers.empty()) {
+        _metrics.emptyPicks.add();
+        return ServerLease();
+    }
+    
+    snapshot->sync();
+    const ServerSnapshot& target = pickTarget(*snapshot);
+    
+    // The connection is counted before leaving the read-side section
+    return admitLease(target, [&]() { return target.engine->selectIndex(target, _slowStart); });
+}
+
+// Batch selection
+size_t LoadBalancer::getNextServers(std::span<std::shared_ptr<Server>> out)
+{
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
+    
+    if (!snapshot || snapshot->servers.empty()) {
+        if (!out.empty()) {
+            _metrics.emptyPicks.add();
+        }
+        return 0;
+    }
+    
+    snapshot->sync();
+    
+    // One tier draw per batch; select in chunks so the index buffer stays on the stack
+    const ServerSnapshot& target = pickTarget(*snapshot);
+    constexpr size_t kChunk = 64;
+    size_t indices[kChunk];
+    size_t written = 0;
+    bool rejected = false;
+    
+    while (written < out.size()) {
+        size_t wanted = (std::min)(kChunk, out.size() - written);
+        size_t selected = target.engine->selectIndices(target, _slowStart, std::span<size_t>(indices, wanted));
+        
+        // Saturated servers are left out; a chunk of nothing but saturated picks ends the batch
+        size_t admitted = 0;
+        for (size_t i = 0; i < selected; ++i) {
+            if (target.hotStates[indices[i]]->isSaturated()) {
+                _metrics.rejectedPicks.add();
+                rejected = true;
+                continue;
+            }
+            out[written + admitted++] = target.servers[recordPick(target, indices[i])];
+        }
+        written += admitted;
+        if (selected < wanted || admitted == 0) {
+            break;
+        }
+    }
+    
+    if (written == 0 && !out.empty() && !rejected) {
+        _metrics.emptyPicks.add();
+    }
+    return written;
+}
+
+size_t LoadBalancer::acquireNextServers(std::span<ServerLease> out)
+{
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
+    
+    if (!snapshot || snapshot->servers.empty()) {
+        if (!out.empty()) {
+            _metrics.emptyPicks.add();
+        }
+        return 0;
+    }
+    
+    snapshot->sync();
+    const ServerSnapshot& target = pickTarget(*snapshot);
+    
+    constexpr size_t kChunk = 64;
+    size_t indices[kChunk];
+    size_t written = 0;
+    bool rejected = false;
+    
+    while (written < out.size()) {
+        size_t wanted = (std::min)(kChunk, out.size() - written);
+        size_t selected = target.engine->selectIndices(target, _slowStart, std::span<size_t>(indices, wanted));
+        
+        size_t admitted = 0;
+        for (size_t i = 0; i < selected; ++i) {
+            ServerLease lease = makeLease(target, indices[i]);
+            if (!lease) {
+                _metrics.rejectedPicks.add();
+                rejected = true;
+                continue;
+            }
+            recordPick(target, indices[i]);
+            out[written + admitted++] = std::move(lease);
+        }
+        written += admitted;
+        if (selected < wanted || admitted == 0) {
+            break;
+        }
+    }
+    
+    if (written == 0 && !out.empty() && !rejected) {
+        _metrics.emptyPicks.add();
+    }
+    return written;
+}
+
+const ServerSnapshot& LoadBalancer::pickTarget(const ServerSnapshot& snapshot)
+{
+    expireOnPick(snapshot);
+    if (!snapshot.tiers) {
+        return snapshot;
+    }
+    snapshot.tiers->sync();
+    const ServerSnapshot* tier = snapshot.tiers->select();
+    return tier ? *tier : snapshot;
+}
+
+const ServerSnapshot& LoadBalancer::pickTarget(const ServerSnapshot& snapshot, uint64_t keyHash)
+{
+    expireOnPick(snapshot);
+    if (!snapshot.tiers) {
+        return snapshot;
+    }
+    snapshot.tiers->sync();
+    const ServerSnapshot* tier = snapshot.tiers->selectForKey(keyHash);
+    return tier ? *tier : snapshot;
+}
+
+void LoadBalancer::expireOnPick(const ServerSnapshot& snapshot)
+{
+    _outlierDetector.expireDue(snapshot.servers);
+    if (_warmStartPending.load(std::memory_order_relaxed) != 0) {
+        expireWarmStartLazily();
+    }
+}
+
+ServerLease LoadBalancer::makeLease(const ServerSnapshot& snapshot, size_t index)
+{
+    return index != ServerSnapshot::npos ? ServerLease(snapshot.servers[index].get(), index, &_outlierDetector, &_concurrencyLimiter) : ServerLease();
+}
+
+size_t LoadBalancer::recordPick(const ServerSnapshot& snapshot, size_t index)
+{
+    if (index == ServerSnapshot::npos) {
+        _metrics.emptyPicks.add();
+        return index;
+    }
+    
+    _metrics.picks.add();
+    if (!snapshot.hotStates[index]->isAvailable()) {
+        _metrics.fallbackPicks.add();
+    }
+    if (_serverPickMetrics.load(std::memory_order_relaxed)) {
+        snapshot.servers[index]->getMetrics().picks.add();
+    }
+    return index;
+}
+
+// Passive health checking
+bool LoadBalancer::reportOutcome(Server& server, bool success, std::chrono::nanoseconds latency)
+{
+    bool ejected = _outlierDetector.recordOutcome(server, success, latency);
+    _concurrencyLimiter.recordOutcome(server, success, latency);
+    return ejected;
+}
+
+OutlierDetector& LoadBalancer::getOutlierDetector()
+{
+    return _outlierDetector;
+}
+
+ConcurrencyLimiter& LoadBalancer::getConcurrencyLimiter()
+{
+    return _concurrencyLimiter;
+}
+
+// Asynchronous execution
+Task<ExecutionResult> LoadBalancer::execute(RequestFunction fn)
+{
+    return _requestExecutor.execute(*this, std::move(fn));
+}
+
+RequestExecutor& LoadBalancer::getRequestExecutor()
+{
+    return _requestExecutor;
+}
+
+SlowStart& LoadBalancer::getSlowStart()
+{
+    return _slowStart;
 }
 
 // Perform health check on all servers
 bool LoadBalancer::performHealthCheck()
 {
-    if (!_pingServer) {
+    std::shared_ptr<PingServer> pingServer = getPingServer();
+    if (!pingServer) {
         return false;
     }
     
-    // Use shared lock for reading servers
-    std::shared_lock<std::shared_mutex> lock(_serversMutex);
-    return _pingServer->pingServers(_serversList);
+    // Ping a private copy so the sweep never holds a read-side section
+    auto servers = copyServers();
+    _outlierDetector.evaluate(servers, std::chrono::steady_clock::now());
+
+    // In a cluster, probe only the servers we own and adopt the owners' results for the rest
+    std::shared_ptr<ClusterState> cluster = getClusterState();
+    if (!cluster) {
+        return pingServer->pingServers(servers);
+    }
+    cluster->synchronize(servers);
+    bool result = pingServer->pingServers(ownedServers(servers, cluster.get()));
+    cluster->synchronize(servers);
+    return result;
 }
 
 // Server management
@@ -136,48 +593,158 @@ bool LoadBalancer::addServer(std::shared_ptr<Server> server)
         return false;
     }
     
-    // Use exclusive lock for writing
-    std::unique_lock<std::shared_mutex> lock(_serversMutex);
-    
-    // Check for duplicate
-    auto it = std::find_if(_serversList.begin(), _serversList.end(), 
-                          [&](const std::shared_ptr<Server>& s) {
-                              return s->getServerAddress() == server->getServerAddress();
-                          });
-    
-    if (it != _serversList.end()) {
+    // Writers are serialized; readers keep using the old snapshot until the swap
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    if (_serverIndex.count(server->getServerAddress())) {
         return false; // Server already exists
     }
     
-    _serversList.push_back(server);
+    const ServerSnapshot* current = _snapshot.load(std::memory_order_acquire);
+    std::vector<std::shared_ptr<Server>> servers = current ? current->servers : std::vector<std::shared_ptr<Server>>{};
+    
+    // New servers ramp up instead of taking a full share at once
+    server->beginSlowStart();
+    servers.push_back(std::move(server));
+    publishSnapshot(std::move(servers));
     return true;
 }
 
 // Remove a server
 bool LoadBalancer::removeServer(const std::string& serverAddress)
 {
-    // Use exclusive lock for writing
-    std::unique_lock<std::shared_mutex> lock(_serversMutex);
-    
-    auto originalSize = _serversList.size();
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    const ServerSnapshot* current = _snapshot.load(std::memory_order_acquire);
+    if (!current || !_serverIndex.count(serverAddress)) {
+        return false;
+    }
     
-    _serversList.erase(
-        std::remove_if(_serversList.begin(), _serversList.end(),
+    std::vector<std::shared_ptr<Server>> servers = current->servers;
+    servers.erase(
+        std::remove_if(servers.begin(), servers.end(),
                       [&](const std::shared_ptr<Server>& server) {
                           return server->getServerAddress() == serverAddress;
                       }),
-       _serversList.end()
+       servers.end()
     );
     
-    return _serversList.size() < originalSize;
+    publishSnapshot(std::move(servers));
+    return true;
+}
+
+// Bulk updates
+ServerListUpdate LoadBalancer::replaceServers(const std::vector<std::shared_ptr<Server>>& servers)
+{
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    return replaceServersLocked(servers);
+}
+
+ServerListUpdate LoadBalancer::replaceServers(const std::vector<std::string>& serverAddresses)
+{
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    
+    // Known addresses resolve to the servers already in use; only new ones are constructed
+    std::vector<std::shared_ptr<Server>> servers;
+    servers.reserve(serverAddresses.size());
+    for (const auto& address : serverAddresses) {
+        auto it = _serverIndex.find(address);
+        servers.push_back(it != _serverIndex.end() ? it->second : ServerTable::instance().create(address));
+    }
+    return replaceServersLocked(servers);
+}
+
+ServerListUpdate LoadBalancer::replaceServersLocked(const std::vector<std::shared_ptr<Server>>& servers)
+{
+    ServerListUpdate update;
+    std::vector<std::shared_ptr<Server>> next;
+    next.reserve(servers.size());
+    std::unordered_set<std::string_view> seen;
+    seen.reserve(servers.size());
+    
+    for (const auto& server : servers) {
+        if (!server || !seen.insert(server->getServerAddress()).second) {
+            continue; // First entry for an address wins
+        }
+        
+        auto it = _serverIndex.find(server->getServerAddress());
+        if (it != _serverIndex.end()) {
+            it->second->setWeight(server->getWeight());
+            next.push_back(it->second);
+            ++update.kept;
+        } else {
+            server->beginSlowStart();
+            next.push_back(server);
+            ++update.added;
+        }
+    }
+    update.removed = _serverIndex.size() - update.kept;
+    
+    // A reorder alone still republishes; an identical list does not
+    const ServerSnapshot* current = _snapshot.load(std::memory_order_acquire);
+    if (!update.changed() && current && current->servers == next) {
+        return update;
+    }
+    
+    publishSnapshot(std::move(next));
+    return update;
+}
+
+ServerListUpdate LoadBalancer::applyDiff(
+    const std::vector<std::shared_ptr<Server>>& added,
+    const std::vector<std::string>& removedAddresses)
+{
+    ServerListUpdate update;
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    const ServerSnapshot* current = _snapshot.load(std::memory_order_acquire);
+    
+    std::unordered_set<std::string_view> removed;
+    removed.reserve(removedAddresses.size());
+    for (const auto& address : removedAddresses) {
+        if (_serverIndex.count(address)) {
+            removed.insert(address);
+        }
+    }
+    
+    std::vector<std::shared_ptr<Server>> next;
+    next.reserve((current ? current->servers.size() : 0) + added.size());
+    if (current) {
+        for (const auto& server : current->servers) {
+            if (!removed.count(server->getServerAddress())) {
+                next.push_back(server);
+            }
+        }
+    }
+    update.removed = removed.size();
+    update.kept = next.size();
+    
+    // Additions for addresses still present only update the weight; a removed and
+    // re-added address comes back as the new server
+    std::unordered_set<std::string_view> seen;
+    seen.reserve(added.size());
+    for (const auto& server : added) {
+        if (!server || !seen.insert(server->getServerAddress()).second) {
+            continue;
+        }
+        
+        auto it = _serverIndex.find(server->getServerAddress());
+        if (it != _serverIndex.end() && !removed.count(server->getServerAddress())) {
+            it->second->setWeight(server->getWeight());
+            continue;
+        }
+        server->beginSlowStart();
+        next.push_back(server);
+        ++update.added;
+    }
+    
+    if (update.changed()) {
+        publishSnapshot(std::move(next));
+    }
+    return update;
 }
 
 // Get all servers
 std::vector<std::shared_ptr<Server>> LoadBalancer::getServers() const
 {
-    // Use shared lock for reading
-    std::shared_lock<std::shared_mutex> lock(_serversMutex);
-    return _serversList;
+    return copyServers();
 }
 
 // Setters and getters for configuration
@@ -205,16 +772,175 @@ uint32_t LoadBalancer::getMaxHealthCheckFailures() const
     return _maxHealthCheckFailures;
 }
 
-void LoadBalancer::setStrategy(LoadBalancingStrategy strategy)
+void LoadBalancer::setClusterState(std::shared_ptr<ClusterState> cluster)
 {
     std::lock_guard<std::mutex> lock(_configMutex);
-    _strategy = strategy;
+    _cluster = std::move(cluster);
 }
 
-LoadBalancingStrategy LoadBalancer::getStrategy() const
+std::shared_ptr<ClusterState> LoadBalancer::getClusterState() const
+{
+    std::lock_guard<std::mutex> lock(_configMutex);
+    return _cluster;
+}
+
+void LoadBalancer::setPingServer(std::shared_ptr<PingServer> pingServer)
+{
+    std::lock_guard<std::mutex> lock(_configMutex);
+    _pingServer = std::move(pingServer);
+}
+
+std::shared_ptr<PingServer> LoadBalancer::getPingServer() const
+{
+    std::lock_guard<std::mutex> lock(_configMutex);
+    return _pingServer;
+}
+
+// Warm start
+bool LoadBalancer::saveHealthSnapshot(const std::string& path) const
+{
+    return HealthSnapshot::save(path, copyServers());
+}
+
+size_t LoadBalancer::loadHealthSnapshot(const std::string& path, std::chrono::milliseconds validationWindow, std::chrono::seconds maxAge)
 {
+    HealthSnapshot snapshot;
+    if (!snapshot.open(path, maxAge)) {
+        return 0;
+    }
+    
+    auto now = std::chrono::steady_clock::now();
     std::lock_guard<std::mutex> lock(_configMutex);
-    return _strategy;
+    if (validationWindow.count() <= 0) {
+        validationWindow = std::chrono::milliseconds(2 * static_cast<int64_t>(_healthCheckInterval));
+    }
+    
+    // Restored endpoints are refreshed once the window ends, like any other stale lookup
+    std::vector<std::weak_ptr<Server>> restored;
+    for (const auto& server : copyServers()) {
+        if (snapshot.restore(*server, now + validationWindow)) {
+            restored.push_back(server);
+        }
+    }
+    
+    _warmStarted = std::move(restored);
+    _warmStartedAt = now;
+    _warmStartDeadline = now + validationWindow;
+    _warmStartPending.store(_warmStarted.empty() ? 0 : (std::max)(_warmStartDeadline.time_since_epoch().count(), std::chrono::steady_clock::rep(1)),
+                            std::memory_order_relaxed);
+    return _warmStarted.size();
+}
+
+void LoadBalancer::setHealthSnapshotPath(const std::string& path, std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> lock(_configMutex);
+    _healthSnapshotPath = path;
+    _healthSnapshotInterval = (std::max)(interval, std::chrono::milliseconds(1));
+}
+
+void LoadBalancer::expireWarmStart(std::chrono::steady_clock::time_point now)
+{
+    std::vector<std::weak_ptr<Server>> pending;
+    std::chrono::steady_clock::time_point restoredAt;
+    {
+        std::lock_guard<std::mutex> lock(_configMutex);
+        if (_warmStarted.empty() || now < _warmStartDeadline) {
+            return;
+        }
+        pending.swap(_warmStarted);
+        restoredAt = _warmStartedAt;
+        _warmStartPending.store(0, std::memory_order_relaxed);
+    }
+    
+    for (const auto& weak : pending) {
+        auto server = weak.lock();
+        if (server && server->getLastHealthCheck() < restoredAt) {
+            server->setHealthy(false);
+        }
+    }
+}
+
+void LoadBalancer::expireWarmStartLazily()
+{
+    thread_local uint32_t picksUntilCheck = 0;
+    if (picksUntilCheck-- != 0) {
+        return;
+    }
+    picksUntilCheck = 256;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now.time_since_epoch().count() >= _warmStartPending.load(std::memory_order_relaxed)) {
+        expireWarmStart(now);
+    }
+}
+
+// Switch engines: the same servers are republished through the new engine in one swap,
+// so connection counts and health carry over and pickers never wait
+void LoadBalancer::setStrategy(LoadBalancingStrategy strategy)
+{
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    if (_strategy.exchange(strategy, std::memory_order_relaxed) == strategy) {
+        return;
+    }
+    
+    const ServerSnapshot* current = _snapshot.load(std::memory_order_acquire);
+    publishSnapshot(current ? current->servers : std::vector<std::shared_ptr<Server>>{});
+}
+
+LoadBalancingStrategy LoadBalancer::getStrategy() const
+{
+    return _strategy.load(std::memory_order_relaxed);
+}
+
+// Tiers are grouped when a snapshot is built, so locality changes republish the list
+void LoadBalancer::setLocalZone(const std::string& zone)
+{
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    if (_localZone == zone) {
+        return;
+    }
+    _localZone = zone;
+    
+    const ServerSnapshot* current = _snapshot.load(std::memory_order_acquire);
+    publishSnapshot(current ? current->servers : std::vector<std::shared_ptr<Server>>{});
+}
+
+std::string LoadBalancer::getLocalZone() const
+{
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    return _localZone;
+}
+
+void LoadBalancer::setOverflowThreshold(double threshold)
+{
+    threshold = std::clamp(threshold, 0.01, 1.0);
+    
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    if (_overflowThreshold == threshold) {
+        return;
+    }
+    _overflowThreshold = threshold;
+    
+    const ServerSnapshot* current = _snapshot.load(std::memory_order_acquire);
+    publishSnapshot(current ? current->servers : std::vector<std::shared_ptr<Server>>{});
+}
+
+double LoadBalancer::getOverflowThreshold() const
+{
+    std::lock_guard<std::mutex> lock(_serversMutex);
+    return _overflowThreshold;
+}
+
+std::vector<TierStats> LoadBalancer::getTierStats() const
+{
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
+    if (!snapshot || !snapshot->tiers) {
+        return {};
+    }
+    snapshot->sync();
+    snapshot->tiers->sync();
+    return snapshot->tiers->stats();
 }
 
 // Start health checks
@@ -233,17 +959,49 @@ void LoadBalancer::startHealthChecks()
     }
     
     _healthCheckTask = std::async(std::launch::async, [this, interval]() {
+        // Staggered per-server schedule instead of sweeping everything at once
+        HealthCheckScheduler scheduler{std::chrono::milliseconds(interval)};
+        auto lastSnapshotSave = HealthCheckScheduler::Clock::now();
+        
         while (_healthCheckRunning.load(std::memory_order_acquire)) {
-            this->performHealthCheck();
+            auto servers = copyServers();
+            _outlierDetector.evaluate(servers, HealthCheckScheduler::Clock::now());
+            
+            auto due = scheduler.collectDue(servers, HealthCheckScheduler::Clock::now());
+            std::shared_ptr<ClusterState> cluster = getClusterState();
+            std::shared_ptr<PingServer> pingServer = getPingServer();
+            
+            if (!due.empty() && pingServer) {
+                // Servers owned by another instance come due too, but their results arrive by sync
+                pingServer->pingServers(ownedServers(due, cluster.get()));
+                scheduler.recordResults(due, HealthCheckScheduler::Clock::now());
+            }
+            
+            if (cluster) {
+                cluster->synchronize(servers);
+            }
+            
+            expireWarmStart(HealthCheckScheduler::Clock::now());
             
-            // Check for updated interval
-            uint32_t currentInterval;
+            // Check for updated interval and snapshot settings
+            std::string snapshotPath;
             {
                 std::lock_guard<std::mutex> lock(_configMutex);
-                currentInterval = _healthCheckInterval;
+                scheduler.setBaseInterval(std::chrono::milliseconds(_healthCheckInterval));
+                if (HealthCheckScheduler::Clock::now() - lastSnapshotSave >= _healthSnapshotInterval) {
+                    snapshotPath = _healthSnapshotPath;
+                }
+            }
+            if (!snapshotPath.empty()) {
+                saveHealthSnapshot(snapshotPath);
+                lastSnapshotSave = HealthCheckScheduler::Clock::now();
             }
             
-            std::this_thread::sleep_for(std::chrono::milliseconds(currentInterval));
+            auto wakeup = scheduler.nextWakeup(HealthCheckScheduler::Clock::now());
+            if (cluster) {
+                wakeup = (std::min)(wakeup, HealthCheckScheduler::Clock::now() + cluster->getSyncInterval());
+            }
+            std::this_thread::sleep_until(wakeup);
         }
     });
 }
@@ -251,7 +1009,7 @@ void LoadBalancer::startHealthChecks()
 // Stop health checks
 void LoadBalancer::stopHealthChecks()
 {
-    _healthCheckRunning.store(false, std::memory_order_release);
+    bool wasRunning = _healthCheckRunning.exchange(false, std::memory_order_acq_rel);
     
     if (_healthCheckTask.valid()) {
         try {
@@ -260,6 +1018,18 @@ void LoadBalancer::stopHealthChecks()
             // Ignore exceptions during shutdown
         }
     }
+    
+    // Final snapshot, so a restart warm-starts from the state at shutdown
+    if (wasRunning) {
+        std::string snapshotPath;
+        {
+            std::lock_guard<std::mutex> lock(_configMutex);
+            snapshotPath = _healthSnapshotPath;
+        }
+        if (!snapshotPath.empty()) {
+            saveHealthSnapshot(snapshotPath);
+        }
+    }
 }
 
 // Check if health check is running
@@ -271,36 +1041,40 @@ bool LoadBalancer::isHealthCheckRunning() const
 // Statistics methods
 size_t LoadBalancer::getServerCount() const
 {
-    // Use shared lock for reading
-    std::shared_lock<std::shared_mutex> lock(_serversMutex);
-    return _serversList.size();
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
+    return snapshot ? snapshot->servers.size() : 0;
 }
 
 size_t LoadBalancer::getHealthyServerCount() const
 {
-    // Use shared lock for reading
-    std::shared_lock<std::shared_mutex> lock(_serversMutex);
-    return std::count_if(_serversList.begin(), _serversList.end(),
-                        [](const std::shared_ptr<Server>& server) {
-                            return server->isAlive() && server->isHealthy();
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
+    if (!snapshot) {
+        return 0;
+    }
+    
+    return std::count_if(snapshot->hotStates.begin(), snapshot->hotStates.end(),
+                        [](const ServerHotState* state) {
+                            return state->isAvailable();
                         });
 }
 
 double LoadBalancer::getAverageLoad() const
 {
-    // Use shared lock for reading
-    std::shared_lock<std::shared_mutex> lock(_serversMutex);
+    EpochDomain::Guard guard;
+    const ServerSnapshot* snapshot = loadSnapshot();
     
-    if (_serversList.empty()) {
+    if (!snapshot || snapshot->servers.empty()) {
         return 0.0;
     }
     
     double totalLoad = 0.0;
     size_t activeServerCount = 0;
     
-    for (const auto& server : _serversList) {
-        if (server->isAlive() && server->isHealthy()) {
-            totalLoad += server->getEffectiveLoad();
+    for (const ServerHotState* state : snapshot->hotStates) {
+        if (state->isAvailable()) {
+            totalLoad += state->effectiveLoad();
             activeServerCount++;
         }
     }
@@ -308,33 +1082,379 @@ double LoadBalancer::getAverageLoad() const
     return activeServerCount > 0 ? totalLoad / activeServerCount : 0.0;
 }
 
+const BalancerMetrics& LoadBalancer::getMetrics() const
+{
+    return _metrics;
+}
+
+void LoadBalancer::setServerPickMetrics(bool enabled)
+{
+    _serverPickMetrics.store(enabled);
+}
+
+bool LoadBalancer::getServerPickMetrics() const
+{
+    return _serverPickMetrics.load();
+}
+
+// Prometheus text exposition of the balancer, its servers and the DNS cache
+std::string LoadBalancer::exportMetrics() const
+{
+    PrometheusWriter writer;
+    auto servers = copyServers();
+
+    writer.family("lb_picks_total", "Picks that returned a server.", "counter");
+    writer.sample("lb_picks_total", "", static_cast<double>(_metrics.picks.value()));
+    writer.family("lb_fallback_picks_total", "Picks that fell back to an alive but unhealthy server.", "counter");
+    writer.sample("lb_fallback_picks_total", "", static_cast<double>(_metrics.fallbackPicks.value()));
+    writer.family("lb_empty_picks_total", "Picks that found no server.", "counter");
+    writer.sample("lb_empty_picks_total", "", static_cast<double>(_metrics.emptyPicks.value()));
+    writer.family("lb_rejected_picks_total", "Picks refused because every candidate server was at its concurrency limit.", "counter");
+    writer.sample("lb_rejected_picks_total", "", static_cast<double>(_metrics.rejectedPicks.value()));
+
+    size_t healthy = 0;
+    for (const auto& server : servers) {
+        healthy += server->hotState().isAvailable() ? 1 : 0;
+    }
+    writer.family("lb_servers", "Servers in the pool.", "gauge");
+    writer.sample("lb_servers", "", static_cast<double>(servers.size()));
+    writer.family("lb_servers_healthy", "Servers both alive and healthy.", "gauge");
+    writer.sample("lb_servers_healthy", "", static_cast<double>(healthy));
+
+    // Per-server families, one sample per server each
+    auto perServer = [&writer, &servers](const std::string& name, const std::string& help, const std::string& type, auto value) {
+        writer.family(name, help, type);
+        for (const auto& server : servers) {
+            writer.sample(name, PrometheusWriter::label("server", server->getServerAddress()), static_cast<double>(value(*server)));
+        }
+    };
+    if (_serverPickMetrics.load(std::memory_order_relaxed)) {
+        perServer("lb_server_picks_total", "Times the server was picked.", "counter",
+                  [](const Server& server) { return server.getMetrics().picks.value(); });
+    }
+    perServer("lb_server_healthy", "1 while the server is alive and healthy.", "gauge",
+              [](const Server& server) { return server.hotState().isAvailable() ? 1 : 0; });
+    perServer("lb_server_connections", "Connections currently leased to the server.", "gauge",
+              [](const Server& server) { return server.getCurrentConnections(); });
+    perServer("lb_server_concurrency_limit", "Outstanding leases allowed on the server, 0 for no limit.", "gauge",
+              [](const Server& server) { return server.getConcurrencyLimit(); });
+    perServer("lb_server_probes_total", "Active health probes sent to the server.", "counter",
+              [](const Server& server) { return server.getMetrics().probes.load(std::memory_order_relaxed); });
+    perServer("lb_server_probe_failures_total", "Active health probes that failed or timed out.", "counter",
+              [](const Server& server) { return server.getMetrics().probeFailures.load(std::memory_order_relaxed); });
+
+    writer.family("lb_server_probe_duration_seconds", "Connect time of successful health probes.", "histogram");
+    for (const auto& server : servers) {
+        writer.histogram("lb_server_probe_duration_seconds", PrometheusWriter::label("server", server->getServerAddress()),
+                         server->getMetrics().probeDuration.snapshot());
+    }
+
+    if (std::shared_ptr<PingServer> pingServer = getPingServer()) {
+        DnsResolver::Stats dns = pingServer->getDNSCacheStats();
+        writer.family("lb_dns_cache_hits_total", "Lookups answered from the DNS cache.", "counter");
+        writer.sample("lb_dns_cache_hits_total", "", static_cast<double>(dns.hits));
+        writer.family("lb_dns_cache_stale_hits_total", "Cache answers served past their refresh time.", "counter");
+        writer.sample("lb_dns_cache_stale_hits_total", "", static_cast<double>(dns.staleHits));
+        writer.family("lb_dns_cache_misses_total", "Lookups with nothing cached.", "counter");
+        writer.sample("lb_dns_cache_misses_total", "", static_cast<double>(dns.misses));
+    }
+
+    return writer.text();
+}
+
+// RoundRobinEngine implementation
+
+// Destructor
+RoundRobinEngine::~RoundRobinEngine()
+{
+    delete[] _threadCursors.load(std::memory_order_acquire);
+}
+
+LoadBalancingStrategy RoundRobinEngine::strategy() const
+{
+    return kStrategy;
+}
+
+std::unique_ptr<SelectionEngine> RoundRobinEngine::clone() const
+{
+    auto copy = std::make_unique<RoundRobinEngine>();
+    copy->_currentServerIndex.store(_currentServerIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    copy->setCursorMode(getCursorMode());
+    return copy;
+}
+
+// Cursor management
+void RoundRobinEngine::ensureThreadCursors()
+{
+    if (_threadCursors.load(std::memory_order_acquire)) {
+        return;
+    }
+    
+    auto* cursors = new ThreadCursor[EpochDomain::kMaxThreads];
+    
+    // Stagger starting offsets so threads do not walk the pool in lockstep
+    for (size_t i = 0; i < EpochDomain::kMaxThreads; ++i) {
+        cursors[i].next.store(static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ULL, std::memory_order_relaxed);
+    }
+    
+    ThreadCursor* expected = nullptr;
+    if (!_threadCursors.compare_exchange_strong(expected, cursors, std::memory_order_acq_rel)) {
+        delete[] cursors; // Another thread won the race
+    }
+}
+
+uint64_t RoundRobinEngine::nextTicket(uint64_t count)
+{
+    CursorMode mode = _cursorMode.load(std::memory_order_acquire);
+    
+    if (mode == CursorMode::SHARED) {
+        return _currentServerIndex.fetch_add(count, std::memory_order_relaxed);
+    }
+    
+    ThreadCursor& cursor = _threadCursors.load(std::memory_order_acquire)[EpochDomain::currentThreadIndex()];
+    
+    // Only the owning thread writes its cursor, so plain load/store is enough
+    uint64_t ticket = cursor.next.load(std::memory_order_relaxed);
+    
+    if (mode == CursorMode::BATCHED && ticket + count > cursor.end.load(std::memory_order_relaxed)) {
+        uint64_t reserve = (std::max)(count, kCursorBatchSize);
+        ticket = _currentServerIndex.fetch_add(reserve, std::memory_order_relaxed);
+        cursor.end.store(ticket + reserve, std::memory_order_relaxed);
+    }
+    
+    cursor.next.store(ticket + count, std::memory_order_relaxed);
+    return ticket;
+}
+
+void RoundRobinEngine::advance(uint64_t count)
+{
+    _currentServerIndex.fetch_add(count, std::memory_order_relaxed);
+}
+
+void RoundRobinEngine::setCursorMode(CursorMode mode)
+{
+    if (mode != CursorMode::SHARED) {
+        ensureThreadCursors();
+    }
+    _cursorMode.store(mode, std::memory_order_release);
+}
+
+CursorMode RoundRobinEngine::getCursorMode() const
+{
+    return _cursorMode.load(std::memory_order_acquire);
+}
+
+// Select next server using round robin algorithm
+size_t RoundRobinEngine::selectIndex(const ServerSnapshot& snapshot, const SlowStart&)
+{
+    size_t serverCount = snapshot.hotStates.size();
+    
+    // Claim a slot; the cursor is the only shared state written on this path
+    size_t startIndex = static_cast<size_t>(nextTicket() % serverCount);
+    
+    // Jump straight to the next available server below its limit, skipping dead ones a word at a time
+    size_t index = snapshot.nextUnsaturated(snapshot.available, startIndex);
+    if (index == ServerBitmap::npos) {
+        // First alive but unhealthy server as fallback, npos when no server is alive
+        index = snapshot.nextUnsaturated(snapshot.alive, startIndex);
+    }
+    
+    return index != ServerBitmap::npos ? index : ServerSnapshot::npos;
+}
+
+// Select a batch: one cursor advance, then a single walk handing out available servers in order
+size_t RoundRobinEngine::selectIndices(const ServerSnapshot& snapshot, const SlowStart&, std::span<size_t> out)
+{
+    if (out.empty()) {
+        return 0;
+    }
+    
+    size_t serverCount = snapshot.hotStates.size();
+    size_t startIndex = static_cast<size_t>(nextTicket(out.size()) % serverCount);
+    
+    // Hand out the servers set in `bits` in order from the start, wrapping as often as needed
+    auto walk = [&](const ServerBitmap& bits) {
+        size_t index = startIndex;
+        size_t written = 0;
+        while (written < out.size()) {
+            size_t next = snapshot.nextUnsaturated(bits, index);
+            if (next == ServerBitmap::npos) {
+                break;
+            }
+            out[written++] = next;
+            if (snapshot.hotStates[next]->isSaturated()) {
+                break; // Every one of them is at its limit
+            }
+            index = next + 1 == serverCount ? 0 : next + 1;
+        }
+        return written;
+    };
+    
+    // Healthy servers first; with none, rotate over the alive fallbacks as single picks do
+    size_t written = walk(snapshot.available);
+    return written != 0 ? written : walk(snapshot.alive);
+}
+
+// WeightedRoundRobinEngine implementation
+
+LoadBalancingStrategy WeightedRoundRobinEngine::strategy() const
+{
+    return kStrategy;
+}
+
+std::unique_ptr<SelectionEngine> WeightedRoundRobinEngine::clone() const
+{
+    auto copy = std::make_unique<WeightedRoundRobinEngine>();
+    copy->_currentServerIndex.store(_currentServerIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return copy;
+}
+
+// Snapshot constructor (the base records the change log position before the weights are read)
+WeightedRoundRobinEngine::WeightedSnapshot::WeightedSnapshot(std::vector<std::shared_ptr<Server>> serverList)
+    : ServerSnapshot(std::move(serverList)),
+      schedule(scheduledWeights(hotStates))
+{
+}
+
+void WeightedRoundRobinEngine::WeightedSnapshot::onStateChanged(size_t index) const
+{
+    schedule.setWeight(index, scheduledWeight(*hotStates[index]));
+}
+
+// Build a snapshot with the weighted schedule for its servers
+ServerSnapshot* WeightedRoundRobinEngine::buildSnapshot(std::vector<std::shared_ptr<Server>> servers) const
+{
+    return new WeightedSnapshot(std::move(servers));
+}
+
+uint32_t WeightedRoundRobinEngine::scheduledWeight(const ServerHotState& state)
+{
+    // Only servers that are up receive tickets
+    return state.isAvailable() ? state.weight.load(std::memory_order_relaxed) : 0;
+}
+
+std::vector<uint32_t> WeightedRoundRobinEngine::scheduledWeights(const std::vector<const ServerHotState*>& states)
+{
+    std::vector<uint32_t> weights;
+    weights.reserve(states.size());
+    for (const ServerHotState* state : states) {
+        weights.push_back(scheduledWeight(*state));
+    }
+    return weights;
+}
+
+// Select next server using weighted round robin algorithm
+size_t WeightedRoundRobinEngine::selectIndex(const ServerSnapshot& snapshot, const SlowStart& slowStart)
+{
+    uint64_t ticket = _currentServerIndex.fetch_add(1, std::memory_order_relaxed);
+    return selectForTicket(static_cast<const WeightedSnapshot&>(snapshot), slowStart, ticket);
+}
+
+size_t WeightedRoundRobinEngine::selectIndices(const ServerSnapshot& baseSnapshot, const SlowStart& slowStart, std::span<size_t> out)
+{
+    const auto& snapshot = static_cast<const WeightedSnapshot&>(baseSnapshot);
+    uint64_t ticket = _currentServerIndex.fetch_add(out.size(), std::memory_order_relaxed);
+    size_t written = 0;
+    
+    for (size_t& slot : out) {
+        size_t index = selectForTicket(snapshot, slowStart, ticket++);
+        if (index == ServerSnapshot::npos) {
+            break;
+        }
+        slot = index;
+        ++written;
+    }
+    
+    return written;
+}
+
+size_t WeightedRoundRobinEngine::selectForTicket(const WeightedSnapshot& snapshot, const SlowStart& slowStart, uint64_t ticket)
+{
+    const auto& hotStates = snapshot.hotStates;
+    size_t serverCount = hotStates.size();
+    size_t fallbackIndex = ServerSnapshot::npos;
+    size_t thinnedIndex = ServerSnapshot::npos;
+    
+    // Follow the schedule from this ticket until a healthy server comes up. A slot passed on is
+    // redrawn at a scattered point of the period, so passed slots spread over the servers by
+    // weight instead of all landing on the schedule's next server.
+    if (!snapshot.schedule.empty()) {
+        for (size_t i = 0; i < serverCount; ++i) {
+            uint64_t slot = i == 0 ? ticket : mix64(ticket ^ mix64(i));
+            size_t index = snapshot.schedule.pick(slot);
+            if (index == WeightedSchedule::npos || snapshot.schedule.weightAt(index) == 0) {
+                continue; // Landed in a range that is being resized
+            }
+            uint32_t flags = hotStates[index]->flags.load(std::memory_order_relaxed);
+            
+            if (flags & ServerHotState::kAlive) {
+                if (flags & ServerHotState::kHealthy) {
+                    if (hotStates[index]->isSaturated()) {
+                        continue; // At its limit: the slot passes on like a thinned one
+                    }
+                    
+                    // A ramping server keeps only `factor` of its slots; the rest are redrawn
+                    double factor = slowStart.factor(*hotStates[index]);
+                    if (factor >= 1.0 || admissionPoint(slot) < factor) {
+                        return index;
+                    }
+                    if (thinnedIndex == ServerSnapshot::npos) {
+                        thinnedIndex = index;
+                    }
+                } else if (fallbackIndex == ServerSnapshot::npos) {
+                    // Keep first alive but unhealthy server as fallback
+                    fallbackIndex = index;
+                }
+            }
+        }
+    }
+    
+    // Every slot tried was thinned out (the whole pool is ramping): the first one keeps its
+    // ticket, so relative weights still hold while the pool warms up
+    if (thinnedIndex != ServerSnapshot::npos) {
+        return thinnedIndex;
+    }
+    
+    // Nothing scheduled and free (or not synced yet): take any healthy server below its limit,
+    // then the fallback; a saturated one comes back only when all of them are.
+    // The search starts at the ticket so that fallback picks still rotate.
+    size_t start = static_cast<size_t>(ticket % serverCount);
+    size_t index = snapshot.nextUnsaturated(snapshot.available, start);
+    if (index == ServerBitmap::npos) {
+        bool useFallback = fallbackIndex != ServerSnapshot::npos && !hotStates[fallbackIndex]->isSaturated();
+        index = useFallback ? fallbackIndex : snapshot.nextUnsaturated(snapshot.alive, start);
+    }
+    
+    return index != ServerBitmap::npos ? index : ServerSnapshot::npos;
+}
+
 // RoundRobinLoadBalancer implementation
 
 // Constructor
 RoundRobinLoadBalancer::RoundRobinLoadBalancer(
     const std::vector<std::shared_ptr<Server>>& servers,
     uint32_t healthCheckInterval,
-    uint32_t maxHealthCheckFailures
-) : LoadBalancer(servers, LoadBalancingStrategy::ROUND_ROBIN, healthCheckInterval, maxHealthCheckFailures),
-    _currentServerIndex(0)
+    uint32_t maxHealthCheckFailures,
+    CursorMode cursorMode
+) : LoadBalancer(servers, LoadBalancingStrategy::ROUND_ROBIN, healthCheckInterval, maxHealthCheckFailures)
 {
     if (servers.empty()) {
         throw std::invalid_argument("Server list cannot be empty");
     }
+    
+    setCursorMode(cursorMode);
 }
 
-// Copy constructor
+// Copy constructor (the base copies the engines and their cursors)
 RoundRobinLoadBalancer::RoundRobinLoadBalancer(const RoundRobinLoadBalancer& other)
     : LoadBalancer(other)
 {
-    _currentServerIndex.store(other._currentServerIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
 }
 
 // Move constructor
 RoundRobinLoadBalancer::RoundRobinLoadBalancer(RoundRobinLoadBalancer&& other) noexcept
     : LoadBalancer(std::move(other))
 {
-    _currentServerIndex.store(other._currentServerIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
 }
 
 // Copy assignment
@@ -342,7 +1462,6 @@ RoundRobinLoadBalancer& RoundRobinLoadBalancer::operator=(const RoundRobinLoadBa
 {
     if (this != &other) {
         LoadBalancer::operator=(other);
-        _currentServerIndex.store(other._currentServerIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
     }
     return *this;
 }
@@ -352,7 +1471,6 @@ RoundRobinLoadBalancer& RoundRobinLoadBalancer::operator=(RoundRobinLoadBalancer
 {
     if (this != &other) {
         LoadBalancer::operator=(std::move(other));
-        _currentServerIndex.store(other._currentServerIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
     }
     return *this;
 }
@@ -360,64 +1478,21 @@ RoundRobinLoadBalancer& RoundRobinLoadBalancer::operator=(RoundRobinLoadBalancer
 // Destructor
 RoundRobinLoadBalancer::~RoundRobinLoadBalancer() = default;
 
-// Get next server using round robin algorithm
-std::shared_ptr<Server> RoundRobinLoadBalancer::getNextServer()
+// Update current server (internal implementation detail)
+void RoundRobinLoadBalancer::updateCurrentServer()
 {
-    std::shared_lock<std::shared_mutex> lock(_serversMutex);
-    
-    if (_serversList.empty()) {
-        return nullptr;
-    }
-    
-    // First pass: find a healthy server
-    size_t startIndex = _currentServerIndex.load(std::memory_order_acquire);
-    size_t serverCount = _serversList.size();
-    std::shared_ptr<Server> fallbackServer = nullptr;
-    
-    for (size_t i = 0; i < serverCount; ++i) {
-        size_t index = (startIndex + i) % serverCount;
-        auto& server = _serversList[index];
-        
-        if (server->isAlive()) {
-            if (server->isHealthy()) {
-                // Found a healthy server, update index and return it
-                _currentServerIndex.store((index + 1) % serverCount, std::memory_order_release);
-                return server;
-            } else if (!fallbackServer) {
-                // Keep first alive but unhealthy server as fallback
-                fallbackServer = server;
-            }
-        }
-    }
-    
-    // If we found at least an alive but unhealthy server, use it
-    if (fallbackServer) {
-        // Find this server's index to update the counter
-        for (size_t i = 0; i < serverCount; ++i) {
-            if (_serversList[i] == fallbackServer) {
-                _currentServerIndex.store((i + 1) % serverCount, std::memory_order_release);
-                break;
-            }
-        }
-        return fallbackServer;
-    }
-    
-    // No available servers
-    return nullptr;
+    engineAs<RoundRobinEngine>().advance();
 }
 
-// Update current server (internal implementation detail)
-void RoundRobinLoadBalancer::updateCurrentServer()
+// Cursor mode of the round robin engine (kept while another strategy is active)
+void RoundRobinLoadBalancer::setCursorMode(CursorMode mode)
 {
-    // Use shared lock for reading the server count
-    std::shared_lock<std::shared_mutex> lock(_serversMutex);
-    
-    if (_serversList.empty()) {
-        return;
-    }
-    
-    size_t index = _currentServerIndex.load(std::memory_order_relaxed);
-    _currentServerIndex.store((index + 1) % _serversList.size(), std::memory_order_relaxed);
+    engineAs<RoundRobinEngine>().setCursorMode(mode);
+}
+
+CursorMode RoundRobinLoadBalancer::getCursorMode() const
+{
+    return engineAs<RoundRobinEngine>().getCursorMode();
 }
 
 // WeightedRoundRobinLoadBalancer implementation
@@ -427,32 +1502,24 @@ WeightedRoundRobinLoadBalancer::WeightedRoundRobinLoadBalancer(
     const std::vector<std::shared_ptr<Server>>& servers,
     uint32_t healthCheckInterval,
     uint32_t maxHealthCheckFailures
-) : LoadBalancer(servers, LoadBalancingStrategy::WEIGHTED_ROUND_ROBIN, healthCheckInterval, maxHealthCheckFailures),
-    _currentServerIndex(0)
+) : LoadBalancer(servers, LoadBalancingStrategy::WEIGHTED_ROUND_ROBIN, healthCheckInterval, maxHealthCheckFailures)
 {
     if (servers.empty()) {
         throw std::invalid_argument("Server list cannot be empty");
     }
-    
-    updateWeightedList();
 }
 
 // Copy constructor
 WeightedRoundRobinLoadBalancer::WeightedRoundRobinLoadBalancer(const WeightedRoundRobinLoadBalancer& other)
-    : LoadBalancer(other),
-      _currentServerIndex(other._currentServerIndex.load(std::memory_order_relaxed))
+    : LoadBalancer(other)
 {
-    std::lock_guard<std::mutex> lock(other._weightedListMutex);
-    _weightedServersList = other._weightedServersList;
 }
 
 // Move constructor
 WeightedRoundRobinLoadBalancer::WeightedRoundRobinLoadBalancer(WeightedRoundRobinLoadBalancer&& other) noexcept
-    : LoadBalancer(std::move(other)),
-      _currentServerIndex(other._currentServerIndex.load(std::memory_order_relaxed))
+    : LoadBalancer(std::move(other))
 {
-    std::lock_guard<std::mutex> lock(other._weightedListMutex);
-    _weightedServersList = std::move(other._weightedServersList);
+    // The stolen snapshot already carries its schedule
 }
 
 // Copy assignment operator
@@ -460,11 +1527,6 @@ WeightedRoundRobinLoadBalancer& WeightedRoundRobinLoadBalancer::operator=(const
 {
     if (this != &other) {
         LoadBalancer::operator=(other);
-        _currentServerIndex.store(other._currentServerIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
-        
-        // Use std::scoped_lock for multiple mutex acquisition (C++17)
-        std::scoped_lock lock(_weightedListMutex, other._weightedListMutex);
-        _weightedServersList = other._weightedServersList;
     }
     return *this;
 }
@@ -474,102 +1536,9 @@ WeightedRoundRobinLoadBalancer& WeightedRoundRobinLoadBalancer::operator=(Weight
 {
     if (this != &other) {
         LoadBalancer::operator=(std::move(other));
-        _currentServerIndex.store(other._currentServerIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
-        
-        // Use std::scoped_lock for multiple mutex acquisition (C++17)
-        std::scoped_lock lock(_weightedListMutex, other._weightedListMutex);
-        _weightedServersList = std::move(other._weightedServersList);
     }
     return *this;
 }
 
 // Destructor
 WeightedRoundRobinLoadBalancer::~WeightedRoundRobinLoadBalancer() = default;
-
-// Update the weighted servers list
-void WeightedRoundRobinLoadBalancer::updateWeightedList()
-{
-    // First get a copy of the servers list with shared lock
-    std::vector<std::shared_ptr<Server>> serversCopy;
-    {
-        std::shared_lock<std::shared_mutex> lock(_serversMutex);
-        serversCopy = _serversList;
-    }
-    
-    // Then update the weighted list with exclusive lock
-    std::lock_guard<std::mutex> lock(_weightedListMutex);
-    _weightedServersList.clear();
-    
-    for (const auto& server : serversCopy) {
-        // Only include servers that are alive
-        if (server->isAlive()) {
-            uint32_t weight = server->getWeight();
-            for (uint32_t i = 0; i < weight; ++i) {
-                _weightedServersList.push_back(server);
-            }
-        }
-    }
-}
-
-// Get next server using weighted round robin algorithm
-std::shared_ptr<Server> WeightedRoundRobinLoadBalancer::getNextServer()
-{
-    // First check if we need to update the weighted list
-    {
-        std::shared_lock<std::shared_mutex> serversLock(_serversMutex);
-        std::unique_lock<std::mutex> weightedLock(_weightedListMutex);
-        
-        // If the weighted list is empty or servers have changed, update it
-        if (_weightedServersList.empty() || _weightedServersList.size() == 0) {
-            // Release locks in correct order
-            serversLock.unlock();
-            weightedLock.unlock();
-            
-            // Update the weighted list
-            updateWeightedList();
-        }
-    }
-    
-    // Now get a server from the weighted list
-    std::lock_guard<std::mutex> lock(_weightedListMutex);
-    
-    if (_weightedServersList.empty()) {
-        return nullptr; // No servers available
-    }
-    
-    size_t startIndex = _currentServerIndex.load(std::memory_order_acquire);
-    size_t serverCount = _weightedServersList.size();
-    std::shared_ptr<Server> fallbackServer = nullptr;
-    
-    // First try to find a healthy server
-    for (size_t i = 0; i < serverCount; ++i) {
-        size_t index = (startIndex + i) % serverCount;
-        auto& server = _weightedServersList[index];
-        
-        if (server->isAlive()) {
-            if (server->isHealthy()) {
-                // Found a healthy server, update index and return it
-                _currentServerIndex.store((index + 1) % serverCount, std::memory_order_release);
-                return server;
-            } else if (!fallbackServer) {
-                // Keep first alive but unhealthy server as fallback
-                fallbackServer = server;
-            }
-        }
-    }
-    
-    // If we found at least an alive but unhealthy server, use it
-    if (fallbackServer) {
-        // Find this server's index to update the counter
-        for (size_t i = 0; i < serverCount; ++i) {
-            if (_weightedServersList[i] == fallbackServer) {
-                _currentServerIndex.store((i + 1) % serverCount, std::memory_order_release);
-                break;
-            }
-        }
-        return fallbackServer;
-    }
-    
-    // No available servers, trigger an update of the weighted list
-    return nullptr;
-}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "selection_engine.hpp"
+#include "round_robin_load_balancer.hpp"
+#include "least_connections_load_balancer.hpp"
+#include "ip_hash_load_balancer.hpp"
+#include "peak_ewma_load_balancer.hpp"
+
+// Engine factory
+std::unique_ptr<SelectionEngine> SelectionEngine::create(LoadBalancingStrategy strategy)
+{
+    switch (strategy) {
+    case LoadBalancingStrategy::WEIGHTED_ROUND_ROBIN:
+        return std::make_unique<WeightedRoundRobinEngine>();
+    case LoadBalancingStrategy::LEAST_CONNECTIONS:
+        return std::make_unique<LeastConnectionsEngine>();
+    case LoadBalancingStrategy::IP_HASH:
+        return std::make_unique<IpHashEngine>();
+    case LoadBalancingStrategy::PEAK_EWMA:
+        return std::make_unique<PeakEwmaEngine>();
+    case LoadBalancingStrategy::ROUND_ROBIN:
+    default:
+        return std::make_unique<RoundRobinEngine>();
+    }
+}
+
+ServerSnapshot* SelectionEngine::buildSnapshot(std::vector<std::shared_ptr<Server>> servers) const
+{
+    return new ServerSnapshot(std::move(servers));
+}
+
+// Batch selection
+size_t SelectionEngine::selectIndices(const ServerSnapshot& snapshot, const SlowStart& slowStart, std::span<size_t> out)
+{
+    size_t written = 0;
+    for (size_t& slot : out) {
+        size_t index = selectIndex(snapshot, slowStart);
+        if (index == ServerSnapshot::npos) {
+            break;
+        }
+        slot = index;
+        ++written;
+    }
+    return written;
+}
+
+size_t SelectionEngine::selectForKey(const ServerSnapshot& snapshot, const SlowStart& slowStart, uint64_t)
+{
+    return selectIndex(snapshot, slowStart);
+}
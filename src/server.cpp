@@ -1,54 +1,76 @@
 #include "server.hpp"
+#include "epoch_domain.hpp"
 #include <chrono>
 
+namespace {
+    std::chrono::steady_clock::rep steadyNow()
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+}
+
 // Constructor
 Server::Server(const std::string& serverAddress, uint32_t weight)
-    : _serverAddress(serverAddress),
-      _isAlive(true),
-      _isHealthy(false),
-      _lastHealthCheck(std::chrono::steady_clock::now()),
-      _weight(weight),
-      _currentConnections(0),
+    : _hot(ServerHotStatePool::instance().acquire()),
+      _serverAddress(serverAddress),
+      _lastHealthCheck(steadyNow()),
       _failureCount(0)
 {
+    _hot->weight.store(weight, std::memory_order_relaxed);
+    parseAddress();
 }
 
 // Move constructor
 Server::Server(std::string&& serverAddress, uint32_t weight)
-    : _serverAddress(std::move(serverAddress)),
-      _isAlive(true),
-      _isHealthy(false),
-      _lastHealthCheck(std::chrono::steady_clock::now()),
-      _weight(weight),
-      _currentConnections(0),
+    : _hot(ServerHotStatePool::instance().acquire()),
+      _serverAddress(std::move(serverAddress)),
+      _lastHealthCheck(steadyNow()),
       _failureCount(0)
 {
+    _hot->weight.store(weight, std::memory_order_relaxed);
+    parseAddress();
 }
 
 // Copy constructor
 Server::Server(const Server& other)
-    : _serverAddress(other._serverAddress),
-      _isAlive(other._isAlive.load()),
-      _isHealthy(other._isHealthy.load()),
-      _weight(other._weight.load()),
-      _currentConnections(0),  // Don't copy connection count
-      _failureCount(other._failureCount.load())
+    : _hot(ServerHotStatePool::instance().acquire()),
+      _serverAddress(other._serverAddress),
+      _lastHealthCheck(other._lastHealthCheck.load()),
+      _failureCount(other._failureCount.load()),
+      _zone(other.getZone()),
+      _priority(other._priority.load())
 {
-    std::lock_guard<std::mutex> lock(other._timeMutex);
-    _lastHealthCheck = other._lastHealthCheck;
+    // Don't copy connection count, request outcomes, metrics or pooled connections
+    _hot->flags.store(other._hot->flags.load());
+    _hot->weight.store(other._hot->weight.load());
+    _hot->concurrencyLimit.store(other._hot->concurrencyLimit.load());
+    parseAddress();
+    
+    ServerEndpoint endpoint;
+    if (other.getEndpoint(endpoint)) {
+        setEndpoint(endpoint);
+    }
 }
 
 // Move constructor
-Server::Server(Server&& other) noexcept
-    : _serverAddress(std::move(other._serverAddress)),
-      _isAlive(other._isAlive.load()),
-      _isHealthy(other._isHealthy.load()),
-      _weight(other._weight.load()),
-      _currentConnections(0),  // Don't move connection count
-      _failureCount(other._failureCount.load())
+Server::Server(Server&& other)
+    : _hot(ServerHotStatePool::instance().acquire()),
+      _serverAddress(std::move(other._serverAddress)),
+      _lastHealthCheck(other._lastHealthCheck.load()),
+      _failureCount(other._failureCount.load()),
+      _zone(other.getZone()),
+      _priority(other._priority.load())
 {
-    std::lock_guard<std::mutex> lock(other._timeMutex);
-    _lastHealthCheck = other._lastHealthCheck;
+    // Don't move connection count, request outcomes, metrics or pooled connections
+    _hot->flags.store(other._hot->flags.load());
+    _hot->weight.store(other._hot->weight.load());
+    _hot->concurrencyLimit.store(other._hot->concurrencyLimit.load());
+    parseAddress();
+    
+    ServerEndpoint endpoint;
+    if (other.getEndpoint(endpoint)) {
+        setEndpoint(endpoint);
+    }
 }
 
 // Copy assignment
@@ -56,41 +78,81 @@ Server& Server::operator=(const Server& other)
 {
     if (this != &other) {
         _serverAddress = other._serverAddress;
-        _isAlive.store(other._isAlive.load());
-        _isHealthy.store(other._isHealthy.load());
-        _weight.store(other._weight.load());
-        _failureCount.store(other._failureCount.load());
+        parseAddress();
         
-        // Don't copy connection count
+        ServerEndpoint endpoint;
+        replaceEndpoint(other.getEndpoint(endpoint) ? &endpoint : nullptr);
         
-        std::lock_guard<std::mutex> lockOther(other._timeMutex);
-        std::lock_guard<std::mutex> lockThis(_timeMutex);
-        _lastHealthCheck = other._lastHealthCheck;
+        _hot->flags.store(other._hot->flags.load());
+        _hot->weight.store(other._hot->weight.load());
+        _hot->concurrencyLimit.store(other._hot->concurrencyLimit.load());
+        _hot->noteChange();
+        _failureCount.store(other._failureCount.load());
+        _lastHealthCheck.store(other._lastHealthCheck.load());
+        setZone(other.getZone());
+        _priority.store(other._priority.load());
+
+        // Don't copy connection count, request outcomes, metrics or pooled connections
     }
     return *this;
 }
 
 // Move assignment
-Server& Server::operator=(Server&& other) noexcept
+Server& Server::operator=(Server&& other)
 {
     if (this != &other) {
         _serverAddress = std::move(other._serverAddress);
-        _isAlive.store(other._isAlive.load());
-        _isHealthy.store(other._isHealthy.load());
-        _weight.store(other._weight.load());
-        _failureCount.store(other._failureCount.load());
+        parseAddress();
         
-        // Don't move connection count
+        ServerEndpoint endpoint;
+        replaceEndpoint(other.getEndpoint(endpoint) ? &endpoint : nullptr);
         
-        std::lock_guard<std::mutex> lockOther(other._timeMutex);
-        std::lock_guard<std::mutex> lockThis(_timeMutex);
-        _lastHealthCheck = other._lastHealthCheck;
+        _hot->flags.store(other._hot->flags.load());
+        _hot->weight.store(other._hot->weight.load());
+        _hot->concurrencyLimit.store(other._hot->concurrencyLimit.load());
+        _hot->noteChange();
+        _failureCount.store(other._failureCount.load());
+        _lastHealthCheck.store(other._lastHealthCheck.load());
+        setZone(other.getZone());
+        _priority.store(other._priority.load());
+
+        // Don't move connection count, request outcomes, metrics or pooled connections
     }
     return *this;
 }
 
 // Destructor
-Server::~Server() = default;
+Server::~Server()
+{
+    ServerHotStatePool::instance().release(_hot);
+    
+    // Readers only use the endpoint while holding the server, so no grace period is needed here
+    delete _endpoint.load(std::memory_order_relaxed);
+    delete _connectionPool.load(std::memory_order_relaxed);
+}
+
+// Address parsing
+void Server::parseAddress()
+{
+    _addressValid = ServerEndpoint::parseAddress(_serverAddress, _host, _port);
+    
+    ServerEndpoint endpoint;
+    if (_addressValid && ServerEndpoint::fromLiteral(_host, _port, endpoint)) {
+        replaceEndpoint(&endpoint);
+    } else {
+        replaceEndpoint(nullptr);
+    }
+}
+
+void Server::replaceEndpoint(const ServerEndpoint* endpoint)
+{
+    const ServerEndpoint* next = endpoint ? new ServerEndpoint(*endpoint) : nullptr;
+    const ServerEndpoint* previous = _endpoint.exchange(next, std::memory_order_seq_cst);
+    
+    if (previous) {
+        EpochDomain::instance().retire([previous]() { delete previous; });
+    }
+}
 
 // Getters
 const std::string& Server::getServerAddress() const
@@ -100,28 +162,27 @@ const std::string& Server::getServerAddress() const
 
 bool Server::isAlive() const
 {
-    return _isAlive.load();
+    return _hot->isAlive();
 }
 
 bool Server::isHealthy() const
 {
-    return _isHealthy.load();
+    return _hot->isHealthy();
 }
 
 std::chrono::time_point<std::chrono::steady_clock> Server::getLastHealthCheck() const
 {
-    std::lock_guard<std::mutex> lock(_timeMutex);
-    return _lastHealthCheck;
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(_lastHealthCheck.load()));
 }
 
 uint32_t Server::getWeight() const
 {
-    return _weight.load();
+    return _hot->weight.load();
 }
 
 uint32_t Server::getCurrentConnections() const
 {
-    return _currentConnections.load();
+    return _hot->currentConnections.load();
 }
 
 uint32_t Server::getFailureCount() const
@@ -129,16 +190,140 @@ uint32_t Server::getFailureCount() const
     return _failureCount.load();
 }
 
+const ServerHotState& Server::hotState() const
+{
+    return *_hot;
+}
+
+const std::string& Server::getHost() const
+{
+    return _host;
+}
+
+uint16_t Server::getPort() const
+{
+    return _port;
+}
+
+bool Server::hasValidAddress() const
+{
+    return _addressValid;
+}
+
+bool Server::getEndpoint(ServerEndpoint& endpoint) const
+{
+    EpochDomain::Guard guard;
+    const ServerEndpoint* current = _endpoint.load(std::memory_order_seq_cst);
+    if (!current) {
+        return false;
+    }
+    endpoint = *current;
+    return true;
+}
+
+void Server::setEndpoint(const ServerEndpoint& endpoint)
+{
+    replaceEndpoint(&endpoint);
+}
+
+void Server::beginSlowStart()
+{
+    _hot->rampStart.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+// Locality
+void Server::setZone(const std::string& zone)
+{
+    std::lock_guard<std::mutex> lock(_zoneMutex);
+    _zone = zone;
+}
+
+std::string Server::getZone() const
+{
+    std::lock_guard<std::mutex> lock(_zoneMutex);
+    return _zone;
+}
+
+void Server::setPriority(uint32_t priority)
+{
+    _priority.store(priority, std::memory_order_relaxed);
+}
+
+uint32_t Server::getPriority() const
+{
+    return _priority.load(std::memory_order_relaxed);
+}
+
+// Connection pooling
+ConnectionPool& Server::enableConnectionPool()
+{
+    ConnectionPool* pool = _connectionPool.load(std::memory_order_acquire);
+    if (pool) {
+        return *pool;
+    }
+    
+    // Racing callers agree on the first pool published
+    auto* created = new ConnectionPool();
+    if (_connectionPool.compare_exchange_strong(pool, created, std::memory_order_acq_rel)) {
+        return *created;
+    }
+    delete created;
+    return *pool;
+}
+
+ConnectionPool* Server::getConnectionPool() const
+{
+    return _connectionPool.load(std::memory_order_acquire);
+}
+
+PooledConnection Server::acquireConnection(bool mayConnect)
+{
+    ConnectionPool* pool = getConnectionPool();
+    ServerEndpoint endpoint;
+    if (!pool || !getEndpoint(endpoint)) {
+        return PooledConnection();
+    }
+    return mayConnect ? pool->acquire(endpoint) : pool->tryAcquire(endpoint);
+}
+
+const ServerOutcomeStats& Server::getOutcomeStats() const
+{
+    return _outcomes;
+}
+
+void Server::restoreLatency(uint64_t ewmaNanos, double peakMicros)
+{
+    _outcomes.seedLatency(ewmaNanos);
+    _hot->seedPeakLatency(peakMicros, std::chrono::steady_clock::now());
+}
+
+bool Server::isEjected() const
+{
+    return _outcomes.isEjected(std::chrono::steady_clock::now());
+}
+
+ServerMetrics& Server::getMetrics()
+{
+    return _metrics;
+}
+
+const ServerMetrics& Server::getMetrics() const
+{
+    return _metrics;
+}
+
 // Setters
 void Server::setAlive(bool isAlive)
 {
-    _isAlive.store(isAlive);
+    _hot->setFlag(ServerHotState::kAlive, isAlive);
 }
 
 void Server::setHealthy(bool isHealthy)
 {
-    _isHealthy.store(isHealthy);
-    
+    if (_hot->setFlag(ServerHotState::kHealthy, isHealthy) && isHealthy) {
+        beginSlowStart();
+    }
+
     // Reset failure count if healthy
     if (isHealthy) {
         resetFailures();
@@ -147,27 +332,45 @@ void Server::setHealthy(bool isHealthy)
 
 void Server::updateLastHealthCheck()
 {
-    std::lock_guard<std::mutex> lock(_timeMutex);
-    _lastHealthCheck = std::chrono::steady_clock::now();
+    _lastHealthCheck.store(steadyNow());
 }
 
 void Server::setWeight(uint32_t weight)
 {
-    _weight.store(weight);
+    _hot->setWeight(weight);
 }
 
 // Connection management
+void Server::setConcurrencyLimit(uint32_t limit)
+{
+    _hot->concurrencyLimit.store(limit, std::memory_order_relaxed);
+}
+
+uint32_t Server::getConcurrencyLimit() const
+{
+    return _hot->concurrencyLimit.load(std::memory_order_relaxed);
+}
+
 void Server::incrementConnections()
 {
-    _currentConnections++;
+    _hot->currentConnections++;
 }
 
 void Server::decrementConnections()
 {
-    // Prevent underflow
-    uint32_t current = _currentConnections.load();
-    if (current > 0) {
-        _currentConnections--;
+    // Prevent underflow; the CAS keeps concurrent decrements from racing past zero
+    uint32_t current = _hot->currentConnections.load(std::memory_order_relaxed);
+    while (current > 0 &&
+           !_hot->currentConnections.compare_exchange_weak(current, current - 1, std::memory_order_release,
+                                                           std::memory_order_relaxed)) {
+    }
+}
+
+void Server::setRemoteConnections(uint32_t connections)
+{
+    // Skip the store when unchanged, so idle cluster syncs leave the hot line alone
+    if (_hot->remoteConnections.load(std::memory_order_relaxed) != connections) {
+        _hot->remoteConnections.store(connections, std::memory_order_relaxed);
     }
 }
 
@@ -179,14 +382,14 @@ void Server::incrementFailures()
 
 void Server::resetFailures()
 {
-    _failureCount.store(0);
+    // Skip the store when already zero to keep the line clean on the success path
+    if (_failureCount.load(std::memory_order_relaxed) != 0) {
+        _failureCount.store(0);
+    }
 }
 
 // Calculate effective load
 double Server::getEffectiveLoad() const
 {
-    uint32_t weight = _weight.load();
-    if (weight == 0) weight = 1; // Prevent division by zero
-    
-    return static_cast<double>(_currentConnections.load()) / weight;
-}
\ No newline at end of file
+    return _hot->effectiveLoad();
+}
@@ -0,0 +1,107 @@
+#include "server_bitmap.hpp"
+#include <bit>
+
+// Constructor
+ServerBitmap::ServerBitmap(size_t size)
+    : _size(size),
+      _wordCount((size + 63) / 64),
+      _words(new std::atomic<uint64_t>[(size + 63) / 64])
+{
+    for (size_t i = 0; i < _wordCount; ++i) {
+        _words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// Bit access
+void ServerBitmap::set(size_t index, bool value)
+{
+    if (index >= _size) {
+        return;
+    }
+
+    uint64_t mask = uint64_t(1) << (index & 63);
+    if (value) {
+        _words[index >> 6].fetch_or(mask, std::memory_order_release);
+    } else {
+        _words[index >> 6].fetch_and(~mask, std::memory_order_release);
+    }
+}
+
+bool ServerBitmap::test(size_t index) const
+{
+    if (index >= _size) {
+        return false;
+    }
+    return (_words[index >> 6].load(std::memory_order_acquire) >> (index & 63)) & 1;
+}
+
+// Search
+size_t ServerBitmap::findNext(size_t from) const
+{
+    if (_size == 0) {
+        return npos;
+    }
+    if (from >= _size) {
+        from = 0;
+    }
+
+    size_t startWord = from >> 6;
+
+    // Bits at or after `from` in its own word, then the following words
+    uint64_t word = _words[startWord].load(std::memory_order_acquire) & (~uint64_t(0) << (from & 63));
+    for (size_t i = startWord; ; ) {
+        if (word != 0) {
+            return (i << 6) + static_cast<size_t>(std::countr_zero(word));
+        }
+        if (++i == _wordCount) {
+            break;
+        }
+        word = _words[i].load(std::memory_order_acquire);
+    }
+
+    // Wrap around: words before `from`, including the low bits of its word
+    for (size_t i = 0; i <= startWord; ++i) {
+        word = _words[i].load(std::memory_order_acquire);
+        if (i == startWord) {
+            word &= (uint64_t(1) << (from & 63)) - 1;
+        }
+        if (word != 0) {
+            return (i << 6) + static_cast<size_t>(std::countr_zero(word));
+        }
+    }
+
+    return npos;
+}
+
+size_t ServerBitmap::findNth(size_t rank) const
+{
+    for (size_t i = 0; i < _wordCount; ++i) {
+        uint64_t word = _words[i].load(std::memory_order_acquire);
+        size_t bits = static_cast<size_t>(std::popcount(word));
+        if (rank >= bits) {
+            rank -= bits;
+            continue;
+        }
+
+        // Drop the lower set bits of the word holding it
+        for (; rank != 0; --rank) {
+            word &= word - 1;
+        }
+        return (i << 6) + static_cast<size_t>(std::countr_zero(word));
+    }
+    return npos;
+}
+
+size_t ServerBitmap::count() const
+{
+    size_t total = 0;
+    for (size_t i = 0; i < _wordCount; ++i) {
+        total += static_cast<size_t>(std::popcount(_words[i].load(std::memory_order_relaxed)));
+    }
+    return total;
+}
+
+size_t ServerBitmap::size() const
+{
+    return _size;
+}
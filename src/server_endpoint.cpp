@@ -0,0 +1,83 @@
+#include "server_endpoint.hpp"
+#include <cstring>
+#include <charconv>
+
+// Platform-specific includes
+#ifndef _WIN32
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+#endif
+
+bool ServerEndpoint::parseAddress(const std::string& serverAddress, std::string& host, uint16_t& port)
+{
+    // Bracketed IPv6 literal: "[::1]:8080"
+    if (!serverAddress.empty() && serverAddress.front() == '[') {
+        size_t closePos = serverAddress.find(']');
+        if (closePos == std::string::npos) {
+            return false;
+        }
+        host = serverAddress.substr(1, closePos - 1);
+        if (closePos + 1 == serverAddress.size()) {
+            port = 80;
+            return true;
+        }
+        if (serverAddress[closePos + 1] != ':') {
+            return false;
+        }
+        const char* first = serverAddress.data() + closePos + 2;
+        const char* last = serverAddress.data() + serverAddress.size();
+        auto [end, error] = std::from_chars(first, last, port);
+        return error == std::errc() && end == last && first != last;
+    }
+
+    size_t colonPos = serverAddress.find(':');
+    if (colonPos == std::string::npos) {
+        // No port specified, use default HTTP port
+        host = serverAddress;
+        port = 80;
+        return true;
+    }
+
+    host = serverAddress.substr(0, colonPos);
+    const char* first = serverAddress.data() + colonPos + 1;
+    const char* last = serverAddress.data() + serverAddress.size();
+    auto [end, error] = std::from_chars(first, last, port);
+    return error == std::errc() && end == last && first != last; // Invalid port otherwise
+}
+
+bool ServerEndpoint::fromLiteral(const std::string& host, uint16_t port, ServerEndpoint& endpoint)
+{
+    endpoint = ServerEndpoint();
+
+    auto* ipv4 = reinterpret_cast<sockaddr_in*>(&endpoint.address);
+    if (inet_pton(AF_INET, host.c_str(), &ipv4->sin_addr) == 1) {
+        ipv4->sin_family = AF_INET;
+        endpoint.length = sizeof(sockaddr_in);
+    } else {
+        auto* ipv6 = reinterpret_cast<sockaddr_in6*>(&endpoint.address);
+        if (inet_pton(AF_INET6, host.c_str(), &ipv6->sin6_addr) != 1) {
+            return false;
+        }
+        ipv6->sin6_family = AF_INET6;
+        endpoint.length = sizeof(sockaddr_in6);
+    }
+
+    // Literal addresses never need resolving again
+    endpoint.refreshAt = std::chrono::steady_clock::time_point::max();
+    endpoint.setPort(port);
+    return true;
+}
+
+void ServerEndpoint::setPort(uint16_t port)
+{
+    if (address.ss_family == AF_INET6) {
+        reinterpret_cast<sockaddr_in6*>(&address)->sin6_port = htons(port);
+    } else {
+        reinterpret_cast<sockaddr_in*>(&address)->sin_port = htons(port);
+    }
+}
+
+bool ServerEndpoint::sameAddress(const ServerEndpoint& other) const
+{
+    return length == other.length && memcmp(&address, &other.address, length) == 0;
+}
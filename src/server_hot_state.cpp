@@ -0,0 +1,207 @@
+#include "server_hot_state.hpp"
+#include "numa_topology.hpp"
+#include <bit>
+#include <cmath>
+
+namespace {
+    // Low 32 bits of the steady clock in milliseconds; differences stay valid across wraparound
+    uint32_t stampMillis(std::chrono::steady_clock::time_point now)
+    {
+        auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+        return static_cast<uint32_t>(millis);
+    }
+
+    uint64_t packPeak(float micros, uint32_t stamp)
+    {
+        return (static_cast<uint64_t>(std::bit_cast<uint32_t>(micros)) << 32) | stamp;
+    }
+
+    float unpackMicros(uint64_t packed)
+    {
+        return std::bit_cast<float>(static_cast<uint32_t>(packed >> 32));
+    }
+
+    // Weight kept by the old average after `elapsedMillis`
+    double decayWeight(uint32_t elapsedMillis)
+    {
+        return std::exp(-static_cast<double>(elapsedMillis) / static_cast<double>(ServerHotState::kPeakEwmaDecay.count()));
+    }
+}
+
+// ServerHotState implementation
+bool ServerHotState::setFlag(uint32_t flag, bool value)
+{
+    uint32_t current = flags.load(std::memory_order_relaxed);
+    if (((current & flag) != 0) == value) {
+        return false;
+    }
+
+    // The previous value tells which of several racing writers made the change
+    uint32_t previous = value ? flags.fetch_or(flag, std::memory_order_release)
+                              : flags.fetch_and(~flag, std::memory_order_release);
+    if (((previous & flag) != 0) == value) {
+        return false;
+    }
+
+    noteChange();
+    return true;
+}
+
+bool ServerHotState::tryAcquireConnection()
+{
+    uint32_t limit = concurrencyLimit.load(std::memory_order_relaxed);
+    if (limit == 0) {
+        currentConnections.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // CAS so concurrent acquirers cannot overshoot the limit together
+    uint32_t current = currentConnections.load(std::memory_order_relaxed);
+    do {
+        if (current >= limit) {
+            return false;
+        }
+    } while (!currentConnections.compare_exchange_weak(current, current + 1, std::memory_order_relaxed));
+    return true;
+}
+
+bool ServerHotState::setWeight(uint32_t value)
+{
+    if (weight.exchange(value, std::memory_order_release) == value) {
+        return false;
+    }
+
+    noteChange();
+    return true;
+}
+
+void ServerHotState::noteChange() const
+{
+    HotStateChangeLog::instance().record(this);
+}
+
+double ServerHotState::effectiveLoad() const
+{
+    uint32_t w = weight.load(std::memory_order_relaxed);
+    if (w == 0) w = 1; // Prevent division by zero
+
+    return static_cast<double>(currentConnections.load(std::memory_order_relaxed)) / w;
+}
+
+// Peak-EWMA: jump up to slower samples, decay towards faster ones by elapsed time
+void ServerHotState::recordPeakLatency(std::chrono::nanoseconds latency, std::chrono::steady_clock::time_point now)
+{
+    uint32_t stamp = stampMillis(now);
+    double sampleMicros = latency.count() > 0 ? static_cast<double>(latency.count()) / 1000.0 : 0.0;
+    uint64_t packed = peakEwma.load(std::memory_order_relaxed);
+    uint64_t updated;
+    do {
+        double cost = unpackMicros(packed);
+        if (packed != 0 && sampleMicros < cost) {
+            double weight = decayWeight(stamp - static_cast<uint32_t>(packed));
+            cost = cost * weight + sampleMicros * (1.0 - weight);
+        } else {
+            cost = sampleMicros;
+        }
+        updated = packPeak(static_cast<float>(cost), stamp);
+    } while (!peakEwma.compare_exchange_weak(packed, updated, std::memory_order_relaxed));
+}
+
+double ServerHotState::peakLatencyMicros(std::chrono::steady_clock::time_point now) const
+{
+    uint64_t packed = peakEwma.load(std::memory_order_relaxed);
+    if (packed == 0) {
+        return 0.0;
+    }
+
+    // Idle servers decay towards zero so they are tried again
+    return unpackMicros(packed) * decayWeight(stampMillis(now) - static_cast<uint32_t>(packed));
+}
+
+void ServerHotState::seedPeakLatency(double micros, std::chrono::steady_clock::time_point now)
+{
+    if (micros > 0.0) {
+        uint64_t expected = 0;
+        peakEwma.compare_exchange_strong(expected, packPeak(static_cast<float>(micros), stampMillis(now)), std::memory_order_relaxed);
+    }
+}
+
+// HotStateChangeLog implementation
+
+// Process-wide log, intentionally leaked like the pool
+HotStateChangeLog& HotStateChangeLog::instance()
+{
+    static HotStateChangeLog* log = new HotStateChangeLog();
+    return *log;
+}
+
+void HotStateChangeLog::record(const ServerHotState* state)
+{
+    uint64_t sequence = _head.fetch_add(1, std::memory_order_acq_rel);
+    Slot& slot = _slots[sequence & (kCapacity - 1)];
+
+    // Mark the slot as being rewritten so a reader of its previous entry sees the overrun
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.state.store(state, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_release);
+}
+
+uint64_t HotStateChangeLog::head() const
+{
+    return _head.load(std::memory_order_acquire);
+}
+
+// ServerHotStatePool implementation
+
+// Process-wide pool, intentionally leaked so Servers destroyed at exit can still release
+ServerHotStatePool& ServerHotStatePool::instance()
+{
+    static ServerHotStatePool* pool = new ServerHotStatePool();
+    return *pool;
+}
+
+ServerHotState* ServerHotStatePool::acquire()
+{
+    // First touch by the constructing thread places new chunks on its node
+    size_t arenaIndex = NumaTopology::instance().currentNode() % kMaxArenas;
+    Arena& arena = _arenas[arenaIndex];
+    ServerHotState* block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(arena.mutex);
+
+        if (!arena.freeList.empty()) {
+            block = arena.freeList.back();
+            arena.freeList.pop_back();
+        } else {
+            if (arena.nextInChunk == kBlocksPerChunk) {
+                arena.chunks.push_back(new Chunk());
+                arena.nextInChunk = 0;
+            }
+            block = &arena.chunks.back()->blocks[arena.nextInChunk++];
+            block->poolArena = static_cast<uint32_t>(arenaIndex);
+        }
+    }
+
+    // Reset to the state of a freshly constructed block
+    block->flags.store(ServerHotState::kAlive, std::memory_order_relaxed);
+    block->weight.store(1, std::memory_order_relaxed);
+    block->currentConnections.store(0, std::memory_order_relaxed);
+    block->remoteConnections.store(0, std::memory_order_relaxed);
+    block->concurrencyLimit.store(0, std::memory_order_relaxed);
+    block->rampStart.store(0, std::memory_order_relaxed);
+    block->peakEwma.store(0, std::memory_order_relaxed);
+    return block;
+}
+
+void ServerHotStatePool::release(ServerHotState* state)
+{
+    if (!state) {
+        return;
+    }
+
+    // Back to the arena whose chunk holds it
+    Arena& arena = _arenas[state->poolArena];
+    std::lock_guard<std::mutex> lock(arena.mutex);
+    arena.freeList.push_back(state);
+}
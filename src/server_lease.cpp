@@ -0,0 +1,158 @@
+#include "server_lease.hpp"
+#include "outlier_detector.hpp"
+#include "concurrency_limiter.hpp"
+#include <algorithm>
+
+// ServerLease implementation
+
+// Constructor
+ServerLease::ServerLease(Server* server, size_t index, OutlierDetector* detector, ConcurrencyLimiter* limiter) noexcept
+    : _server(server),
+      _index(index),
+      _detector(detector),
+      _limiter(limiter)
+{
+    if (_server && !_server->_hot->tryAcquireConnection()) {
+        _server = nullptr; // Saturated
+    }
+    if (_server) {
+        _issuedAt = std::chrono::steady_clock::now();
+    }
+}
+
+// Destructor
+ServerLease::~ServerLease()
+{
+    release();
+}
+
+// Move constructor
+ServerLease::ServerLease(ServerLease&& other) noexcept
+    : _server(other._server),
+      _index(other._index),
+      _detector(other._detector),
+      _limiter(other._limiter),
+      _issuedAt(other._issuedAt),
+      _connection(std::move(other._connection))
+{
+    other._server = nullptr;
+}
+
+// Move assignment
+ServerLease& ServerLease::operator=(ServerLease&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        _server = other._server;
+        _index = other._index;
+        _detector = other._detector;
+        _limiter = other._limiter;
+        _issuedAt = other._issuedAt;
+        _connection = std::move(other._connection);
+        other._server = nullptr;
+    }
+    return *this;
+}
+
+// Access
+Server* ServerLease::get() const noexcept
+{
+    return _server;
+}
+
+Server& ServerLease::operator*() const noexcept
+{
+    return *_server;
+}
+
+Server* ServerLease::operator->() const noexcept
+{
+    return _server;
+}
+
+ServerLease::operator bool() const noexcept
+{
+    return _server != nullptr;
+}
+
+size_t ServerLease::index() const noexcept
+{
+    return _index;
+}
+
+PooledConnection& ServerLease::connection(bool mayConnect)
+{
+    if (_server && !_connection) {
+        _connection = _server->acquireConnection(mayConnect);
+    }
+    return _connection;
+}
+
+void ServerLease::release() noexcept
+{
+    // Socket first: once the slot is gone a removed server (and its pool) may be freed
+    _connection.release();
+    if (_server) {
+        // Paired with the increment in the constructor; the decrement still stops at zero
+        _server->decrementConnections();
+        _server = nullptr;
+    }
+}
+
+void ServerLease::complete(bool success)
+{
+    if (_server && (_detector || _limiter)) {
+        auto latency = std::chrono::steady_clock::now() - _issuedAt;
+        if (_detector) {
+            _detector->recordOutcome(*_server, success, latency);
+        }
+        if (_limiter) {
+            _limiter->recordOutcome(*_server, success, latency);
+        }
+    }
+    if (!success) {
+        _connection.markBroken();
+    }
+    release();
+}
+
+// ServerDrainList implementation
+
+// Process-wide list, intentionally leaked so reclaimers running at exit can still use it
+ServerDrainList& ServerDrainList::instance()
+{
+    static ServerDrainList* list = new ServerDrainList();
+    return *list;
+}
+
+void ServerDrainList::pruneLocked()
+{
+    _draining.erase(
+        std::remove_if(_draining.begin(), _draining.end(),
+                      [](const std::shared_ptr<Server>& server) {
+                          return server->getCurrentConnections() == 0;
+                      }),
+        _draining.end()
+    );
+}
+
+void ServerDrainList::add(std::shared_ptr<Server> server)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (server && server->getCurrentConnections() > 0) {
+        _draining.push_back(std::move(server));
+    }
+    pruneLocked();
+}
+
+void ServerDrainList::collect()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    pruneLocked();
+}
+
+size_t ServerDrainList::size()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _draining.size();
+}
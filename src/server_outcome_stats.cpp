@@ -0,0 +1,54 @@
+#include "server_outcome_stats.hpp"
+
+namespace {
+    constexpr int kLatencyEwmaShift = 3; // Smoothing factor 1/8
+}
+
+uint32_t ServerOutcomeStats::record(bool success, std::chrono::nanoseconds latency)
+{
+    windowRequests.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t failures = 0;
+    if (success) {
+        // Skip the store when already zero to keep the line clean on the success path
+        if (consecutiveFailures.load(std::memory_order_relaxed) != 0) {
+            consecutiveFailures.store(0, std::memory_order_relaxed);
+        }
+    } else {
+        windowFailures.fetch_add(1, std::memory_order_relaxed);
+        failures = consecutiveFailures.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // EWMA in integer nanoseconds; the first sample seeds the average
+    uint64_t sample = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+    uint64_t current = latencyEwmaNanos.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        if (current == 0) {
+            next = sample;
+        } else {
+            int64_t delta = static_cast<int64_t>(sample) - static_cast<int64_t>(current);
+            next = static_cast<uint64_t>(static_cast<int64_t>(current) + delta / (1 << kLatencyEwmaShift));
+        }
+    } while (!latencyEwmaNanos.compare_exchange_weak(current, next, std::memory_order_relaxed));
+
+    return failures;
+}
+
+bool ServerOutcomeStats::isEjected(std::chrono::steady_clock::time_point now) const
+{
+    auto until = ejectedUntil.load(std::memory_order_acquire);
+    return until != 0 && until > now.time_since_epoch().count();
+}
+
+void ServerOutcomeStats::seedLatency(uint64_t ewmaNanos)
+{
+    uint64_t expected = 0;
+    latencyEwmaNanos.compare_exchange_strong(expected, ewmaNanos, std::memory_order_relaxed);
+}
+
+void ServerOutcomeStats::resetWindow()
+{
+    windowRequests.store(0, std::memory_order_relaxed);
+    windowFailures.store(0, std::memory_order_relaxed);
+}
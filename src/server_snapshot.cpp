@@ -0,0 +1,150 @@
+#include "server_snapshot.hpp"
+#include "locality_tiers.hpp"
+#include <algorithm>
+#include <random>
+
+namespace {
+    // Per-thread generator so sampling never touches shared state
+    std::mt19937& threadRandom()
+    {
+        thread_local std::mt19937 generator(std::random_device{}());
+        return generator;
+    }
+}
+
+// Constructor
+ServerSnapshot::ServerSnapshot(std::vector<std::shared_ptr<Server>> serverList)
+    : servers(std::move(serverList)),
+      available(servers.size()),
+      alive(servers.size())
+{
+    // Changes that race with reading the flags are replayed by the first sync()
+    _syncedSequence.store(HotStateChangeLog::instance().head(), std::memory_order_relaxed);
+
+    hotStates.reserve(servers.size());
+    _stateIndex.reserve(servers.size());
+    for (size_t i = 0; i < servers.size(); ++i) {
+        hotStates.push_back(&servers[i]->hotState());
+        _stateIndex.emplace_back(hotStates[i], i);
+        refreshIndex(i);
+    }
+    std::sort(_stateIndex.begin(), _stateIndex.end());
+}
+
+// Destructor
+ServerSnapshot::~ServerSnapshot() = default;
+
+void ServerSnapshot::refreshIndex(size_t index) const
+{
+    uint32_t flags = hotStates[index]->flags.load(std::memory_order_relaxed);
+    bool isAvailable = (flags & ServerHotState::kAvailable) == ServerHotState::kAvailable;
+    alive.set(index, (flags & ServerHotState::kAlive) != 0);
+
+    // Only the constructor and the sync lock holder get here, so the count has one writer
+    if (available.test(index) != isAvailable) {
+        available.set(index, isAvailable);
+        availableCount.store(availableCount.load(std::memory_order_relaxed) + (isAvailable ? 1 : size_t(-1)),
+                             std::memory_order_relaxed);
+    }
+}
+
+void ServerSnapshot::onStateChanged(size_t) const
+{
+}
+
+// Bring the indexes up to date with the change log
+void ServerSnapshot::sync() const
+{
+    const HotStateChangeLog& changeLog = HotStateChangeLog::instance();
+    if (_syncedSequence.load(std::memory_order_acquire) == changeLog.head()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_syncMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+
+    uint64_t position = _syncedSequence.load(std::memory_order_relaxed);
+    auto result = changeLog.replay(position, [this](const ServerHotState* state) {
+        // Changes to servers outside this snapshot find no entry
+        auto range = std::equal_range(_stateIndex.begin(), _stateIndex.end(), std::make_pair(state, size_t(0)),
+            [](const auto& left, const auto& right) { return left.first < right.first; });
+        for (auto it = range.first; it != range.second; ++it) {
+            refreshIndex(it->second);
+            onStateChanged(it->second);
+        }
+    });
+
+    if (result == HotStateChangeLog::ReplayResult::OVERRUN) {
+        // Fell too far behind: reread every server
+        position = changeLog.head();
+        for (size_t i = 0; i < hotStates.size(); ++i) {
+            refreshIndex(i);
+            onStateChanged(i);
+        }
+    }
+
+    _syncedSequence.store(position, std::memory_order_release);
+}
+
+size_t ServerSnapshot::sampleAvailable(size_t exclude) const
+{
+    size_t serverCount = servers.size();
+    if (serverCount == 0) {
+        return npos;
+    }
+
+    // Rejection sampling: each accepted draw is uniform over the candidates
+    std::uniform_int_distribution<size_t> anyServer(0, serverCount - 1);
+    for (size_t attempt = 0; attempt < kSampleDraws; ++attempt) {
+        size_t draw = anyServer(threadRandom());
+        if (draw != exclude && available.test(draw)) {
+            return draw;
+        }
+    }
+
+    // Mostly unavailable: draw a rank among the candidates instead
+    bool excluded = exclude != npos && available.test(exclude);
+    size_t candidates = availableCount.load(std::memory_order_relaxed);
+    if (candidates <= (excluded ? 1u : 0u)) {
+        return npos;
+    }
+    candidates -= excluded ? 1 : 0;
+
+    size_t rank = std::uniform_int_distribution<size_t>(0, candidates - 1)(threadRandom());
+    size_t index = available.findNth(rank);
+    if (excluded && index != ServerBitmap::npos && index >= exclude) {
+        index = available.findNth(rank + 1);
+    }
+    if (index == ServerBitmap::npos) {
+        // The bitmap lost servers since the count was read; take whatever follows the rank
+        index = available.findNext(rank);
+        if (index == exclude && index != npos) {
+            index = available.findNext(exclude + 1);
+        }
+        return index == exclude ? npos : index;
+    }
+    return index;
+}
+
+size_t ServerSnapshot::nextUnsaturated(const ServerBitmap& bits, size_t from) const
+{
+    size_t first = bits.findNext(from);
+    if (first == ServerBitmap::npos) {
+        return npos;
+    }
+
+    // One lap at most; the bits may change under the walk, so it is bounded by the size
+    size_t index = first;
+    for (size_t step = 0; step < hotStates.size(); ++step) {
+        if (!hotStates[index]->isSaturated()) {
+            return index;
+        }
+        index = bits.findNext(index + 1);
+        if (index == first || index == ServerBitmap::npos) {
+            break;
+        }
+    }
+    return first;
+}
@@ -0,0 +1,112 @@
+#include "server_table.hpp"
+#include <new>
+
+// Process-wide table, intentionally leaked so servers released at exit can still give their slot back
+ServerTable& ServerTable::instance()
+{
+    static ServerTable* table = new ServerTable();
+    return *table;
+}
+
+ServerTable::Chunk& ServerTable::chunkOf(uint32_t slot) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return *_chunks[slot / kSlotsPerChunk];
+}
+
+uint32_t ServerTable::acquireSlot()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_freeList.empty()) {
+        uint32_t slot = _freeList.back();
+        _freeList.pop_back();
+        return slot;
+    }
+
+    if (_nextSlot == _chunks.size() * kSlotsPerChunk) {
+        _chunks.push_back(new Chunk());
+    }
+    return _nextSlot++;
+}
+
+void* ServerTable::storageFor(uint32_t slot, size_t bytes, size_t alignment)
+{
+    if (bytes <= kSlotBytes && alignment <= alignof(Slot)) {
+        return chunkOf(slot).slots[slot % kSlotsPerChunk].storage;
+    }
+    return ::operator new(bytes, std::align_val_t(alignment));
+}
+
+void ServerTable::releaseStorage(uint32_t slot, void* pointer, size_t bytes, size_t alignment) noexcept
+{
+    if (bytes > kSlotBytes || alignment > alignof(Slot)) {
+        ::operator delete(pointer, std::align_val_t(alignment));
+    }
+
+    // The control block is gone with the last weak reference; only now can the slot be reused
+    std::lock_guard<std::mutex> lock(_mutex);
+    _freeList.push_back(slot);
+}
+
+void ServerTable::retire(uint32_t slot) noexcept
+{
+    Chunk& chunk = chunkOf(slot);
+    chunk.servers[slot % kSlotsPerChunk].store(nullptr, std::memory_order_release);
+    chunk.generations[slot % kSlotsPerChunk].fetch_add(1, std::memory_order_acq_rel);
+    _live.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::shared_ptr<Server> ServerTable::create(const std::string& serverAddress, uint32_t weight)
+{
+    uint32_t slot = acquireSlot();
+    std::shared_ptr<Server> server;
+    try {
+        server = std::allocate_shared<Server>(SlotAllocator<Server>(this, slot), serverAddress, weight);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _freeList.push_back(slot);
+        throw;
+    }
+
+    server->_tableSlot = slot;
+    chunkOf(slot).servers[slot % kSlotsPerChunk].store(server.get(), std::memory_order_release);
+    _live.fetch_add(1, std::memory_order_relaxed);
+    return server;
+}
+
+ServerHandle ServerTable::handleOf(const Server& server) const
+{
+    ServerHandle handle;
+    if (server._tableSlot == ServerHandle::kInvalidSlot) {
+        return handle;
+    }
+    handle.slot = server._tableSlot;
+    handle.generation = chunkOf(handle.slot).generations[handle.slot % kSlotsPerChunk].load(std::memory_order_acquire);
+    return handle;
+}
+
+Server* ServerTable::get(ServerHandle handle) const
+{
+    if (!handle.valid() || handle.slot >= capacity()) {
+        return nullptr;
+    }
+
+    const Chunk& chunk = chunkOf(handle.slot);
+    size_t offset = handle.slot % kSlotsPerChunk;
+    Server* server = chunk.servers[offset].load(std::memory_order_acquire);
+    if (!server || chunk.generations[offset].load(std::memory_order_acquire) != handle.generation) {
+        return nullptr;
+    }
+    return server;
+}
+
+size_t ServerTable::size() const
+{
+    return _live.load(std::memory_order_relaxed);
+}
+
+size_t ServerTable::capacity() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _chunks.size() * kSlotsPerChunk;
+}
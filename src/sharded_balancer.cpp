@@ -0,0 +1,251 @@
+#include "sharded_balancer.hpp"
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+// Constructor
+ShardedBalancer::ShardedBalancer(
+    const std::vector<std::shared_ptr<Server>>& servers,
+    ShardFactory factory,
+    ShardMode mode,
+    size_t maxShards
+) : _mode(mode),
+    _group(InProcessClusterState::makeGroup())
+{
+    if (servers.empty()) {
+        throw std::invalid_argument("Server list cannot be empty");
+    }
+    if (!factory) {
+        throw std::invalid_argument("Shard factory cannot be empty");
+    }
+
+    // Route every CPU to a shard
+    const NumaTopology& topology = NumaTopology::instance();
+    size_t cpus = topology.cpuCount();
+    size_t available = mode == ShardMode::PER_NODE ? topology.nodeCount() : cpus;
+    size_t shardCount = maxShards != 0 ? (std::min)(available, maxShards) : available;
+
+    _shards.resize(shardCount);
+    _cpuShard.resize(cpus);
+    for (uint32_t cpu = 0; cpu < cpus; ++cpu) {
+        size_t shard = mode == ShardMode::PER_NODE ? topology.nodeOf(cpu) % shardCount : cpu * shardCount / cpus;
+        _cpuShard[cpu] = static_cast<uint32_t>(shard);
+        _shards[shard].cpus.push_back(cpu);
+    }
+
+    // Build each shard on its own CPUs so its memory is first touched there
+    for (size_t shard = 0; shard < shardCount; ++shard) {
+        runOnShard(shard, [&]() {
+            _shards[shard].balancer = factory(copyServers(servers, shard));
+            if (!_shards[shard].balancer) {
+                throw std::invalid_argument("Shard factory returned no balancer");
+            }
+        });
+        if (shardCount > 1) {
+            _shards[shard].balancer->setClusterState(std::make_shared<InProcessClusterState>(_group));
+        }
+    }
+
+    // One prober and DNS cache for the process: the first shard's serves every shard's probes
+    std::shared_ptr<PingServer> pingServer = _shards.front().balancer->getPingServer();
+    for (size_t shard = 1; shard < shardCount; ++shard) {
+        _shards[shard].balancer->setPingServer(pingServer);
+    }
+}
+
+// Destructor
+ShardedBalancer::~ShardedBalancer()
+{
+    stopHealthChecks();
+}
+
+void ShardedBalancer::runOnShard(size_t shard, const std::function<void()>& fn) const
+{
+    std::exception_ptr error;
+    std::thread worker([&]() {
+        NumaTopology::bindCurrentThread(_shards[shard].cpus);
+        try {
+            fn();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    });
+    worker.join();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+std::shared_ptr<Server> ShardedBalancer::copyServer(const Server& server, size_t shard) const
+{
+    auto copy = std::make_shared<Server>(server);
+
+    // Spread the remainder over the first shards; no shard may end up unlimited (0)
+    uint32_t limit = server.getConcurrencyLimit();
+    if (limit != 0) {
+        uint32_t shards = static_cast<uint32_t>(_shards.size());
+        uint32_t share = limit / shards + (shard < limit % shards ? 1 : 0);
+        copy->setConcurrencyLimit((std::max)(share, 1u));
+    }
+    return copy;
+}
+
+std::vector<std::shared_ptr<Server>> ShardedBalancer::copyServers(const std::vector<std::shared_ptr<Server>>& servers, size_t shard) const
+{
+    std::vector<std::shared_ptr<Server>> copies;
+    copies.reserve(servers.size());
+    for (const auto& server : servers) {
+        if (server) {
+            copies.push_back(copyServer(*server, shard));
+        }
+    }
+    return copies;
+}
+
+// Pick path
+size_t ShardedBalancer::localShardIndex() const
+{
+    uint32_t cpu = NumaTopology::currentCpu();
+    return cpu < _cpuShard.size() ? _cpuShard[cpu] : cpu % _shards.size();
+}
+
+LoadBalancer& ShardedBalancer::localShard()
+{
+    return *_shards[localShardIndex()].balancer;
+}
+
+std::shared_ptr<Server> ShardedBalancer::getNextServer()
+{
+    return localShard().getNextServer();
+}
+
+ServerLease ShardedBalancer::acquireNextServer()
+{
+    return localShard().acquireNextServer();
+}
+
+size_t ShardedBalancer::acquireNextServers(std::span<ServerLease> out)
+{
+    return localShard().acquireNextServers(out);
+}
+
+Task<ExecutionResult> ShardedBalancer::execute(RequestFunction fn)
+{
+    return localShard().execute(std::move(fn));
+}
+
+// Server management
+bool ShardedBalancer::addServer(const std::shared_ptr<Server>& server)
+{
+    if (!server) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_managementMutex);
+    bool added = true;
+    for (size_t shard = 0; shard < _shards.size(); ++shard) {
+        runOnShard(shard, [&]() {
+            added = _shards[shard].balancer->addServer(copyServer(*server, shard)) && added;
+        });
+    }
+    return added;
+}
+
+bool ShardedBalancer::removeServer(const std::string& serverAddress)
+{
+    std::lock_guard<std::mutex> lock(_managementMutex);
+    bool removed = true;
+    for (auto& shard : _shards) {
+        removed = shard.balancer->removeServer(serverAddress) && removed;
+    }
+    return removed;
+}
+
+// Health checks
+void ShardedBalancer::startHealthChecks()
+{
+    for (auto& shard : _shards) {
+        shard.balancer->startHealthChecks();
+    }
+}
+
+void ShardedBalancer::stopHealthChecks()
+{
+    for (auto& shard : _shards) {
+        shard.balancer->stopHealthChecks();
+    }
+}
+
+void ShardedBalancer::synchronizeShards()
+{
+    for (auto& shard : _shards) {
+        std::shared_ptr<ClusterState> cluster = shard.balancer->getClusterState();
+        if (cluster) {
+            cluster->synchronize(shard.balancer->getServers());
+        }
+    }
+}
+
+void ShardedBalancer::setSyncInterval(std::chrono::milliseconds interval)
+{
+    for (auto& shard : _shards) {
+        std::shared_ptr<ClusterState> cluster = shard.balancer->getClusterState();
+        if (cluster) {
+            cluster->setSyncInterval(interval);
+        }
+    }
+}
+
+std::chrono::milliseconds ShardedBalancer::getSyncInterval() const
+{
+    std::shared_ptr<ClusterState> cluster = _shards.front().balancer->getClusterState();
+    return cluster ? cluster->getSyncInterval() : std::chrono::milliseconds(0);
+}
+
+// Access
+size_t ShardedBalancer::getShardCount() const
+{
+    return _shards.size();
+}
+
+LoadBalancer& ShardedBalancer::getShard(size_t index)
+{
+    return *_shards.at(index).balancer;
+}
+
+const LoadBalancer& ShardedBalancer::getShard(size_t index) const
+{
+    return *_shards.at(index).balancer;
+}
+
+const std::vector<uint32_t>& ShardedBalancer::getShardCpus(size_t index) const
+{
+    return _shards.at(index).cpus;
+}
+
+ShardMode ShardedBalancer::getMode() const
+{
+    return _mode;
+}
+
+// Statistics
+size_t ShardedBalancer::getServerCount() const
+{
+    return _shards.front().balancer->getServerCount();
+}
+
+size_t ShardedBalancer::getHealthyServerCount() const
+{
+    return _shards[localShardIndex()].balancer->getHealthyServerCount();
+}
+
+uint64_t ShardedBalancer::getTotalPicks() const
+{
+    uint64_t picks = 0;
+    for (const auto& shard : _shards) {
+        picks += shard.balancer->getMetrics().picks.value();
+    }
+    return picks;
+}
@@ -0,0 +1,84 @@
+#include "slow_start.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Copy constructor
+SlowStart::SlowStart(const SlowStart& other)
+{
+    *this = other;
+}
+
+// Copy assignment
+SlowStart& SlowStart::operator=(const SlowStart& other)
+{
+    if (this != &other) {
+        _window.store(other._window.load());
+        _floor.store(other._floor.load());
+        _curve.store(other._curve.load());
+    }
+    return *this;
+}
+
+double SlowStart::factor(const ServerHotState& state) const
+{
+    auto window = _window.load(std::memory_order_relaxed);
+    int64_t start = state.rampStart.load(std::memory_order_relaxed);
+    if (window == 0 || start == 0) {
+        return 1.0;
+    }
+
+    auto elapsed = std::chrono::steady_clock::now().time_since_epoch() - std::chrono::steady_clock::duration(start);
+    auto length = std::chrono::milliseconds(window);
+    if (elapsed >= length) {
+        // Ramp finished: clear it so later picks skip the clock read
+        state.rampStart.compare_exchange_strong(start, 0, std::memory_order_relaxed);
+        return 1.0;
+    }
+
+    double progress = std::chrono::duration<double>(elapsed) / std::chrono::duration<double>(length);
+    progress = std::clamp(progress, 0.0, 1.0);
+    double floor = _floor.load(std::memory_order_relaxed);
+
+    if (_curve.load(std::memory_order_relaxed) == RampCurve::EXPONENTIAL) {
+        return std::pow(floor, 1.0 - progress);
+    }
+    return floor + (1.0 - floor) * progress;
+}
+
+double SlowStart::effectiveWeight(const ServerHotState& state) const
+{
+    uint32_t weight = state.weight.load(std::memory_order_relaxed);
+    return static_cast<double>(weight > 0 ? weight : 1) * factor(state);
+}
+
+// Configuration
+void SlowStart::setWindow(std::chrono::milliseconds window)
+{
+    _window.store((std::max)(window.count(), std::chrono::milliseconds::rep(0)));
+}
+
+std::chrono::milliseconds SlowStart::getWindow() const
+{
+    return std::chrono::milliseconds(_window.load());
+}
+
+void SlowStart::setFloor(double floor)
+{
+    // A zero floor would stall an exponential ramp and starve a linear one at the start
+    _floor.store(std::clamp(floor, 0.01, 1.0));
+}
+
+double SlowStart::getFloor() const
+{
+    return _floor.load();
+}
+
+void SlowStart::setCurve(RampCurve curve)
+{
+    _curve.store(curve);
+}
+
+RampCurve SlowStart::getCurve() const
+{
+    return _curve.load();
+}
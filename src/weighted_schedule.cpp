@@ -0,0 +1,173 @@
+#include "weighted_schedule.hpp"
+#include <bit>
+#include <numeric>
+
+namespace {
+    // (a * b) % m without overflowing 64 bits
+    uint64_t mulMod(uint64_t a, uint64_t b, uint64_t m)
+    {
+        // Periods below 2^32 tickets, the common case, fit plain 64-bit arithmetic
+        if (((a | b) >> 32) == 0) {
+            return (a * b) % m;
+        }
+
+#if defined(__SIZEOF_INT128__)
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) % m);
+#else
+        // Double and add; only reached for periods beyond 2^32 tickets
+        uint64_t result = 0;
+        a %= m;
+        while (b != 0) {
+            if (b & 1) {
+                result = result >= m - a ? result - (m - a) : result + a;
+            }
+            a = a >= m - a ? a - (m - a) : a + a;
+            b >>= 1;
+        }
+        return result;
+#endif
+    }
+}
+
+// Constructor
+WeightedSchedule::WeightedSchedule(const std::vector<uint32_t>& weights)
+    : _size(weights.size()),
+      _topStep(weights.empty() ? 0 : std::bit_floor(weights.size())),
+      _tree(new std::atomic<uint64_t>[weights.size() + 1]),
+      _weights(new std::atomic<uint32_t>[weights.size()])
+{
+    // Linear-time Fenwick build: each node passes its sum on to its parent
+    std::vector<uint64_t> nodes(_size + 1, 0);
+    uint64_t total = 0;
+    for (size_t i = 1; i <= _size; ++i) {
+        nodes[i] += weights[i - 1];
+        total += weights[i - 1];
+
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= _size) {
+            nodes[parent] += nodes[i];
+        }
+    }
+
+    for (size_t i = 0; i <= _size; ++i) {
+        _tree[i].store(nodes[i], std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < _size; ++i) {
+        _weights[i].store(weights[i], std::memory_order_relaxed);
+    }
+
+    _totalWeight.store(total, std::memory_order_relaxed);
+    _stride.store(computeStride(total), std::memory_order_release);
+}
+
+// Stride selection
+uint64_t WeightedSchedule::computeStride(uint64_t period)
+{
+    if (period <= 2) {
+        return 1;
+    }
+
+    uint64_t target = static_cast<uint64_t>(static_cast<double>(period) * 0.6180339887498949);
+    if (target == 0) {
+        target = 1;
+    }
+
+    // Walk outwards from the golden-ratio point until the stride is a generator
+    for (uint64_t offset = 0; offset < period; ++offset) {
+        if (target + offset < period && std::gcd(target + offset, period) == 1) {
+            return target + offset;
+        }
+        if (offset < target && std::gcd(target - offset, period) == 1) {
+            return target - offset;
+        }
+    }
+
+    return 1;
+}
+
+// Selection
+size_t WeightedSchedule::pick(uint64_t ticket) const
+{
+    uint64_t total = _totalWeight.load(std::memory_order_acquire);
+    if (total == 0) {
+        return npos;
+    }
+
+    // A stride read mid-update only costs this ticket its even spacing
+    uint64_t stride = _stride.load(std::memory_order_relaxed);
+    return serverAt(mulMod(ticket % total, stride % total, total));
+}
+
+size_t WeightedSchedule::serverAt(uint64_t position) const
+{
+    // Descend the tree: find the largest prefix whose sum is <= position
+    size_t index = 0;
+    for (size_t step = _topStep; step != 0; step >>= 1) {
+        size_t next = index + step;
+        if (next <= _size) {
+            uint64_t sum = _tree[next].load(std::memory_order_relaxed);
+            if (sum <= position) {
+                index = next;
+                position -= sum;
+            }
+        }
+    }
+
+    return index < _size ? index : npos;
+}
+
+// Weight update
+bool WeightedSchedule::setWeight(size_t index, uint32_t weight)
+{
+    if (index >= _size) {
+        return false;
+    }
+
+    uint32_t previous = _weights[index].exchange(weight, std::memory_order_relaxed);
+    if (previous == weight) {
+        return false;
+    }
+
+    // Unsigned wrap-around turns the addition into a subtraction for lower weights
+    uint64_t delta = static_cast<uint64_t>(weight) - static_cast<uint64_t>(previous);
+    auto applyToTree = [this, delta, index]() {
+        for (size_t node = index + 1; node <= _size; node += node & (~node + 1)) {
+            _tree[node].fetch_add(delta, std::memory_order_relaxed);
+        }
+    };
+
+    // Grow the tree before the period and shrink the period before the tree, so a racing
+    // pick lands inside the tree's range whenever it can
+    uint64_t total = _totalWeight.load(std::memory_order_relaxed) + delta;
+    if (weight > previous) {
+        applyToTree();
+        _stride.store(computeStride(total), std::memory_order_relaxed);
+        _totalWeight.store(total, std::memory_order_release);
+    } else {
+        _totalWeight.store(total, std::memory_order_release);
+        _stride.store(computeStride(total), std::memory_order_relaxed);
+        applyToTree();
+    }
+    return true;
+}
+
+uint32_t WeightedSchedule::weightAt(size_t index) const
+{
+    return index < _size ? _weights[index].load(std::memory_order_relaxed) : 0;
+}
+
+// Accessors
+uint64_t WeightedSchedule::totalWeight() const
+{
+    return _totalWeight.load(std::memory_order_acquire);
+}
+
+size_t WeightedSchedule::size() const
+{
+    return _size;
+}
+
+bool WeightedSchedule::empty() const
+{
+    return totalWeight() == 0;
+}
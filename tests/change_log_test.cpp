@@ -0,0 +1,126 @@
+// HotStateChangeLog replay, and snapshots resynchronizing after the log overran them.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "round_robin_load_balancer.hpp"
+#include "check.hpp"
+
+namespace {
+
+std::vector<std::shared_ptr<Server>> makeServers(size_t count)
+{
+    std::vector<std::shared_ptr<Server>> servers;
+    for (size_t i = 0; i < count; ++i) {
+        auto server = std::make_shared<Server>("10.2.0." + std::to_string(i + 1) + ":80");
+        server->setHealthy(true);
+        servers.push_back(server);
+    }
+    return servers;
+}
+
+// More changes than the ring holds
+constexpr size_t kOverrunChanges = 3000;
+
+}
+
+void checkReplayDeliversNewChangesInOrder()
+{
+    auto servers = makeServers(2);
+    HotStateChangeLog& log = HotStateChangeLog::instance();
+
+    uint64_t from = log.head();
+    servers[0]->setWeight(5);
+    servers[1]->setHealthy(false);
+    servers[1]->setWeight(1); // Unchanged: not recorded
+
+    std::vector<const ServerHotState*> seen;
+    CHECK(log.replay(from, [&](const ServerHotState* state) { seen.push_back(state); }) == HotStateChangeLog::ReplayResult::CAUGHT_UP);
+    REQUIRE(seen.size() == 2u);
+    CHECK(seen[0] == &servers[0]->hotState());
+    CHECK(seen[1] == &servers[1]->hotState());
+    CHECK(from == log.head());
+
+    // Nothing new: nothing delivered
+    seen.clear();
+    CHECK(log.replay(from, [&](const ServerHotState* state) { seen.push_back(state); }) == HotStateChangeLog::ReplayResult::CAUGHT_UP);
+    CHECK(seen.empty());
+}
+
+void checkReaderTooFarBehindIsOverrun()
+{
+    auto servers = makeServers(1);
+    HotStateChangeLog& log = HotStateChangeLog::instance();
+
+    uint64_t from = log.head();
+    for (size_t i = 0; i < kOverrunChanges; ++i) {
+        servers[0]->setWeight(i % 2 == 0 ? 2 : 3);
+    }
+    CHECK(log.replay(from, [](const ServerHotState*) {}) == HotStateChangeLog::ReplayResult::OVERRUN);
+}
+
+void checkSnapshotIndexesFollowReplayedHealth()
+{
+    auto servers = makeServers(4);
+    RoundRobinLoadBalancer balancer(servers);
+    REQUIRE(balancer.getNextServer() != nullptr);
+
+    servers[0]->setHealthy(false);
+    servers[2]->setHealthy(false);
+    for (int i = 0; i < 40; ++i) {
+        auto server = balancer.getNextServer();
+        REQUIRE(server != nullptr);
+        CHECK(server == servers[1] || server == servers[3]);
+    }
+}
+
+void checkRoundRobinResyncsAfterOverrun()
+{
+    auto servers = makeServers(4);
+    RoundRobinLoadBalancer balancer(servers);
+    REQUIRE(balancer.getNextServer() != nullptr);
+
+    // Flap three servers past the ring's capacity, ending unhealthy
+    for (size_t i = 0; i < kOverrunChanges; ++i) {
+        servers[i % 3]->setHealthy(i % 2 == 1);
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        servers[i]->setHealthy(false);
+    }
+
+    for (int i = 0; i < 40; ++i) {
+        CHECK(balancer.getNextServer() == servers[3]);
+    }
+}
+
+void checkWeightedScheduleResyncsAfterOverrun()
+{
+    auto servers = makeServers(2);
+    WeightedRoundRobinLoadBalancer balancer(servers);
+    REQUIRE(balancer.getNextServer() != nullptr);
+
+    for (size_t i = 0; i < kOverrunChanges; ++i) {
+        servers[1]->setWeight(i % 2 == 0 ? 2 : 4);
+    }
+    servers[1]->setWeight(3);
+
+    // A schedule period gives every server exactly its weight
+    std::map<std::shared_ptr<Server>, int> picks;
+    for (int i = 0; i < 400; ++i) {
+        ++picks[balancer.getNextServer()];
+    }
+    CHECK(picks[servers[0]] == 100);
+    CHECK(picks[servers[1]] == 300);
+}
+
+int main()
+{
+    return checks::runChecks({
+        {"ReplayDeliversNewChangesInOrder", checkReplayDeliversNewChangesInOrder},
+        {"ReaderTooFarBehindIsOverrun", checkReaderTooFarBehindIsOverrun},
+        {"SnapshotIndexesFollowReplayedHealth", checkSnapshotIndexesFollowReplayedHealth},
+        {"RoundRobinResyncsAfterOverrun", checkRoundRobinResyncsAfterOverrun},
+        {"WeightedScheduleResyncsAfterOverrun", checkWeightedScheduleResyncsAfterOverrun}
+    });
+}
@@ -0,0 +1,43 @@
+#ifndef TESTS_CHECK_HPP_
+#define TESTS_CHECK_HPP_
+
+#include <cstdio>
+#include <initializer_list>
+#include <utility>
+
+// Minimal checks for the ctest executables, which have no test framework to depend on.
+// CHECK() reports a failure and carries on; REQUIRE() also leaves the current case.
+// runChecks() runs the cases in order and returns main()'s exit code.
+namespace checks {
+    inline int& failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline bool report(bool passed, const char* expression, const char* file, int line)
+    {
+        if (!passed) {
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+            ++failures();
+        }
+        return passed;
+    }
+
+    using Case = std::pair<const char*, void (*)()>;
+
+    inline int runChecks(std::initializer_list<Case> cases)
+    {
+        for (const Case& check : cases) {
+            int before = failures();
+            check.second();
+            std::printf("%s %s\n", failures() == before ? "[ OK ]  " : "[FAIL]  ", check.first);
+        }
+        return failures() == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(expression) ((void)checks::report(static_cast<bool>(expression), #expression, __FILE__, __LINE__))
+#define REQUIRE(expression) do { if (!checks::report(static_cast<bool>(expression), #expression, __FILE__, __LINE__)) return; } while (0)
+
+#endif // TESTS_CHECK_HPP_
@@ -0,0 +1,132 @@
+// HealthSnapshot: save/open round trip, restore, and rejection of damaged or foreign files.
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include "health_snapshot.hpp"
+#include "check.hpp"
+
+namespace {
+
+std::string tempPath(const std::string& name)
+{
+    return (std::filesystem::temp_directory_path() / ("lb_health_snapshot_" + name + ".bin")).string();
+}
+
+std::vector<std::shared_ptr<Server>> makeServers()
+{
+    std::vector<std::shared_ptr<Server>> servers;
+    for (size_t i = 0; i < 8; ++i) {
+        auto server = std::make_shared<Server>("10.4.0." + std::to_string(i + 1) + ":80");
+        server->setHealthy(i % 2 == 0);
+        server->setWeight(static_cast<uint32_t>(i + 1));
+        servers.push_back(server);
+    }
+    return servers;
+}
+
+std::vector<char> readFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::vector<char>& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+}
+
+void checkRoundTripRestoresHealthAndWeight()
+{
+    std::string path = tempPath("round_trip");
+    auto saved = makeServers();
+    REQUIRE(HealthSnapshot::save(path, saved));
+
+    HealthSnapshot snapshot;
+    REQUIRE(snapshot.open(path));
+    CHECK(snapshot.size() == saved.size());
+    CHECK(snapshot.find("10.4.0.3:80") != nullptr);
+    CHECK(snapshot.find("10.4.0.99:80") == nullptr);
+
+    for (const auto& original : saved) {
+        Server restored(original->getServerAddress());
+        REQUIRE(snapshot.restore(restored, std::chrono::steady_clock::now()));
+        CHECK(restored.isHealthy() == original->isHealthy());
+        CHECK(restored.getWeight() == original->getWeight());
+    }
+
+    Server unknown("10.4.1.1:80");
+    CHECK(!snapshot.restore(unknown, std::chrono::steady_clock::now()));
+    std::remove(path.c_str());
+}
+
+void checkMissingFileIsRejected()
+{
+    HealthSnapshot snapshot;
+    CHECK(!snapshot.open(tempPath("missing")));
+    CHECK(!snapshot.isOpen());
+}
+
+void checkCorruptFilesAreRejected()
+{
+    std::string path = tempPath("corrupt");
+    REQUIRE(HealthSnapshot::save(path, makeServers()));
+    std::vector<char> good = readFile(path);
+    REQUIRE(good.size() > sizeof(HealthSnapshot::Header));
+
+    // A flipped byte in the records fails the checksum
+    std::vector<char> flipped = good;
+    flipped[sizeof(HealthSnapshot::Header) + 4] ^= 0x5A;
+    writeFile(path, flipped);
+    {
+        HealthSnapshot snapshot;
+        CHECK(!snapshot.open(path));
+    }
+
+    // Truncated file
+    writeFile(path, std::vector<char>(good.begin(), good.end() - 7));
+    {
+        HealthSnapshot snapshot;
+        CHECK(!snapshot.open(path));
+    }
+
+    // Foreign magic
+    std::vector<char> foreign = good;
+    foreign[0] ^= 0x01;
+    writeFile(path, foreign);
+    {
+        HealthSnapshot snapshot;
+        CHECK(!snapshot.open(path));
+    }
+
+    // Shorter than a header
+    writeFile(path, std::vector<char>(good.begin(), good.begin() + 10));
+    {
+        HealthSnapshot snapshot;
+        CHECK(!snapshot.open(path));
+    }
+
+    // The untouched bytes still open
+    writeFile(path, good);
+    {
+        HealthSnapshot snapshot;
+        CHECK(snapshot.open(path));
+    }
+    std::remove(path.c_str());
+}
+
+int main()
+{
+    return checks::runChecks({
+        {"RoundTripRestoresHealthAndWeight", checkRoundTripRestoresHealthAndWeight},
+        {"MissingFileIsRejected", checkMissingFileIsRejected},
+        {"CorruptFilesAreRejected", checkCorruptFilesAreRejected}
+    });
+}
@@ -0,0 +1,109 @@
+// LeastConnectionsLoadBalancer: equal loads spread over the pool on the full scan and sampled paths.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "least_connections_load_balancer.hpp"
+#include "check.hpp"
+
+namespace {
+
+std::vector<std::shared_ptr<Server>> makeServers(size_t count)
+{
+    std::vector<std::shared_ptr<Server>> servers;
+    for (size_t i = 0; i < count; ++i) {
+        auto server = std::make_shared<Server>("10.5." + std::to_string(i / 250) + "." + std::to_string(i % 250 + 1) + ":80");
+        server->setHealthy(true);
+        servers.push_back(server);
+    }
+    return servers;
+}
+
+}
+
+void checkFullScanSpreadsEqualLoads()
+{
+    auto servers = makeServers(4);
+    LeastConnectionsLoadBalancer balancer(servers);
+
+    std::map<const Server*, int> picks;
+    for (int i = 0; i < 1000; ++i) {
+        std::shared_ptr<Server> server = balancer.getNextServer();
+        REQUIRE(server);
+        ++picks[server.get()];
+    }
+    REQUIRE(picks.size() == servers.size());
+    for (const auto& [server, count] : picks) {
+        CHECK(count == 250);
+    }
+}
+
+void checkShortLeasesSpreadOverThePool()
+{
+    auto servers = makeServers(4);
+    LeastConnectionsLoadBalancer balancer(servers);
+
+    std::map<const Server*, int> picks;
+    for (int i = 0; i < 1000; ++i) {
+        ServerLease lease = balancer.acquireNextServer();
+        REQUIRE(lease);
+        ++picks[lease.get()];
+        lease.complete(true);
+    }
+    REQUIRE(picks.size() == servers.size());
+    for (const auto& [server, count] : picks) {
+        CHECK(count == 250);
+    }
+}
+
+void checkFullScanPrefersTheLeastLoaded()
+{
+    auto servers = makeServers(4);
+    LeastConnectionsLoadBalancer balancer(servers);
+
+    // One lease per server, then a second on whichever comes next: it must not be picked again
+    std::vector<ServerLease> held;
+    for (size_t i = 0; i < servers.size() + 1; ++i) {
+        held.push_back(balancer.acquireNextServer());
+        REQUIRE(held.back());
+    }
+    for (int i = 0; i < 30; ++i) {
+        std::shared_ptr<Server> server = balancer.getNextServer();
+        REQUIRE(server);
+        CHECK(server.get() != held.back().get());
+    }
+}
+
+void checkSamplingIgnoresUnavailableRuns()
+{
+    // Half the pool down in one run: the server after it must not absorb the run's share
+    auto servers = makeServers(100);
+    for (size_t i = 0; i < 50; ++i) {
+        servers[i]->setHealthy(false);
+    }
+    LeastConnectionsLoadBalancer balancer(servers);
+
+    constexpr int kPicks = 100000;
+    std::map<const Server*, int> picks;
+    for (int i = 0; i < kPicks; ++i) {
+        std::shared_ptr<Server> server = balancer.getNextServer();
+        REQUIRE(server);
+        ++picks[server.get()];
+    }
+    CHECK(picks.size() == 50u);
+    for (const auto& [server, count] : picks) {
+        CHECK(server->isHealthy());
+        CHECK(count < kPicks / 50 * 3 / 2);
+    }
+}
+
+int main()
+{
+    return checks::runChecks({
+        {"FullScanSpreadsEqualLoads", checkFullScanSpreadsEqualLoads},
+        {"ShortLeasesSpreadOverThePool", checkShortLeasesSpreadOverThePool},
+        {"FullScanPrefersTheLeastLoaded", checkFullScanPrefersTheLeastLoaded},
+        {"SamplingIgnoresUnavailableRuns", checkSamplingIgnoresUnavailableRuns}
+    });
+}
@@ -0,0 +1,77 @@
+// Peak-EWMA latency kept in ServerHotState: fed by reported outcomes and warm starts,
+// and read by the peak-EWMA picker.
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "peak_ewma_load_balancer.hpp"
+#include "check.hpp"
+
+namespace {
+
+std::vector<std::shared_ptr<Server>> makeServers(size_t count)
+{
+    std::vector<std::shared_ptr<Server>> servers;
+    for (size_t i = 0; i < count; ++i) {
+        auto server = std::make_shared<Server>("10.6.0." + std::to_string(i + 1) + ":80");
+        server->setHealthy(true);
+        servers.push_back(server);
+    }
+    return servers;
+}
+
+}
+
+void checkOutcomesReachHotState()
+{
+    auto servers = makeServers(1);
+    PeakEwmaLoadBalancer balancer(servers);
+    const ServerHotState& hot = servers[0]->hotState();
+    CHECK(hot.peakLatencyMicros(std::chrono::steady_clock::now()) == 0.0);
+
+    // A slower sample replaces the average at once
+    balancer.reportOutcome(*servers[0], true, std::chrono::milliseconds(2));
+    double peak = hot.peakLatencyMicros(std::chrono::steady_clock::now());
+    CHECK(peak > 1900.0 && peak <= 2000.0);
+
+    // A faster one only pulls it down over the decay time
+    balancer.reportOutcome(*servers[0], true, std::chrono::microseconds(100));
+    CHECK(hot.peakLatencyMicros(std::chrono::steady_clock::now()) > 1000.0);
+}
+
+void checkWarmStartSeedsOnce()
+{
+    auto servers = makeServers(1);
+    const ServerHotState& hot = servers[0]->hotState();
+
+    servers[0]->restoreLatency(500000, 500.0);
+    double seeded = hot.peakLatencyMicros(std::chrono::steady_clock::now());
+    CHECK(seeded > 490.0 && seeded <= 500.0);
+
+    // Values with samples already are left alone
+    servers[0]->restoreLatency(900000, 900.0);
+    CHECK(hot.peakLatencyMicros(std::chrono::steady_clock::now()) <= 500.0);
+}
+
+void checkPicksTheFasterServer()
+{
+    auto servers = makeServers(2);
+    PeakEwmaLoadBalancer balancer(servers);
+    balancer.reportOutcome(*servers[0], true, std::chrono::microseconds(200));
+    balancer.reportOutcome(*servers[1], true, std::chrono::milliseconds(20));
+
+    // Both draws land on the two servers, so every idle pick goes to the faster one
+    for (int i = 0; i < 100; ++i) {
+        CHECK(balancer.getNextServer().get() == servers[0].get());
+    }
+}
+
+int main()
+{
+    return checks::runChecks({
+        {"OutcomesReachHotState", checkOutcomesReachHotState},
+        {"WarmStartSeedsOnce", checkWarmStartSeedsOnce},
+        {"PicksTheFasterServer", checkPicksTheFasterServer}
+    });
+}
@@ -0,0 +1,75 @@
+// RoundRobinLoadBalancer batches: picks rotate over healthy servers, and over the alive
+// fallbacks during an outage.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "round_robin_load_balancer.hpp"
+#include "check.hpp"
+
+namespace {
+
+std::vector<std::shared_ptr<Server>> makeServers(size_t count)
+{
+    std::vector<std::shared_ptr<Server>> servers;
+    for (size_t i = 0; i < count; ++i) {
+        auto server = std::make_shared<Server>("10.7.0." + std::to_string(i + 1) + ":80");
+        server->setHealthy(true);
+        servers.push_back(server);
+    }
+    return servers;
+}
+
+std::map<const Server*, int> countBatch(LoadBalancer& balancer, size_t size)
+{
+    std::vector<std::shared_ptr<Server>> out(size);
+    size_t written = balancer.getNextServers(out);
+    std::map<const Server*, int> counts;
+    for (size_t i = 0; i < written; ++i) {
+        ++counts[out[i].get()];
+    }
+    return counts;
+}
+
+}
+
+void checkBatchRotatesOverHealthyServers()
+{
+    auto servers = makeServers(4);
+    servers[1]->setHealthy(false);
+    RoundRobinLoadBalancer balancer(servers);
+
+    auto counts = countBatch(balancer, 63);
+    CHECK(counts.size() == 3u);
+    CHECK(counts.count(servers[1].get()) == 0u);
+    for (const auto& [server, count] : counts) {
+        CHECK(count == 21);
+    }
+}
+
+void checkOutageBatchRotatesOverFallbacks()
+{
+    auto servers = makeServers(4);
+    for (const auto& server : servers) {
+        server->setHealthy(false);
+    }
+    servers[2]->setAlive(false);
+    RoundRobinLoadBalancer balancer(servers);
+
+    auto counts = countBatch(balancer, 63);
+    CHECK(counts.size() == 3u);
+    CHECK(counts.count(servers[2].get()) == 0u);
+    for (const auto& [server, count] : counts) {
+        CHECK(count == 21);
+    }
+    CHECK(balancer.getMetrics().fallbackPicks.value() == 63u);
+}
+
+int main()
+{
+    return checks::runChecks({
+        {"BatchRotatesOverHealthyServers", checkBatchRotatesOverHealthyServers},
+        {"OutageBatchRotatesOverFallbacks", checkOutageBatchRotatesOverFallbacks}
+    });
+}
@@ -0,0 +1,84 @@
+// ServerBitmap: set/test bookkeeping and findNext() across words and around the end.
+
+#include "server_bitmap.hpp"
+#include "check.hpp"
+
+void checkEmptyBitmapFindsNothing()
+{
+    ServerBitmap bitmap(130);
+    CHECK(bitmap.size() == 130u);
+    CHECK(bitmap.count() == 0u);
+    CHECK(bitmap.findNext(0) == ServerBitmap::npos);
+    CHECK(bitmap.findNext(129) == ServerBitmap::npos);
+
+    ServerBitmap none;
+    CHECK(none.findNext(0) == ServerBitmap::npos);
+}
+
+void checkFindNextSkipsToTheNextSetBit()
+{
+    ServerBitmap bitmap(130);
+    bitmap.set(3, true);
+    bitmap.set(64, true);
+    bitmap.set(129, true);
+
+    CHECK(bitmap.findNext(0) == 3u);
+    CHECK(bitmap.findNext(3) == 3u);
+    CHECK(bitmap.findNext(4) == 64u); // Across a word boundary
+    CHECK(bitmap.findNext(65) == 129u); // Last bit of a partial word
+    CHECK(bitmap.count() == 3u);
+}
+
+void checkFindNextWrapsAround()
+{
+    ServerBitmap bitmap(130);
+    bitmap.set(5, true);
+
+    CHECK(bitmap.findNext(6) == 5u);
+    CHECK(bitmap.findNext(129) == 5u);
+    CHECK(bitmap.findNext(500) == 5u); // Out of range starts over
+}
+
+void checkClearedBitsAreSkipped()
+{
+    ServerBitmap bitmap(70);
+    for (size_t i = 0; i < 70; ++i) {
+        bitmap.set(i, true);
+    }
+    for (size_t i = 0; i < 69; ++i) {
+        bitmap.set(i, false);
+    }
+
+    CHECK(!bitmap.test(0));
+    CHECK(bitmap.test(69));
+    CHECK(bitmap.count() == 1u);
+    CHECK(bitmap.findNext(0) == 69u);
+    CHECK(bitmap.findNext(69) == 69u);
+}
+
+void checkFindNthSelectsByRank()
+{
+    ServerBitmap bitmap(200);
+    bitmap.set(2, true);
+    bitmap.set(63, true);
+    bitmap.set(64, true);
+    bitmap.set(199, true);
+
+    CHECK(bitmap.findNth(0) == 2u);
+    CHECK(bitmap.findNth(1) == 63u);
+    CHECK(bitmap.findNth(2) == 64u); // Across a word boundary
+    CHECK(bitmap.findNth(3) == 199u);
+    CHECK(bitmap.findNth(4) == ServerBitmap::npos);
+    CHECK(ServerBitmap(10).findNth(0) == ServerBitmap::npos);
+}
+
+int main()
+{
+    return checks::runChecks({
+        {"EmptyBitmapFindsNothing", checkEmptyBitmapFindsNothing},
+        {"FindNextSkipsToTheNextSetBit", checkFindNextSkipsToTheNextSetBit},
+        {"FindNextWrapsAround", checkFindNextWrapsAround},
+        {"ClearedBitsAreSkipped", checkClearedBitsAreSkipped},
+        {"FindNthSelectsByRank", checkFindNthSelectsByRank}
+    });
+}
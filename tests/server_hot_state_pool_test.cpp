@@ -0,0 +1,88 @@
+// ServerHotStatePool: released blocks go back to their own arena and come out reset.
+
+#include <set>
+#include <thread>
+#include <vector>
+#include "server_hot_state.hpp"
+#include "check.hpp"
+
+void checkReleasedBlockIsReusedReset()
+{
+    ServerHotStatePool& pool = ServerHotStatePool::instance();
+    ServerHotState* block = pool.acquire();
+    REQUIRE(block);
+    block->setFlag(ServerHotState::kHealthy, true);
+    block->weight.store(7);
+    block->currentConnections.store(3);
+    block->peakEwma.store(42);
+
+    // Free lists are LIFO, so the next acquire on this thread hands the same block back
+    pool.release(block);
+    ServerHotState* reused = pool.acquire();
+    CHECK(reused == block);
+    CHECK(reused->flags.load() == ServerHotState::kAlive);
+    CHECK(reused->weight.load() == 1u);
+    CHECK(reused->currentConnections.load() == 0u);
+    CHECK(reused->peakEwma.load() == 0u);
+    pool.release(reused);
+}
+
+void checkChurnAcrossThreadsKeepsBlocksDistinct()
+{
+    ServerHotStatePool& pool = ServerHotStatePool::instance();
+    constexpr size_t kThreads = 4;
+    constexpr size_t kBlocks = 200;
+
+    // Blocks acquired on one thread and released on another still find their arena
+    std::vector<std::vector<ServerHotState*>> acquired(kThreads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&pool, &acquired, t] {
+            for (size_t i = 0; i < kBlocks; ++i) {
+                acquired[t].push_back(pool.acquire());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<ServerHotState*> distinct;
+    for (const auto& blocks : acquired) {
+        distinct.insert(blocks.begin(), blocks.end());
+    }
+    CHECK(distinct.size() == kThreads * kBlocks);
+
+    threads.clear();
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&pool, &acquired, t] {
+            for (ServerHotState* block : acquired[(t + 1) % kThreads]) {
+                pool.release(block);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // This thread's arena hands out every block released to it before carving new ones
+    std::set<ServerHotState*> again;
+    for (size_t i = 0; i < kThreads * kBlocks; ++i) {
+        again.insert(pool.acquire());
+    }
+    uint32_t arena = (*again.begin())->poolArena;
+    for (ServerHotState* block : distinct) {
+        CHECK(block->poolArena != arena || again.count(block) == 1);
+    }
+    for (ServerHotState* block : again) {
+        pool.release(block);
+    }
+}
+
+int main()
+{
+    return checks::runChecks({
+        {"ReleasedBlockIsReusedReset", checkReleasedBlockIsReusedReset},
+        {"ChurnAcrossThreadsKeepsBlocksDistinct", checkChurnAcrossThreadsKeepsBlocksDistinct}
+    });
+}
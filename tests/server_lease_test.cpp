@@ -0,0 +1,207 @@
+// ServerLease connection accounting, alone and under contention with a concurrency limit,
+// and admission that refuses a pick only when every server is saturated.
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ip_hash_load_balancer.hpp"
+#include "least_connections_load_balancer.hpp"
+#include "peak_ewma_load_balancer.hpp"
+#include "round_robin_load_balancer.hpp"
+#include "check.hpp"
+
+namespace {
+
+std::vector<std::shared_ptr<Server>> makeServers(size_t count)
+{
+    std::vector<std::shared_ptr<Server>> servers;
+    for (size_t i = 0; i < count; ++i) {
+        auto server = std::make_shared<Server>("10.3.0." + std::to_string(i + 1) + ":80");
+        server->setHealthy(true);
+        servers.push_back(server);
+    }
+    return servers;
+}
+
+}
+
+void checkHoldsOneSlotUntilReleased()
+{
+    auto servers = makeServers(1);
+    RoundRobinLoadBalancer balancer(servers);
+
+    ServerLease lease = balancer.acquireNextServer();
+    REQUIRE(lease);
+    CHECK(servers[0]->getCurrentConnections() == 1u);
+
+    ServerLease moved = std::move(lease);
+    CHECK(!lease);
+    CHECK(servers[0]->getCurrentConnections() == 1u);
+
+    moved.release();
+    CHECK(!moved);
+    CHECK(servers[0]->getCurrentConnections() == 0u);
+    moved.release(); // Second release is a no-op
+    CHECK(servers[0]->getCurrentConnections() == 0u);
+
+    {
+        ServerLease scoped = balancer.acquireNextServer();
+        scoped.complete(true);
+        CHECK(servers[0]->getCurrentConnections() == 0u);
+    }
+    CHECK(servers[0]->getCurrentConnections() == 0u);
+}
+
+void checkSaturatedServerIssuesNoLease()
+{
+    auto servers = makeServers(1);
+    servers[0]->setConcurrencyLimit(2);
+    RoundRobinLoadBalancer balancer(servers);
+
+    ServerLease first = balancer.acquireNextServer();
+    ServerLease second = balancer.acquireNextServer();
+    ServerLease third = balancer.acquireNextServer();
+    CHECK(first);
+    CHECK(second);
+    CHECK(!third);
+    CHECK(servers[0]->getCurrentConnections() == 2u);
+    CHECK(balancer.getMetrics().rejectedPicks.value() == 1u);
+}
+
+void checkAccountingHoldsUnderContention()
+{
+    constexpr uint32_t kLimit = 3;
+    constexpr int kThreads = 8;
+    constexpr int kIterations = 20000;
+
+    auto servers = makeServers(4);
+    for (const auto& server : servers) {
+        server->setConcurrencyLimit(kLimit);
+    }
+    LeastConnectionsLoadBalancer balancer(servers);
+
+    std::atomic<uint64_t> admitted{0};
+    std::atomic<uint64_t> refused{0};
+    std::atomic<bool> overLimit{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < kIterations; ++i) {
+                ServerLease lease = balancer.acquireNextServer();
+                if (!lease) {
+                    refused.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                admitted.fetch_add(1, std::memory_order_relaxed);
+                if (lease->getCurrentConnections() > kLimit) {
+                    overLimit.store(true, std::memory_order_relaxed);
+                }
+                if (i % 2 == 0) {
+                    lease.complete(true);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(!overLimit.load());
+    CHECK(admitted.load() + refused.load() == uint64_t{kThreads} * kIterations);
+    CHECK(balancer.getMetrics().rejectedPicks.value() == refused.load());
+    for (const auto& server : servers) {
+        CHECK(server->getCurrentConnections() == 0u);
+    }
+}
+
+void checkRoundRobinSkipsSaturatedRun()
+{
+    auto servers = makeServers(8);
+    RoundRobinLoadBalancer balancer(servers);
+    std::vector<ServerLease> held;
+    for (size_t i = 2; i < 6; ++i) {
+        servers[i]->setConcurrencyLimit(1);
+    }
+    for (size_t i = 0; i < 8; ++i) {
+        ServerLease lease = balancer.acquireNextServer();
+        if (lease && lease->getConcurrencyLimit() == 1) {
+            held.push_back(std::move(lease)); // Saturate servers 2 to 5
+        }
+    }
+    REQUIRE(held.size() == 4u);
+
+    for (int i = 0; i < 8; ++i) {
+        std::shared_ptr<Server> server = balancer.getNextServer();
+        REQUIRE(server);
+        CHECK(server->getConcurrencyLimit() == 0u);
+    }
+    CHECK(balancer.getMetrics().rejectedPicks.value() == 0u);
+}
+
+void checkDeterministicPickersSkipSaturatedServer()
+{
+    // A heavy server limited to one lease: the full scan and a fixed key must move on
+    auto servers = makeServers(4);
+    servers[0]->setWeight(100);
+    servers[0]->setConcurrencyLimit(1);
+
+    LeastConnectionsLoadBalancer leastConnections(servers);
+    ServerLease first = leastConnections.acquireNextServer();
+    REQUIRE(first.get() == servers[0].get());
+    ServerLease second = leastConnections.acquireNextServer();
+    CHECK(second);
+    CHECK(second.get() != servers[0].get());
+    CHECK(leastConnections.getMetrics().rejectedPicks.value() == 0u);
+    first.release();
+    second.release();
+
+    IpHashLoadBalancer ipHash(servers);
+    std::string client;
+    for (int i = 0; client.empty() && i < 1000; ++i) {
+        std::string candidate = "192.0.2." + std::to_string(i);
+        if (ipHash.getServerForClient(candidate) == servers[0]) {
+            client = candidate;
+        }
+    }
+    REQUIRE(!client.empty());
+    ServerLease sticky = ipHash.acquireServerForClient(client);
+    REQUIRE(sticky.get() == servers[0].get());
+    ServerLease moved = ipHash.acquireServerForClient(client);
+    CHECK(moved);
+    CHECK(moved.get() != servers[0].get());
+    CHECK(ipHash.getMetrics().rejectedPicks.value() == 0u);
+}
+
+void checkRejectsOnlyWhenAllSaturated()
+{
+    auto servers = makeServers(20);
+    for (const auto& server : servers) {
+        server->setConcurrencyLimit(1);
+    }
+    PeakEwmaLoadBalancer balancer(servers);
+
+    // Every pick finds the one free server left, until there is none
+    std::vector<ServerLease> held;
+    for (size_t i = 0; i < servers.size(); ++i) {
+        held.push_back(balancer.acquireNextServer());
+        CHECK(held.back());
+    }
+    CHECK(balancer.getMetrics().rejectedPicks.value() == 0u);
+    CHECK(!balancer.acquireNextServer());
+    CHECK(!balancer.getNextServer());
+    CHECK(balancer.getMetrics().rejectedPicks.value() == 2u);
+}
+
+int main()
+{
+    return checks::runChecks({
+        {"HoldsOneSlotUntilReleased", checkHoldsOneSlotUntilReleased},
+        {"SaturatedServerIssuesNoLease", checkSaturatedServerIssuesNoLease},
+        {"AccountingHoldsUnderContention", checkAccountingHoldsUnderContention},
+        {"RoundRobinSkipsSaturatedRun", checkRoundRobinSkipsSaturatedRun},
+        {"DeterministicPickersSkipSaturatedServer", checkDeterministicPickersSkipSaturatedServer},
+        {"RejectsOnlyWhenAllSaturated", checkRejectsOnlyWhenAllSaturated}
+    });
+}
@@ -0,0 +1,82 @@
+// Slow start under weighted round robin: relative weights hold while the pool ramps.
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "round_robin_load_balancer.hpp"
+#include "check.hpp"
+
+namespace {
+
+std::vector<std::shared_ptr<Server>> makeServers(const std::vector<uint32_t>& weights)
+{
+    std::vector<std::shared_ptr<Server>> servers;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        auto server = std::make_shared<Server>("10.6.0." + std::to_string(i + 1) + ":80", weights[i]);
+        server->setHealthy(true); // Starts the ramp
+        servers.push_back(server);
+    }
+    return servers;
+}
+
+std::map<const Server*, int> countPicks(LoadBalancer& balancer, int picks)
+{
+    std::map<const Server*, int> counts;
+    for (int i = 0; i < picks; ++i) {
+        std::shared_ptr<Server> server = balancer.getNextServer();
+        if (server) {
+            ++counts[server.get()];
+        }
+    }
+    return counts;
+}
+
+}
+
+void checkWholePoolRampKeepsWeights()
+{
+    auto servers = makeServers({1, 1, 1, 7});
+    WeightedRoundRobinLoadBalancer balancer(servers);
+    balancer.getSlowStart().setWindow(std::chrono::minutes(10));
+    REQUIRE(balancer.getSlowStart().factor(servers[3]->hotState()) < 0.2);
+
+    constexpr int kPicks = 20000;
+    auto counts = countPicks(balancer, kPicks);
+    double heavyShare = static_cast<double>(counts[servers[3].get()]) / kPicks;
+    CHECK(heavyShare > 0.65);
+    CHECK(heavyShare < 0.75);
+}
+
+void checkRampingServerYieldsToWarmOnes()
+{
+    auto servers = makeServers({1, 1, 1, 1});
+    WeightedRoundRobinLoadBalancer balancer(servers);
+
+    // Let every ramp end, then restart the last server's alone
+    balancer.getSlowStart().setWindow(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    for (const auto& server : servers) {
+        REQUIRE(balancer.getSlowStart().factor(server->hotState()) == 1.0);
+    }
+    servers[3]->beginSlowStart();
+    balancer.getSlowStart().setWindow(std::chrono::minutes(10));
+
+    constexpr int kPicks = 20000;
+    auto counts = countPicks(balancer, kPicks);
+    CHECK(counts.size() == servers.size());
+    CHECK(counts[servers[3].get()] < kPicks / 10);
+    for (size_t i = 0; i < 3; ++i) {
+        CHECK(counts[servers[i].get()] > kPicks / 4);
+    }
+}
+
+int main()
+{
+    return checks::runChecks({
+        {"WholePoolRampKeepsWeights", checkWholePoolRampKeepsWeights},
+        {"RampingServerYieldsToWarmOnes", checkRampingServerYieldsToWarmOnes}
+    });
+}